@@ -0,0 +1,81 @@
+#include "AIScheduler.h"
+#include <algorithm>
+#include <iostream>
+
+const int AIScheduler::INTERVALS[3] = {0, 100, 250};
+
+AIScheduler::AIScheduler(int capacity)
+{
+	detail.assign(capacity, 0);
+	nextThink.assign(capacity, 0);
+	due.reserve(capacity);
+	lastReport = 0;
+	overruns = 0;
+	worstMs = 0;
+	thinks = 0;
+}
+
+void AIScheduler::reset(int i)
+{
+	detail[i] = 0;
+	nextThink[i] = 0;
+}
+
+void AIScheduler::schedule(Uint32 now, int count, const bool* live, const int* distance, const bool* urgent, int costNs, std::vector<char> &think)
+{
+	think.assign(count, 0);
+	due.clear();
+	for (int i = 0; i < count; i++) {
+		if (!live[i]) {
+			continue;
+		}
+		// Step at most one level a tick, and only once well past the boundary
+		if (detail[i] < 2 && distance[i] > (detail[i] == 0 ? NEAR_DISTANCE : FAR_DISTANCE) + HYSTERESIS) {
+			detail[i]++;
+		}
+		else if (detail[i] > 0 && distance[i] < (detail[i] == 1 ? NEAR_DISTANCE : FAR_DISTANCE) - HYSTERESIS) {
+			detail[i]--;
+		}
+		if (urgent[i] || (Sint32) (now - nextThink[i]) >= 0) {
+			due.push_back(i);
+		}
+	}
+
+	// Urgent first, then whoever has waited longest
+	const bool* urgent_agents = urgent;
+	const std::vector<Uint32> &next = nextThink;
+	std::sort(due.begin(), due.end(), [urgent_agents, &next](int a, int b) {
+		if (urgent_agents[a] != urgent_agents[b]) {
+			return urgent_agents[a];
+		}
+		if (next[a] != next[b]) {
+			return (Sint32) (next[a] - next[b]) < 0;
+		}
+		return a < b;
+	});
+
+	// Always at least one, so nobody waits forever if a think costs more than the whole budget
+	int budget_ns = BUDGET_US * 1000;
+	int picked = std::min((int) due.size(), std::max(1, budget_ns / std::max(1, costNs)));
+	for (int k = 0; k < picked; k++) {
+		int i = due[k];
+		think[i] = 1;
+		nextThink[i] = now + INTERVALS[detail[i]];
+	}
+	thinks = picked;
+}
+
+void AIScheduler::endTick(Uint32 now, Uint64 thinkTime)
+{
+	double ms = thinkTime * 1000.0 / SDL_GetPerformanceFrequency();
+	if (ms * 1000 > BUDGET_US) {
+		overruns++;
+		worstMs = std::max(worstMs, ms);
+	}
+	if (overruns > 0 && now - lastReport >= REPORT_FREQ) {
+		std::cout << "AI went over its " << BUDGET_US << " us budget on " << overruns << " ticks, worst " << worstMs << " ms (" << thinks << " thinking last tick)" << std::endl;
+		overruns = 0;
+		worstMs = 0;
+		lastReport = now;
+	}
+}
@@ -0,0 +1,56 @@
+#ifndef AIScheduler_H
+#define AIScheduler_H
+
+#include <SDL.h>
+#include <vector>
+
+// Decides which agents get to think each tick. Moving on their last decision is cheap and happens every
+// tick; thinking is what costs, so it is spread out:
+//
+// - Level of detail: agents near the player rethink every tick, further ones less often. An agent only
+//   changes level once it is HYSTERESIS past the boundary, so one sitting on it doesn't flip every tick.
+// - Urgent agents (threatened, or needing a new decision) are due at once whatever their level.
+// - A tick only spends up to BUDGET_US on thinking, by each think's estimated cost. Due agents that
+//   don't fit wait for the next tick, most overdue first, so the cost stays flat however many agents
+//   there are.
+//
+// Picks are made from estimated costs and game time, so a seeded run always picks the same. The real
+// time the thinks took is only used to report ticks that went over the budget.
+class AIScheduler
+{
+public:
+	static const int BUDGET_US = 200;
+	// Distances from the player where the levels of detail change
+	static const int NEAR_DISTANCE = 350;
+	static const int FAR_DISTANCE = 700;
+	static const int HYSTERESIS = 50;
+	// How often an agent rethinks at each level of detail, in ms
+	static const int INTERVALS[3];
+	// How often overruns are reported, in ms
+	static const int REPORT_FREQ = 5000;
+
+	AIScheduler(int capacity);
+
+	// A new agent: it thinks on the next tick and starts at full detail
+	void reset(int i);
+	// Fills think with whether each of the first count agents thinks this tick. Agents that aren't live
+	// never think. costNs is the estimated cost of one think.
+	void schedule(Uint32 now, int count, const bool* live, const int* distance, const bool* urgent, int costNs, std::vector<char> &think);
+
+	// Takes how long this tick's thinks took between them, in performance counter units, and reports
+	// now and again when that goes over the budget
+	void endTick(Uint32 now, Uint64 thinkTime);
+
+private:
+	std::vector<int> detail;
+	std::vector<Uint32> nextThink;
+	// Due agents, ordered by priority each tick. Kept between ticks so scheduling does not allocate.
+	std::vector<int> due;
+
+	Uint32 lastReport;
+	int overruns;
+	double worstMs;
+	int thinks;
+};
+
+#endif
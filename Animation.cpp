@@ -0,0 +1,67 @@
+#include "Animation.h"
+
+Uint32 Animator::now = 0;
+
+void Animator::setTime(Uint32 now)
+{
+	Animator::now = now;
+}
+
+Uint32 Animator::getTime()
+{
+	return now;
+}
+
+AnimationState Animator::play(AnimationID clip)
+{
+	AnimationState state = {clip, now};
+	return state;
+}
+
+Uint32 Animator::getElapsed(const AnimationState &state)
+{
+	// States started before the clock was set can be ahead of it
+	if (now < state.start) {
+		return 0;
+	}
+	return now - state.start;
+}
+
+bool Animator::isFinished(const AnimationState &state)
+{
+	const AnimationClip* clip = gAssets->getAnimation(state.clip);
+	if (clip == nullptr) {
+		return true;
+	}
+	return !clip->loops && getElapsed(state) >= clip->length;
+}
+
+int Animator::getFrame(const AnimationState &state)
+{
+	const AnimationClip* clip = gAssets->getAnimation(state.clip);
+	if (clip == nullptr || clip->schedule.empty()) {
+		return -1;
+	}
+	Uint32 step = getElapsed(state) / clip->step;
+	if (clip->loops) {
+		step %= clip->schedule.size();
+	}
+	else if (step >= clip->schedule.size()) {
+		step = clip->schedule.size() - 1;
+	}
+	return clip->schedule[step];
+}
+
+void Animator::draw(RenderSnapshot *frame, const AnimationState &state, const SDL_Rect &dst, double angle)
+{
+	int index = getFrame(state);
+	if (index < 0) {
+		return;
+	}
+	const AnimationClip* clip = gAssets->getAnimation(state.clip);
+	const SDL_Rect &src = clip->frames[index];
+	if (clip->sheet == nullptr || src.w == 0) {
+		return;
+	}
+	frame->copy(clip->sheet, &src, &dst, angle);
+}
@@ -0,0 +1,38 @@
+#ifndef Animation_H
+#define Animation_H
+
+#include <SDL.h>
+#include "AssetCache.h"
+#include "RenderSnapshot.h"
+
+// All an animated object keeps: the clip it is playing and when it started
+struct AnimationState
+{
+	AnimationID clip;
+	Uint32 start;
+};
+
+// Plays the clips from the animation manifest. Time is read from GameClock once per tick with
+// setTime() and shared by every animation in that tick. Only used from the simulation thread.
+class Animator
+{
+public:
+	static void setTime(Uint32 now);
+	static Uint32 getTime();
+
+	// A state that starts the clip now
+	static AnimationState play(AnimationID clip);
+	static Uint32 getElapsed(const AnimationState &state);
+	// True once a clip that doesn't loop has shown its last frame for its full duration
+	static bool isFinished(const AnimationState &state);
+	// Which of the clip's frames is showing. A finished clip stays on its last frame.
+	static int getFrame(const AnimationState &state);
+
+	// Records the current frame stretched over dst. Frames without an image record nothing.
+	static void draw(RenderSnapshot *frame, const AnimationState &state, const SDL_Rect &dst, double angle = 0.0);
+
+private:
+	static Uint32 now;
+};
+
+#endif
@@ -0,0 +1,93 @@
+#include "AssetArchive.h"
+#include <iostream>
+#include <cstring>
+
+const char AssetArchive::MAGIC[4] = {'T', 'A', 'P', 'K'};
+const char* AssetArchive::DEFAULT_PATH = "assets.pak";
+
+AssetArchive::AssetArchive()
+{
+	entries = nullptr;
+	entryCount = 0;
+}
+
+AssetArchive::~AssetArchive()
+{
+	close();
+}
+
+bool AssetArchive::open(const char* path)
+{
+	close();
+
+	if (!file.open(path)) {
+		return false;
+	}
+	const Uint8* data = file.getData();
+	size_t dataSize = file.getSize();
+
+	const ArchiveHeader* header = (const ArchiveHeader*) data;
+	if (dataSize < sizeof(ArchiveHeader) || memcmp(header->magic, MAGIC, 4) != 0 || header->version != VERSION) {
+		std::cout << "Unable to use asset archive " << path << "! It is not a version " << VERSION << " archive" << std::endl;
+		close();
+		return false;
+	}
+	if (dataSize < sizeof(ArchiveHeader) + (size_t) header->entryCount * sizeof(ArchiveEntry)) {
+		std::cout << "Unable to use asset archive " << path << "! Its index is truncated" << std::endl;
+		close();
+		return false;
+	}
+	entries = (const ArchiveEntry*) (data + sizeof(ArchiveHeader));
+	entryCount = header->entryCount;
+	for (Uint32 i = 0; i < entryCount; i++) {
+		if (entries[i].offset > dataSize || entries[i].size > dataSize - entries[i].offset) {
+			std::cout << "Unable to use asset archive " << path << "! " << entries[i].path << " runs past the end of the file" << std::endl;
+			close();
+			return false;
+		}
+	}
+	return true;
+}
+
+void AssetArchive::close()
+{
+	file.close();
+	entries = nullptr;
+	entryCount = 0;
+}
+
+bool AssetArchive::isOpen()
+{
+	return file.isOpen();
+}
+
+const ArchiveEntry* AssetArchive::find(const char* path)
+{
+	// A few dozen entries, so a linear scan is cheaper than building anything
+	for (Uint32 i = 0; i < entryCount; i++) {
+		if (strncmp(entries[i].path, path, sizeof(entries[i].path)) == 0) {
+			return &entries[i];
+		}
+	}
+	return nullptr;
+}
+
+const Uint8* AssetArchive::getData(const ArchiveEntry* entry)
+{
+	return file.getData() + entry->offset;
+}
+
+SDL_Surface* AssetArchive::createSurface(const ArchiveEntry* entry)
+{
+	// SDL never writes to a surface it is only reading from, so the const cast is safe
+	SDL_Surface* surf = SDL_CreateRGBSurfaceWithFormatFrom((void*) getData(entry), entry->width, entry->height, 32, entry->pitch, SDL_PIXELFORMAT_RGBA32);
+	if (surf == nullptr) {
+		std::cout << "Unable to wrap " << entry->path << " from the asset archive! SDL Error: " << SDL_GetError() << std::endl;
+	}
+	return surf;
+}
+
+SDL_RWops* AssetArchive::createRW(const ArchiveEntry* entry)
+{
+	return SDL_RWFromConstMem(getData(entry), entry->size);
+}
@@ -0,0 +1,72 @@
+#ifndef AssetArchive_H
+#define AssetArchive_H
+
+#include <SDL.h>
+#include <string>
+#include <vector>
+#include "MappedFile.h"
+
+// How an archive entry's bytes are stored
+enum ArchiveEntryType
+{
+	ENTRY_RGBA,		// Decoded RGBA32 pixels, ready to hand to the GPU
+	ENTRY_ENCODED,	// The original image file, decoded when it is used
+	ENTRY_RAW		// Any other file (music, fonts), stored as is
+};
+
+// The archive starts with this header, followed by entryCount ArchiveEntry records and then the data.
+// Everything is written in the packing machine's byte order; the archive is a build product, not a
+// distribution format.
+struct ArchiveHeader
+{
+	char magic[4];
+	Uint32 version;
+	Uint32 entryCount;
+	Uint32 reserved;
+};
+
+struct ArchiveEntry
+{
+	char path[96];		// The path the asset was packed from, e.g. "sprites/cave.png"
+	Uint32 type;
+	Uint32 width;		// Image size for ENTRY_RGBA, 0 otherwise
+	Uint32 height;
+	Uint32 pitch;
+	Uint64 offset;		// From the start of the archive, 16 byte aligned
+	Uint64 size;
+};
+
+// Read-only view of an archive made by asset_packer. The whole file is memory mapped, so entries
+// are used in place and pages are only read from disk when something touches them.
+class AssetArchive
+{
+public:
+	static const char MAGIC[4];
+	static const Uint32 VERSION = 1;
+	static const char* DEFAULT_PATH;
+
+	AssetArchive();
+	~AssetArchive();
+
+	// Maps the archive and checks its index. Returns false (and stays closed) if it is missing or bad.
+	bool open(const char* path);
+	void close();
+	bool isOpen();
+
+	// Looks up an entry by the path it was packed from; nullptr if it isn't in the archive
+	const ArchiveEntry* find(const char* path);
+	const Uint8* getData(const ArchiveEntry* entry);
+
+	// Wraps an ENTRY_RGBA image in a surface that points straight at the mapped pixels.
+	// Free it with SDL_FreeSurface; the pixels stay valid as long as the archive is open.
+	SDL_Surface* createSurface(const ArchiveEntry* entry);
+	// Read-only stream over any entry, for IMG_Load_RW / Mix_LoadMUS_RW / TTF_OpenFontRW
+	SDL_RWops* createRW(const ArchiveEntry* entry);
+
+private:
+	MappedFile file;
+	const ArchiveEntry* entries;
+	Uint32 entryCount;
+};
+
+#endif
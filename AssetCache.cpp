@@ -0,0 +1,594 @@
+#include "AssetCache.h"
+#include <iostream>
+#include <fstream>
+#include <iterator>
+
+AssetCache *gAssets = nullptr;
+
+// Credit slides are only needed once the game is over, so they are loaded on demand
+const AssetManifestEntry AssetCache::MANIFEST[ASSET_COUNT] = {
+	{ASSET_BACKGROUND, "sprites/cave.png", true},
+	{ASSET_START_SCREEN, "sprites/StartScreen.png", true},
+	{ASSET_START_BUTTON, "sprites/start_button.png", true},
+	{ASSET_DIFF_SCREEN, "sprites/DiffScreen.png", true},
+	{ASSET_EASY_BUTTON, "sprites/easy_button.png", true},
+	{ASSET_MED_BUTTON, "sprites/med_button.png", true},
+	{ASSET_HARD_BUTTON, "sprites/hard_button.png", true},
+	{ASSET_CRED_BUTTON, "sprites/cred_button.png", true},
+	{ASSET_RESTART_BUTTON, "sprites/restart_button.png", true},
+	{ASSET_PLAYER_PLANE_1, "sprites/PlayerPlane1.png", true},
+	{ASSET_PLAYER_PLANE_2, "sprites/PlayerPlane3.png", true},
+	{ASSET_ENEMY_PLANE_1, "sprites/EnemyPlane1.png", true},
+	{ASSET_ENEMY_PLANE_2, "sprites/EnemyPlane3.png", true},
+	{ASSET_KAMIKAZE_1, "sprites/EnemyPlaneK1.png", true},
+	{ASSET_KAMIKAZE_2, "sprites/EnemyPlaneK2.png", true},
+	{ASSET_EXPLOSION, "sprites/Explosion.png", true},
+	{ASSET_DUST_CLOUD, "sprites/dustCloud.png", true},
+	{ASSET_TOP_TURRET, "sprites/topturret.png", true},
+	{ASSET_BOTTOM_TURRET, "sprites/bottomturret.png", true},
+	{ASSET_STALACTITE_1, "sprites/stalagt1.png", true},
+	{ASSET_STALACTITE_2, "sprites/stalagt2.png", true},
+	{ASSET_STALACTITE_3, "sprites/stalagt3.png", true},
+	{ASSET_STALACTITE_4, "sprites/stalagt4.png", true},
+	{ASSET_STALAGMITE_1, "sprites/stalagm1.png", true},
+	{ASSET_STALAGMITE_2, "sprites/stalagm2.png", true},
+	{ASSET_STALAGMITE_3, "sprites/stalagm3.png", true},
+	{ASSET_STALAGMITE_4, "sprites/stalagm4.png", true},
+	{ASSET_HEALTH, "sprites/health.png", true},
+	{ASSET_MISSILE_1, "sprites/missile.png", true},
+	{ASSET_MISSILE_2, "sprites/Missile2.png", true},
+	{ASSET_INF_FIRE, "sprites/infFire.png", true},
+	{ASSET_INVINCE, "sprites/invince.png", true},
+	{ASSET_AUTOFIRE, "sprites/autofire.png", true},
+	{ASSET_CREDIT_HELLESTED, "slides/Hellested_credit_roll.png", false},
+	{ASSET_CREDIT_DILAN, "slides/dilan.png", false},
+	{ASSET_CREDIT_TRANT, "slides/Trant-RandomLevelGeneration.png", false},
+	{ASSET_CREDIT_ZOMPER, "slides/JakeZomperCredit.png", false},
+	{ASSET_CREDIT_CHOO, "slides/Kenneth Choo Physics.png", false},
+	{ASSET_CREDIT_YUCEL, "slides/Faruk Yucel.png", false},
+	{ASSET_CREDIT_MD, "slides/mdcredit.PNG", false},
+	{ASSET_CREDIT_SCHWARTZ, "slides/connor_schwartz_credit.png", false},
+	{ASSET_CREDIT_BRANDON, "slides/Brandon's Credit 1.png", false},
+	{ASSET_CREDIT_JEROEN, "slides/jeroen_credit1280x720.png", false},
+};
+
+const MusicManifestEntry AssetCache::MUSIC_MANIFEST[MUSIC_COUNT] = {
+	{MUSIC_TRASH_BEAT, "sounds/lebron_trash_beat.wav", MUSIC_TRASH_BEAT},
+	// Not in the repo, so a checkout without them plays the trash beat throughout
+	{MUSIC_MAIN_TRACK, "sounds/track_2.wav", MUSIC_TRASH_BEAT},
+	{MUSIC_START_TRACK, "sounds/game_track.wav", MUSIC_TRASH_BEAT},
+};
+
+// Planes swap between their two sprites every 100 ms. When hit they flicker for 500 ms, hidden every
+// other 50 ms. Explosions stay up for as long as they take to grow to full size.
+const AnimationManifestEntry AssetCache::ANIMATION_MANIFEST[ANIM_COUNT] = {
+	{ANIM_PLAYER, true, 2, {{ASSET_PLAYER_PLANE_1, 100}, {ASSET_PLAYER_PLANE_2, 100}}},
+	{ANIM_PLAYER_HIT, false, 10, {{ASSET_NONE, 50}, {ASSET_PLAYER_PLANE_1, 50}, {ASSET_NONE, 50}, {ASSET_PLAYER_PLANE_2, 50},
+		{ASSET_NONE, 50}, {ASSET_PLAYER_PLANE_1, 50}, {ASSET_NONE, 50}, {ASSET_PLAYER_PLANE_2, 50}, {ASSET_NONE, 50}, {ASSET_PLAYER_PLANE_1, 50}}},
+	{ANIM_ENEMY, true, 2, {{ASSET_ENEMY_PLANE_1, 100}, {ASSET_ENEMY_PLANE_2, 100}}},
+	{ANIM_ENEMY_HIT, false, 10, {{ASSET_NONE, 50}, {ASSET_ENEMY_PLANE_1, 50}, {ASSET_NONE, 50}, {ASSET_ENEMY_PLANE_2, 50},
+		{ASSET_NONE, 50}, {ASSET_ENEMY_PLANE_1, 50}, {ASSET_NONE, 50}, {ASSET_ENEMY_PLANE_2, 50}, {ASSET_NONE, 50}, {ASSET_ENEMY_PLANE_1, 50}}},
+	{ANIM_KAMIKAZE, true, 2, {{ASSET_KAMIKAZE_1, 100}, {ASSET_KAMIKAZE_2, 100}}},
+	{ANIM_EXPLOSION, false, 1, {{ASSET_EXPLOSION, 700}}},
+	{ANIM_DUST_CLOUD, false, 1, {{ASSET_DUST_CLOUD, 700}}},
+};
+
+const char* AssetCache::FONT_PATH = "sprites/comic.ttf";
+
+AssetCache::AssetCache(SDL_Renderer *gRenderer) : gRenderer{gRenderer}
+{
+	for (int i = 0; i < ASSET_COUNT; i++) {
+		textures[i] = nullptr;
+		refCounts[i] = 0;
+		memoryUsage[i] = 0;
+		decodedSurfaces[i] = nullptr;
+	}
+	for (int i = 0; i < MUSIC_COUNT; i++) {
+		music[i] = nullptr;
+	}
+	for (int i = 0; i < ANIM_COUNT; i++) {
+		animations[i].sheet = nullptr;
+		animationBuilt[i] = false;
+		animationRefCounts[i] = 0;
+	}
+	animationMemory = 0;
+	for (int i = 0; i < ASSET_COUNT + MUSIC_COUNT; i++) {
+		SDL_AtomicSet(&jobStates[i], LOAD_DONE);
+	}
+	SDL_AtomicSet(&nextJob, 0);
+	jobsDone = 0;
+
+	// Use the packed archive when there is one, otherwise every asset is read from its own file
+	if (archive.open(AssetArchive::DEFAULT_PATH)) {
+		std::cout << "Loading assets from " << AssetArchive::DEFAULT_PATH << std::endl;
+	}
+}
+
+AssetCache::~AssetCache()
+{
+	// Stop handing out jobs and let the workers finish whatever they are decoding
+	SDL_AtomicSet(&nextJob, jobs.size());
+	waitForWorkers();
+
+	for (int i = 0; i < ANIM_COUNT; i++) {
+		if (animations[i].sheet != nullptr) {
+			SDL_DestroyTexture(animations[i].sheet);
+		}
+	}
+	for (int i = 0; i < ASSET_COUNT; i++) {
+		if (decodedSurfaces[i] != nullptr) {
+			SDL_FreeSurface(decodedSurfaces[i]);
+		}
+		unload((AssetID) i);
+	}
+	for (int i = 0; i < MUSIC_COUNT; i++) {
+		if (music[i] != nullptr) {
+			Mix_FreeMusic(music[i]);
+		}
+	}
+}
+
+void AssetCache::preload()
+{
+	for (int i = 0; i < ASSET_COUNT; i++) {
+		if (MANIFEST[i].preload && textures[i] == nullptr) {
+			load((AssetID) i);
+		}
+	}
+}
+
+SDL_Texture* AssetCache::acquire(AssetID id)
+{
+	if (textures[id] == nullptr) {
+		// If the background loader has it queued, don't decode it a second time
+		completeJob(id);
+	}
+	if (textures[id] == nullptr) {
+		load(id);
+	}
+	refCounts[id]++;
+	return textures[id];
+}
+
+void AssetCache::release(AssetID id)
+{
+	if (refCounts[id] > 0) {
+		refCounts[id]--;
+	}
+}
+
+SDL_Texture* AssetCache::get(AssetID id)
+{
+	return textures[id];
+}
+
+int AssetCache::getRefCount(AssetID id)
+{
+	return refCounts[id];
+}
+
+size_t AssetCache::getMemoryUsage(AssetID id)
+{
+	return memoryUsage[id];
+}
+
+size_t AssetCache::getTotalMemoryUsage()
+{
+	size_t total = 0;
+	for (int i = 0; i < ASSET_COUNT; i++) {
+		total += memoryUsage[i];
+	}
+	return total;
+}
+
+void AssetCache::reportMemory()
+{
+	std::cout << "Asset memory usage:" << std::endl;
+	for (int i = 0; i < ASSET_COUNT; i++) {
+		if (textures[i] != nullptr) {
+			std::cout << "  " << MANIFEST[i].path << ": " << memoryUsage[i] / 1024 << " KB, " << refCounts[i] << " refs" << std::endl;
+		}
+	}
+	std::cout << "  Sprite sheets: " << animationMemory / 1024 << " KB" << std::endl;
+	std::cout << "  Total: " << (getTotalMemoryUsage() + animationMemory) / 1024 << " KB" << std::endl;
+}
+
+void AssetCache::purgeUnused()
+{
+	for (int i = 0; i < ASSET_COUNT; i++) {
+		if (refCounts[i] == 0) {
+			unload((AssetID) i);
+		}
+	}
+}
+
+const AnimationClip* AssetCache::acquireAnimation(AnimationID id)
+{
+	if (!animationBuilt[id]) {
+		buildAnimation(id);
+	}
+	animationRefCounts[id]++;
+	return &animations[id];
+}
+
+void AssetCache::releaseAnimation(AnimationID id)
+{
+	if (animationRefCounts[id] > 0) {
+		animationRefCounts[id]--;
+	}
+}
+
+const AnimationClip* AssetCache::getAnimation(AnimationID id)
+{
+	if (id == ANIM_NONE || !animationBuilt[id]) {
+		return nullptr;
+	}
+	return &animations[id];
+}
+
+Mix_Music* AssetCache::getMusic(MusicID id)
+{
+	if (music[id] == nullptr) {
+		completeJob(ASSET_COUNT + id);
+	}
+	if (music[id] == nullptr && musicData[id].empty()) {
+		loadMusic(id);
+	}
+	if (music[id] == nullptr && MUSIC_MANIFEST[id].fallback != id) {
+		return getMusic(MUSIC_MANIFEST[id].fallback);
+	}
+	return music[id];
+}
+
+TTF_Font* AssetCache::openFont(const char* path, int ptsize)
+{
+	const ArchiveEntry* entry = archive.find(path);
+	TTF_Font* font;
+	if (entry != nullptr) {
+		font = TTF_OpenFontRW(archive.createRW(entry), 1, ptsize);
+	}
+	else {
+		font = TTF_OpenFont(path, ptsize);
+	}
+	if (font == nullptr) {
+		std::cout << "Unable to open font " << path << "! SDL Error: " << TTF_GetError() << std::endl;
+	}
+	return font;
+}
+
+void AssetCache::beginAsyncLoad()
+{
+	if (!workers.empty()) {
+		return;
+	}
+
+	// IMG_Init isn't thread safe, so make sure the PNG loader is set up before the workers use it
+	IMG_Init(IMG_INIT_PNG);
+
+	jobs.clear();
+	jobsDone = 0;
+	for (int i = 0; i < ASSET_COUNT; i++) {
+		if (MANIFEST[i].preload && textures[i] == nullptr) {
+			jobs.push_back(i);
+			SDL_AtomicSet(&jobStates[i], LOAD_PENDING);
+		}
+	}
+	for (int i = 0; i < MUSIC_COUNT; i++) {
+		if (music[i] == nullptr) {
+			jobs.push_back(ASSET_COUNT + i);
+			SDL_AtomicSet(&jobStates[ASSET_COUNT + i], LOAD_PENDING);
+		}
+	}
+	SDL_AtomicSet(&nextJob, 0);
+
+	// Leave a core for the render thread
+	int worker_count = SDL_GetCPUCount() - 1;
+	if (worker_count < 1) worker_count = 1;
+	if (worker_count > 4) worker_count = 4;
+	for (int i = 0; i < worker_count; i++) {
+		SDL_Thread* worker = SDL_CreateThread(decodeWorker, "AssetDecoder", this);
+		if (worker != nullptr) {
+			workers.push_back(worker);
+		}
+	}
+	// If no thread could be created, everything is decoded on demand by completeJob() instead
+}
+
+void AssetCache::pumpUploads(int maxUploads)
+{
+	int uploads = 0;
+	for (int i = 0; i < jobs.size() && uploads < maxUploads; i++) {
+		if (SDL_AtomicGet(&jobStates[jobs[i]]) == LOAD_DECODED) {
+			finishJob(jobs[i]);
+			uploads++;
+		}
+	}
+	if (isAsyncLoadDone()) {
+		waitForWorkers();
+	}
+}
+
+void AssetCache::finishAsyncLoad()
+{
+	for (int i = 0; i < jobs.size(); i++) {
+		completeJob(jobs[i]);
+	}
+	waitForWorkers();
+}
+
+float AssetCache::getLoadProgress()
+{
+	if (jobs.empty()) {
+		return 1;
+	}
+	return (float) jobsDone / jobs.size();
+}
+
+bool AssetCache::isAsyncLoadDone()
+{
+	return jobsDone == jobs.size();
+}
+
+void AssetCache::waitForWorkers()
+{
+	for (int i = 0; i < workers.size(); i++) {
+		SDL_WaitThread(workers[i], nullptr);
+	}
+	workers.clear();
+}
+
+void AssetCache::completeJob(int job)
+{
+	if (SDL_AtomicCAS(&jobStates[job], LOAD_PENDING, LOAD_DECODING)) {
+		decodeJob(job);
+		SDL_AtomicSet(&jobStates[job], LOAD_DECODED);
+	}
+	// A worker is already on it; a single PNG only takes a few milliseconds
+	while (SDL_AtomicGet(&jobStates[job]) == LOAD_DECODING) {
+		SDL_Delay(1);
+	}
+	if (SDL_AtomicGet(&jobStates[job]) == LOAD_DECODED) {
+		finishJob(job);
+	}
+}
+
+// Runs on the render thread once a job has been decoded
+void AssetCache::finishJob(int job)
+{
+	if (job < ASSET_COUNT) {
+		if (decodedSurfaces[job] != nullptr) {
+			upload((AssetID) job, decodedSurfaces[job]);
+			SDL_FreeSurface(decodedSurfaces[job]);
+			decodedSurfaces[job] = nullptr;
+		}
+	}
+	else {
+		int id = job - ASSET_COUNT;
+		if (!musicData[id].empty()) {
+			music[id] = Mix_LoadMUS_RW(SDL_RWFromConstMem(musicData[id].data(), musicData[id].size()), 1);
+			if (music[id] == nullptr) {
+				printf( "Failed to load beat music! SDL_mixer Error: %s\n", Mix_GetError() );
+			}
+		}
+		else if (archive.find(MUSIC_MANIFEST[id].path) != nullptr) {
+			// Already in memory, nothing for a worker to read
+			loadMusic((MusicID) id);
+		}
+	}
+	SDL_AtomicSet(&jobStates[job], LOAD_DONE);
+	jobsDone++;
+}
+
+// Runs on a worker thread (or the render thread if it got there first). Only touches this job's slot.
+void AssetCache::decodeJob(int job)
+{
+	if (job < ASSET_COUNT) {
+		decodedSurfaces[job] = loadSurface((AssetID) job);
+	}
+	else {
+		int id = job - ASSET_COUNT;
+		if (archive.find(MUSIC_MANIFEST[id].path) != nullptr) {
+			return;
+		}
+		std::ifstream music_file(MUSIC_MANIFEST[id].path, std::ios::binary);
+		if (music_file.is_open()) {
+			musicData[id].assign(std::istreambuf_iterator<char>(music_file), std::istreambuf_iterator<char>());
+		}
+		else {
+			std::cout << "Unable to read music " << MUSIC_MANIFEST[id].path << std::endl;
+		}
+	}
+}
+
+int AssetCache::decodeWorker(void* data)
+{
+	AssetCache* cache = (AssetCache*) data;
+	while (true) {
+		int i = SDL_AtomicAdd(&cache->nextJob, 1);
+		if (i >= (int) cache->jobs.size()) {
+			break;
+		}
+		int job = cache->jobs[i];
+		// The render thread may have claimed this job already because it needed it right away
+		if (SDL_AtomicCAS(&cache->jobStates[job], LOAD_PENDING, LOAD_DECODING)) {
+			cache->decodeJob(job);
+			SDL_AtomicSet(&cache->jobStates[job], LOAD_DECODED);
+		}
+	}
+	return 0;
+}
+
+void AssetCache::load(AssetID id)
+{
+	SDL_Surface* startSurf = loadSurface(id);
+	if (startSurf == nullptr) {
+		return;
+	}
+	upload(id, startSurf);
+	SDL_FreeSurface(startSurf);
+}
+
+// Safe to call from any thread
+SDL_Surface* AssetCache::loadSurface(AssetID id)
+{
+	SDL_Surface* surf;
+	const ArchiveEntry* entry = archive.find(MANIFEST[id].path);
+	if (entry != nullptr && entry->type == ENTRY_RGBA) {
+		// Already decoded at pack time, so this only points a surface at the mapped pixels
+		surf = archive.createSurface(entry);
+	}
+	else if (entry != nullptr) {
+		surf = IMG_Load_RW(archive.createRW(entry), 1);
+	}
+	else {
+		surf = IMG_Load(MANIFEST[id].path);
+	}
+	if (surf == nullptr) {
+		std::cout << "Unable to load image " << MANIFEST[id].path << "! SDL Error: " << SDL_GetError() << std::endl;
+	}
+	return surf;
+}
+
+void AssetCache::upload(AssetID id, SDL_Surface* surf)
+{
+	textures[id] = SDL_CreateTextureFromSurface(gRenderer, surf);
+	if (textures[id] == nullptr) {
+		std::cout << "Unable to create texture from " << MANIFEST[id].path << "! SDL Error: " << SDL_GetError() << std::endl;
+	}
+	else {
+		// Textures are uploaded as 32-bit pixels regardless of the PNG's format
+		memoryUsage[id] = (size_t) surf->w * surf->h * 4;
+	}
+}
+
+void AssetCache::loadMusic(MusicID id)
+{
+	const ArchiveEntry* entry = archive.find(MUSIC_MANIFEST[id].path);
+	if (entry != nullptr) {
+		// Streams straight out of the mapped archive
+		music[id] = Mix_LoadMUS_RW(archive.createRW(entry), 1);
+	}
+	else {
+		music[id] = Mix_LoadMUS(MUSIC_MANIFEST[id].path);
+	}
+	if (music[id] == NULL) {
+		printf( "Failed to load beat music! SDL_mixer Error: %s\n", Mix_GetError() );
+	}
+}
+
+void AssetCache::unload(AssetID id)
+{
+	if (textures[id] != nullptr) {
+		SDL_DestroyTexture(textures[id]);
+		textures[id] = nullptr;
+	}
+	memoryUsage[id] = 0;
+}
+
+static Uint32 greatestCommonDivisor(Uint32 a, Uint32 b)
+{
+	while (b != 0) {
+		Uint32 r = a % b;
+		a = b;
+		b = r;
+	}
+	return a;
+}
+
+void AssetCache::buildAnimation(AnimationID id)
+{
+	const AnimationManifestEntry &entry = ANIMATION_MANIFEST[id];
+	AnimationClip &clip = animations[id];
+	clip.loops = entry.loops;
+	clip.frames.assign(entry.frameCount, SDL_Rect{0, 0, 0, 0});
+
+	// Lay the frames out left to right, giving each image one spot even if it is shown several times
+	SDL_Texture* images[MAX_ANIMATION_FRAMES];
+	int sheet_w = 0;
+	int sheet_h = 0;
+	for (int i = 0; i < entry.frameCount; i++) {
+		images[i] = nullptr;
+		AssetID image = entry.frames[i].image;
+		if (image == ASSET_NONE) {
+			continue;
+		}
+		for (int j = 0; j < i; j++) {
+			if (entry.frames[j].image == image) {
+				clip.frames[i] = clip.frames[j];
+				break;
+			}
+		}
+		if (clip.frames[i].w != 0) {
+			continue;
+		}
+		images[i] = acquire(image);
+		if (images[i] == nullptr) {
+			continue;
+		}
+		clip.frames[i].x = sheet_w;
+		SDL_QueryTexture(images[i], nullptr, nullptr, &clip.frames[i].w, &clip.frames[i].h);
+		sheet_w += clip.frames[i].w;
+		if (clip.frames[i].h > sheet_h) sheet_h = clip.frames[i].h;
+	}
+
+	clip.sheet = nullptr;
+	if (sheet_w > 0) {
+		clip.sheet = SDL_CreateTexture(gRenderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET, sheet_w, sheet_h);
+		if (clip.sheet == nullptr) {
+			std::cout << "Unable to create sprite sheet! SDL Error: " << SDL_GetError() << std::endl;
+		}
+	}
+	if (clip.sheet != nullptr) {
+		SDL_SetTextureBlendMode(clip.sheet, SDL_BLENDMODE_BLEND);
+		SDL_Texture* old_target = SDL_GetRenderTarget(gRenderer);
+		SDL_SetRenderTarget(gRenderer, clip.sheet);
+		SDL_SetRenderDrawBlendMode(gRenderer, SDL_BLENDMODE_NONE);
+		SDL_SetRenderDrawColor(gRenderer, 0x00, 0x00, 0x00, 0x00);
+		SDL_RenderClear(gRenderer);
+		for (int i = 0; i < entry.frameCount; i++) {
+			if (images[i] == nullptr) {
+				continue;
+			}
+			// Copy alpha as is, so the sheet blends exactly like the separate images did
+			SDL_BlendMode blend_mode;
+			SDL_GetTextureBlendMode(images[i], &blend_mode);
+			SDL_SetTextureBlendMode(images[i], SDL_BLENDMODE_NONE);
+			SDL_RenderCopy(gRenderer, images[i], nullptr, &clip.frames[i]);
+			SDL_SetTextureBlendMode(images[i], blend_mode);
+		}
+		SDL_SetRenderTarget(gRenderer, old_target);
+		SDL_SetRenderDrawColor(gRenderer, 0x00, 0x00, 0x00, 0xFF);
+		animationMemory += (size_t) sheet_w * sheet_h * 4;
+	}
+
+	// The separate images are only kept if something else still uses them
+	for (int i = 0; i < entry.frameCount; i++) {
+		if (images[i] == nullptr) {
+			continue;
+		}
+		release(entry.frames[i].image);
+		if (refCounts[entry.frames[i].image] == 0) {
+			unload(entry.frames[i].image);
+		}
+		if (clip.sheet == nullptr) {
+			clip.frames[i] = SDL_Rect{0, 0, 0, 0};
+		}
+	}
+
+	clip.step = entry.frames[0].duration;
+	clip.length = 0;
+	for (int i = 0; i < entry.frameCount; i++) {
+		clip.step = greatestCommonDivisor(clip.step, entry.frames[i].duration);
+		clip.length += entry.frames[i].duration;
+	}
+	if (clip.step == 0) {
+		clip.step = 1;
+	}
+	clip.schedule.clear();
+	for (int i = 0; i < entry.frameCount; i++) {
+		for (Uint32 t = 0; t < entry.frames[i].duration; t += clip.step) {
+			clip.schedule.push_back(i);
+		}
+	}
+	animationBuilt[id] = true;
+}
@@ -0,0 +1,254 @@
+#ifndef AssetCache_H
+#define AssetCache_H
+
+#include <SDL.h>
+#include <SDL_image.h>
+#include <SDL_mixer.h>
+#include <SDL_ttf.h>
+#include <string>
+#include <vector>
+#include "AssetArchive.h"
+
+// Every image the game draws, in manifest order
+enum AssetID
+{
+	ASSET_BACKGROUND,
+	ASSET_START_SCREEN,
+	ASSET_START_BUTTON,
+	ASSET_DIFF_SCREEN,
+	ASSET_EASY_BUTTON,
+	ASSET_MED_BUTTON,
+	ASSET_HARD_BUTTON,
+	ASSET_CRED_BUTTON,
+	ASSET_RESTART_BUTTON,
+	ASSET_PLAYER_PLANE_1,
+	ASSET_PLAYER_PLANE_2,
+	ASSET_ENEMY_PLANE_1,
+	ASSET_ENEMY_PLANE_2,
+	ASSET_KAMIKAZE_1,
+	ASSET_KAMIKAZE_2,
+	ASSET_EXPLOSION,
+	ASSET_DUST_CLOUD,
+	ASSET_TOP_TURRET,
+	ASSET_BOTTOM_TURRET,
+	ASSET_STALACTITE_1,
+	ASSET_STALACTITE_2,
+	ASSET_STALACTITE_3,
+	ASSET_STALACTITE_4,
+	ASSET_STALAGMITE_1,
+	ASSET_STALAGMITE_2,
+	ASSET_STALAGMITE_3,
+	ASSET_STALAGMITE_4,
+	ASSET_HEALTH,
+	ASSET_MISSILE_1,
+	ASSET_MISSILE_2,
+	ASSET_INF_FIRE,
+	ASSET_INVINCE,
+	ASSET_AUTOFIRE,
+	ASSET_CREDIT_HELLESTED,
+	ASSET_CREDIT_DILAN,
+	ASSET_CREDIT_TRANT,
+	ASSET_CREDIT_ZOMPER,
+	ASSET_CREDIT_CHOO,
+	ASSET_CREDIT_YUCEL,
+	ASSET_CREDIT_MD,
+	ASSET_CREDIT_SCHWARTZ,
+	ASSET_CREDIT_BRANDON,
+	ASSET_CREDIT_JEROEN,
+	ASSET_COUNT,
+	// An animation frame that draws nothing
+	ASSET_NONE = ASSET_COUNT
+};
+
+// Every music track the game plays
+enum MusicID
+{
+	MUSIC_TRASH_BEAT,
+	MUSIC_MAIN_TRACK,
+	MUSIC_START_TRACK,
+	MUSIC_COUNT
+};
+
+// One line of the asset manifest: where the image lives and whether it is loaded at startup
+struct AssetManifestEntry
+{
+	AssetID id;
+	const char* path;
+	bool preload;
+};
+
+struct MusicManifestEntry
+{
+	MusicID id;
+	const char* path;
+	// Played instead if this track isn't there; a track that is its own fallback has to be shipped
+	MusicID fallback;
+};
+
+// Every animation, in animation manifest order
+enum AnimationID
+{
+	ANIM_PLAYER,
+	ANIM_PLAYER_HIT,
+	ANIM_ENEMY,
+	ANIM_ENEMY_HIT,
+	ANIM_KAMIKAZE,
+	ANIM_EXPLOSION,
+	ANIM_DUST_CLOUD,
+	ANIM_COUNT,
+	ANIM_NONE = ANIM_COUNT
+};
+
+static const int MAX_ANIMATION_FRAMES = 10;
+
+// One frame of an animation: which image to show and for how many ms
+struct AnimationFrame
+{
+	AssetID image;
+	Uint32 duration;
+};
+
+// One line of the animation manifest. Clips that don't loop stop on their last frame.
+struct AnimationManifestEntry
+{
+	AnimationID id;
+	bool loops;
+	int frameCount;
+	AnimationFrame frames[MAX_ANIMATION_FRAMES];
+};
+
+// An animation ready to draw. Its frames are packed side by side into one sprite sheet, and the
+// schedule gives the frame for every step of the clip, so picking a frame is a single lookup.
+struct AnimationClip
+{
+	SDL_Texture* sheet;
+	// Where each frame is in the sheet; empty for frames that draw nothing
+	std::vector<SDL_Rect> frames;
+	std::vector<int> schedule;
+	// Length of one schedule entry (the largest step every frame duration is a multiple of) and of the clip, in ms
+	Uint32 step;
+	Uint32 length;
+	bool loops;
+};
+
+// Owns every texture in the game. Classes acquire a texture by ID instead of decoding their own copy,
+// and release it when they are done. Textures stay alive when their count drops to zero so that
+// restarting the game doesn't decode the same PNGs again; purgeUnused() frees them explicitly.
+//
+// Loading can also happen in the background: beginAsyncLoad() has worker threads decode the preload
+// list to SDL_Surfaces and read the music files into memory, and pumpUploads() turns finished surfaces
+// into textures on the render thread a few at a time so the menus keep drawing.
+//
+// If assets.pak (made by `make pack`) is next to the game, everything comes out of that one mapped
+// file instead; assets missing from it are still read from their loose files.
+class AssetCache
+{
+public:
+	static const AssetManifestEntry MANIFEST[ASSET_COUNT];
+	static const MusicManifestEntry MUSIC_MANIFEST[MUSIC_COUNT];
+	static const AnimationManifestEntry ANIMATION_MANIFEST[ANIM_COUNT];
+	static const char* FONT_PATH;
+
+	// Most textures pumpUploads() creates in one call
+	static const int UPLOADS_PER_PUMP = 4;
+
+	AssetCache(SDL_Renderer *gRenderer);
+	~AssetCache();
+
+	// Loads every manifest entry flagged for preloading
+	void preload();
+
+	// Hands out a shared texture, loading it on first use
+	SDL_Texture* acquire(AssetID id);
+	void release(AssetID id);
+
+	// Returns the texture without touching its reference count (nullptr if it isn't loaded)
+	SDL_Texture* get(AssetID id);
+
+	int getRefCount(AssetID id);
+	size_t getMemoryUsage(AssetID id);
+	size_t getTotalMemoryUsage();
+
+	// Prints the size and reference count of every loaded asset
+	void reportMemory();
+
+	// Frees textures that nothing is holding on to
+	void purgeUnused();
+
+	// Builds an animation's sprite sheet on first use from its frames' textures, which are freed
+	// afterwards if nothing else holds them. Must be called by whoever holds the renderer.
+	const AnimationClip* acquireAnimation(AnimationID id);
+	void releaseAnimation(AnimationID id);
+	// Returns the clip without touching its reference count (nullptr if it isn't built)
+	const AnimationClip* getAnimation(AnimationID id);
+
+	// Music is loaded synchronously unless the background loader already read it
+	Mix_Music* getMusic(MusicID id);
+
+	// Opens a font from the archive if it was packed, from its own file otherwise
+	TTF_Font* openFont(const char* path, int ptsize);
+
+	// Starts decoding every preload asset and music track that isn't loaded yet on worker threads
+	void beginAsyncLoad();
+	// Uploads up to maxUploads decoded surfaces as textures. Must be called on the render thread.
+	void pumpUploads(int maxUploads = UPLOADS_PER_PUMP);
+	// Blocks until the background load is done and everything is uploaded
+	void finishAsyncLoad();
+	// Fraction of the background load that is usable, from 0 to 1
+	float getLoadProgress();
+	bool isAsyncLoadDone();
+
+private:
+	// Where each asset is in the background loader
+	enum LoadState
+	{
+		LOAD_PENDING,
+		LOAD_DECODING,
+		LOAD_DECODED,
+		LOAD_DONE
+	};
+
+	SDL_Renderer *gRenderer;
+	// Declared before anything that can point into it, so it is unmapped last
+	AssetArchive archive;
+
+	SDL_Texture* textures[ASSET_COUNT];
+	int refCounts[ASSET_COUNT];
+	size_t memoryUsage[ASSET_COUNT];
+
+	AnimationClip animations[ANIM_COUNT];
+	bool animationBuilt[ANIM_COUNT];
+	int animationRefCounts[ANIM_COUNT];
+	size_t animationMemory;
+
+	Mix_Music* music[MUSIC_COUNT];
+	// Raw music files read by the workers; Mix_Music streams from these, so they live as long as it does
+	std::vector<char> musicData[MUSIC_COUNT];
+
+	// Background loader state. jobs is filled before the workers start and never changes while they run.
+	std::vector<int> jobs;
+	SDL_atomic_t nextJob;
+	SDL_atomic_t jobStates[ASSET_COUNT + MUSIC_COUNT];
+	SDL_Surface* decodedSurfaces[ASSET_COUNT];
+	std::vector<SDL_Thread*> workers;
+	int jobsDone;
+
+	void load(AssetID id);
+	SDL_Surface* loadSurface(AssetID id);
+	void unload(AssetID id);
+	void upload(AssetID id, SDL_Surface* surf);
+	void loadMusic(MusicID id);
+	void buildAnimation(AnimationID id);
+
+	void waitForWorkers();
+	// Makes sure a job is loaded, doing the decode here if no worker has started it yet
+	void completeJob(int job);
+	void finishJob(int job);
+	void decodeJob(int job);
+	static int decodeWorker(void* data);
+};
+
+// The cache shared by the whole game, created in main() once the renderer exists
+extern AssetCache *gAssets;
+
+#endif
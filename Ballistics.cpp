@@ -0,0 +1,111 @@
+#include "Ballistics.h"
+#include <cmath>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define BALLISTICS_AVX
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define BALLISTICS_SSE2
+#endif
+
+constexpr float Ballistics::GRAVITY;
+constexpr float Ballistics::DRAG;
+
+float Ballistics::dragFor(float xVel)
+{
+	if (xVel > 0) return -DRAG;
+	if (xVel < 0) return DRAG;
+	return 0;
+}
+
+// A projectile that stops going sideways during the step covers xVel^2 / (2 DRAG) getting there, and
+// then only falls. Every lane works out both and keeps the one that applies.
+void Ballistics::step(float* x, float* y, float* xVel, float* yVel, const float* xAccel, const float* seconds, int count)
+{
+	const float half_gravity = 0.5f * GRAVITY;
+	const float stop_factor = 0.5f / DRAG;
+	int i = 0;
+#ifdef BALLISTICS_AVX
+	{
+		__m256 zero = _mm256_setzero_ps();
+		__m256 sign = _mm256_set1_ps(-0.0f);
+		__m256 half = _mm256_set1_ps(0.5f);
+		__m256 gravity = _mm256_set1_ps(GRAVITY);
+		__m256 half_g = _mm256_set1_ps(half_gravity);
+		__m256 stop = _mm256_set1_ps(stop_factor);
+		for (; i + 8 <= count; i += 8) {
+			__m256 t = _mm256_loadu_ps(seconds + i);
+			__m256 vx = _mm256_loadu_ps(xVel + i);
+			__m256 ax = _mm256_loadu_ps(xAccel + i);
+			__m256 vy = _mm256_loadu_ps(yVel + i);
+
+			__m256 vx_end = _mm256_add_ps(vx, _mm256_mul_ps(ax, t));
+			__m256 moving = _mm256_cmp_ps(_mm256_mul_ps(vx_end, vx), zero, _CMP_GT_OQ);
+			__m256 moving_dx = _mm256_add_ps(_mm256_mul_ps(vx, t), _mm256_mul_ps(_mm256_mul_ps(_mm256_mul_ps(half, ax), t), t));
+			__m256 stop_dx = _mm256_mul_ps(_mm256_mul_ps(vx, _mm256_andnot_ps(sign, vx)), stop);
+			__m256 dx = _mm256_or_ps(_mm256_and_ps(moving, moving_dx), _mm256_andnot_ps(moving, stop_dx));
+			__m256 dy = _mm256_add_ps(_mm256_mul_ps(vy, t), _mm256_mul_ps(_mm256_mul_ps(half_g, t), t));
+
+			_mm256_storeu_ps(x + i, _mm256_add_ps(_mm256_loadu_ps(x + i), dx));
+			_mm256_storeu_ps(y + i, _mm256_add_ps(_mm256_loadu_ps(y + i), dy));
+			_mm256_storeu_ps(xVel + i, _mm256_and_ps(moving, vx_end));
+			_mm256_storeu_ps(yVel + i, _mm256_add_ps(vy, _mm256_mul_ps(gravity, t)));
+		}
+	}
+#endif
+#ifdef BALLISTICS_SSE2
+	{
+		__m128 zero = _mm_setzero_ps();
+		__m128 sign = _mm_set1_ps(-0.0f);
+		__m128 half = _mm_set1_ps(0.5f);
+		__m128 gravity = _mm_set1_ps(GRAVITY);
+		__m128 half_g = _mm_set1_ps(half_gravity);
+		__m128 stop = _mm_set1_ps(stop_factor);
+		for (; i + 4 <= count; i += 4) {
+			__m128 t = _mm_loadu_ps(seconds + i);
+			__m128 vx = _mm_loadu_ps(xVel + i);
+			__m128 ax = _mm_loadu_ps(xAccel + i);
+			__m128 vy = _mm_loadu_ps(yVel + i);
+
+			__m128 vx_end = _mm_add_ps(vx, _mm_mul_ps(ax, t));
+			__m128 moving = _mm_cmpgt_ps(_mm_mul_ps(vx_end, vx), zero);
+			__m128 moving_dx = _mm_add_ps(_mm_mul_ps(vx, t), _mm_mul_ps(_mm_mul_ps(_mm_mul_ps(half, ax), t), t));
+			__m128 stop_dx = _mm_mul_ps(_mm_mul_ps(vx, _mm_andnot_ps(sign, vx)), stop);
+			__m128 dx = _mm_or_ps(_mm_and_ps(moving, moving_dx), _mm_andnot_ps(moving, stop_dx));
+			__m128 dy = _mm_add_ps(_mm_mul_ps(vy, t), _mm_mul_ps(_mm_mul_ps(half_g, t), t));
+
+			_mm_storeu_ps(x + i, _mm_add_ps(_mm_loadu_ps(x + i), dx));
+			_mm_storeu_ps(y + i, _mm_add_ps(_mm_loadu_ps(y + i), dy));
+			_mm_storeu_ps(xVel + i, _mm_and_ps(moving, vx_end));
+			_mm_storeu_ps(yVel + i, _mm_add_ps(vy, _mm_mul_ps(gravity, t)));
+		}
+	}
+#endif
+	for (; i < count; i++) {
+		float t = seconds[i];
+		float vx = xVel[i];
+		float vx_end = vx + xAccel[i] * t;
+		if (vx_end * vx > 0) {
+			x[i] += vx * t + 0.5f * xAccel[i] * t * t;
+			xVel[i] = vx_end;
+		}
+		else {
+			x[i] += vx * std::fabs(vx) * stop_factor;
+			xVel[i] = 0;
+		}
+		y[i] += yVel[i] * t + half_gravity * t * t;
+		yVel[i] += GRAVITY * t;
+	}
+}
+
+void BallisticBatch::resize(int count)
+{
+	x.resize(count);
+	y.resize(count);
+	xVel.resize(count);
+	yVel.resize(count);
+	xAccel.resize(count);
+	seconds.resize(count);
+}
@@ -0,0 +1,35 @@
+#ifndef Ballistics_H
+#define Ballistics_H
+
+#include <vector>
+
+// Flight of projectiles that drop and slow down: gravity pulls them down, and drag slows them sideways
+// at a constant rate until they stop going sideways at all. Both are constant accelerations, so a step
+// uses the exact closed form rather than integrating, and a bullet lands in the same place whatever
+// the frame rate.
+//
+// step() moves many projectiles held as arrays: eight at a time with AVX2, four with SSE2, and the same
+// sums one at a time for whatever is left over.
+class Ballistics
+{
+public:
+	// px/s^2
+	static constexpr float GRAVITY = 100;
+	static constexpr float DRAG = 50;
+
+	// Sideways acceleration of a projectile first going at xVel, which drag works against
+	static float dragFor(float xVel);
+
+	// Moves count projectiles on by their own number of seconds. xAccel is each one's dragFor().
+	static void step(float* x, float* y, float* xVel, float* yVel, const float* xAccel, const float* seconds, int count);
+};
+
+// Arrays for stepping a batch of projectiles at once, kept between ticks so a step does not allocate
+struct BallisticBatch
+{
+	std::vector<float> x, y, xVel, yVel, xAccel, seconds;
+
+	void resize(int count);
+};
+
+#endif
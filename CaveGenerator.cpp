@@ -0,0 +1,104 @@
+#include "CaveGenerator.h"
+#include <iostream>
+
+CaveGenerator::CaveGenerator()
+{
+	wake = SDL_CreateSemaphore(0);
+	requestLock = SDL_CreateMutex();
+	hasRequest = false;
+	ready = nullptr;
+	level = nullptr;
+	SDL_AtomicSet(&running, 1);
+	thread = SDL_CreateThread(generateLoop, "Caves", this);
+	if (thread == nullptr) {
+		std::cout << "Unable to create cave thread, caves will be generated as they come! SDL Error: " << SDL_GetError() << std::endl;
+	}
+}
+
+CaveGenerator::~CaveGenerator()
+{
+	if (thread != nullptr) {
+		SDL_AtomicSet(&running, 0);
+		SDL_SemPost(wake);
+		SDL_WaitThread(thread, nullptr);
+	}
+	delete (CaveSystem*) SDL_AtomicSetPtr(&ready, nullptr);
+	SDL_DestroyMutex(requestLock);
+	SDL_DestroySemaphore(wake);
+}
+
+void CaveGenerator::setLevel(LevelFile* level)
+{
+	this->level = level;
+}
+
+Uint32 CaveGenerator::getCaveSeed(Uint32 levelSeed, int offsetX)
+{
+	return levelSeed ^ (Uint32) (offsetX / CaveSystem::CAVE_SYSTEM_FREQ);
+}
+
+void CaveGenerator::request(int offsetX, int difficulty, Uint32 levelSeed, CaveStyle style)
+{
+	if (thread == nullptr) {
+		return;
+	}
+	// Only held to copy the request in or out, once per cave
+	SDL_LockMutex(requestLock);
+	wanted = {offsetX, difficulty, getCaveSeed(levelSeed, offsetX), style};
+	hasRequest = true;
+	SDL_UnlockMutex(requestLock);
+	SDL_SemPost(wake);
+}
+
+CaveSystem* CaveGenerator::take(int offsetX, int difficulty, Uint32 levelSeed, CaveStyle style)
+{
+	Uint32 seed = getCaveSeed(levelSeed, offsetX);
+	CaveSystem* cave = (CaveSystem*) SDL_AtomicSetPtr(&ready, nullptr);
+
+	// Left over from before a restart, or the worker hasn't finished it
+	if (cave != nullptr && (cave->offsetX != offsetX || cave->diff != difficulty || cave->seed != seed || cave->style != style)) {
+		delete cave;
+		cave = nullptr;
+	}
+	if (cave == nullptr) {
+		cave = build({offsetX, difficulty, seed, style});
+	}
+	cave->enable();
+	return cave;
+}
+
+CaveSystem* CaveGenerator::build(const Request &request)
+{
+	if (level != nullptr) {
+		const LevelCave* saved = level->findCave(request.offsetX);
+		if (saved != nullptr && saved->seed == request.seed) {
+			return new CaveSystem(*saved, request.difficulty, request.style);
+		}
+	}
+	return new CaveSystem(request.offsetX, request.difficulty, request.seed, request.style);
+}
+
+int CaveGenerator::generateLoop(void* data)
+{
+	CaveGenerator* generator = (CaveGenerator*) data;
+	while (true) {
+		SDL_SemWait(generator->wake);
+		if (!SDL_AtomicGet(&generator->running)) {
+			break;
+		}
+
+		SDL_LockMutex(generator->requestLock);
+		Request request = generator->wanted;
+		bool hasRequest = generator->hasRequest;
+		generator->hasRequest = false;
+		SDL_UnlockMutex(generator->requestLock);
+		if (!hasRequest) {
+			continue;
+		}
+
+		CaveSystem* cave = generator->build(request);
+		// A cave still in the slot was never taken, so it was made for an older request
+		delete (CaveSystem*) SDL_AtomicSetPtr(&generator->ready, cave);
+	}
+	return 0;
+}
@@ -0,0 +1,57 @@
+#ifndef CaveGenerator_H
+#define CaveGenerator_H
+
+#include <SDL.h>
+#include "CaveSystem.h"
+#include "LevelFile.h"
+
+// Generates the next cave system on a worker thread while the current stretch of level plays, so
+// the cave is ready by the time the camera reaches it. Each cave comes from its own seed (the
+// level's cave seed and which cave it is), so one made ahead of time is the same as one made on the
+// spot if the worker falls behind.
+//
+// The finished cave is handed over through a single pointer slot that each side swaps atomically,
+// the worker to fill it and the main thread to empty it, so taking a cave never waits on the worker.
+class CaveGenerator
+{
+public:
+	CaveGenerator();
+	// Stops the worker and frees any cave nobody took
+	~CaveGenerator();
+
+	// Caves the saved level has are loaded from it instead of generated. Set before requesting any caves.
+	void setLevel(LevelFile* level);
+
+	// The seed of the cave starting a screen past offsetX in a level with this cave seed
+	static Uint32 getCaveSeed(Uint32 levelSeed, int offsetX);
+
+	// Starts generating the cave for offsetX in the background. Replaces any earlier request.
+	void request(int offsetX, int difficulty, Uint32 levelSeed, CaveStyle style);
+	// The cave for offsetX, made ahead of time if the worker got to it, otherwise generated now.
+	// It is enabled and ready to use.
+	CaveSystem* take(int offsetX, int difficulty, Uint32 levelSeed, CaveStyle style);
+
+private:
+	struct Request
+	{
+		int offsetX;
+		int difficulty;
+		Uint32 seed;
+		CaveStyle style;
+	};
+
+	SDL_Thread *thread;
+	SDL_sem *wake;
+	SDL_mutex *requestLock;
+	Request wanted;			// Guarded by requestLock
+	bool hasRequest;		// Guarded by requestLock
+	SDL_atomic_t running;
+	void* ready;			// The finished cave, only ever swapped with SDL_AtomicSetPtr
+	LevelFile* level;
+
+	CaveSystem* build(const Request &request);
+
+	static int generateLoop(void* data);
+};
+
+#endif
@@ -0,0 +1,189 @@
+#include "CaveNavField.h"
+#include "CaveSystem.h"
+#include <algorithm>
+#include <cstdlib>
+
+CaveNavField::CaveNavField()
+{
+	columns = 0;
+	rows = 0;
+}
+
+void CaveNavField::build(CaveSystem *cave)
+{
+	columns = CaveSystem::CAVE_SYSTEM_WIDTH;
+	rows = CaveSystem::CAVE_SYSTEM_HEIGHT;
+	solid.resize(rows * columns);
+	distance.resize(rows * columns);
+	readBlocks(cave, 0, columns - 1);
+	computeDistances(0, columns - 1);
+
+	// The path can double back on itself, so take the last row it passes through in each column,
+	// and carry the row over columns it skips
+	pathRow.assign(columns, -1);
+	PathSequence* path = cave->getPathSequence();
+	int i, j;
+	for (i = 0; i < path->length; i++) {
+		if (path->x[i] >= 0 && path->x[i] < columns && path->y[i] >= 0 && path->y[i] < rows) {
+			pathRow[path->x[i]] = path->y[i];
+		}
+	}
+	int row = rows / 2;
+	for (j = 0; j < columns; j++) {
+		if (pathRow[j] >= 0) {
+			row = pathRow[j];
+		}
+		pathRow[j] = row;
+	}
+
+	openTop.resize(columns);
+	openBottom.resize(columns);
+	safeRow.resize(columns);
+	for (j = 0; j < columns; j++) {
+		findPassage(j);
+	}
+}
+
+void CaveNavField::refresh(CaveSystem *cave, int firstColumn, int lastColumn)
+{
+	if (columns == 0) {
+		return;
+	}
+	firstColumn = std::max(0, firstColumn - REFRESH_MARGIN);
+	lastColumn = std::min(columns - 1, lastColumn + REFRESH_MARGIN);
+	readBlocks(cave, firstColumn, lastColumn);
+	computeDistances(firstColumn, lastColumn);
+	for (int j = firstColumn; j <= lastColumn; j++) {
+		findPassage(j);
+	}
+}
+
+void CaveNavField::readBlocks(CaveSystem *cave, int firstColumn, int lastColumn)
+{
+	for (int i = 0; i < rows; i++)
+		for (int j = firstColumn; j <= lastColumn; j++)
+			solid[i * columns + j] = cave->cave_system[i][j]->enabled == 1;
+}
+
+// Two passes of a chamfer distance transform over the columns: the first carries distances down
+// and right from the walls above and to the left, the second up and left from the rest. Off the top
+// and bottom of the cave counts as wall; off the ends is the way in and out, so it doesn't. Columns
+// either side of the range keep their distances and feed into it.
+void CaveNavField::computeDistances(int firstColumn, int lastColumn)
+{
+	const int far = 0xFFFF;
+	int i, j;
+	for (i = 0; i < rows; i++)
+		for (j = firstColumn; j <= lastColumn; j++) {
+			if (solid[i * columns + j]) {
+				distance[i * columns + j] = 0;
+				continue;
+			}
+			int d = far;
+			if (i == 0) d = std::min(d, STRAIGHT_STEP);
+			if (j > 0) d = std::min(d, distance[i * columns + j - 1] + STRAIGHT_STEP);
+			if (i > 0) {
+				d = std::min(d, distance[(i - 1) * columns + j] + STRAIGHT_STEP);
+				if (j > 0) d = std::min(d, distance[(i - 1) * columns + j - 1] + DIAGONAL_STEP);
+				if (j < columns - 1) d = std::min(d, distance[(i - 1) * columns + j + 1] + DIAGONAL_STEP);
+			}
+			distance[i * columns + j] = std::min(d, far);
+		}
+	for (i = rows - 1; i >= 0; i--)
+		for (j = lastColumn; j >= firstColumn; j--) {
+			int d = distance[i * columns + j];
+			if (i == rows - 1) d = std::min(d, STRAIGHT_STEP);
+			if (j < columns - 1) d = std::min(d, distance[i * columns + j + 1] + STRAIGHT_STEP);
+			if (i < rows - 1) {
+				d = std::min(d, distance[(i + 1) * columns + j] + STRAIGHT_STEP);
+				if (j < columns - 1) d = std::min(d, distance[(i + 1) * columns + j + 1] + DIAGONAL_STEP);
+				if (j > 0) d = std::min(d, distance[(i + 1) * columns + j - 1] + DIAGONAL_STEP);
+			}
+			distance[i * columns + j] = d;
+		}
+}
+
+// The passage in a column is the open run the path goes through, or the nearest one if the path
+// row itself is solid. The safe row is its roomiest row, the one nearest the path if there are several.
+void CaveNavField::findPassage(int column)
+{
+	int path = pathRow[column];
+	int row = -1;
+	for (int offset = 0; offset < rows && row < 0; offset++) {
+		if (path - offset >= 0 && !solid[(path - offset) * columns + column]) {
+			row = path - offset;
+		}
+		else if (path + offset < rows && !solid[(path + offset) * columns + column]) {
+			row = path + offset;
+		}
+	}
+	if (row < 0) {
+		openTop[column] = path + 1;
+		openBottom[column] = path;
+		safeRow[column] = path;
+		return;
+	}
+
+	int top = row;
+	int bottom = row;
+	while (top > 0 && !solid[(top - 1) * columns + column]) top--;
+	while (bottom < rows - 1 && !solid[(bottom + 1) * columns + column]) bottom++;
+	int best = row;
+	for (int i = top; i <= bottom; i++) {
+		int d = distance[i * columns + column];
+		int bestD = distance[best * columns + column];
+		if (d > bestD || (d == bestD && abs(i - path) < abs(best - path))) {
+			best = i;
+		}
+	}
+	openTop[column] = top;
+	openBottom[column] = bottom;
+	safeRow[column] = best;
+}
+
+int CaveNavField::columnAt(int x)
+{
+	int column = x / CaveBlock::CAVE_BLOCK_WIDTH;
+	return std::max(0, std::min(columns - 1, column));
+}
+
+int CaveNavField::toPixels(int steps)
+{
+	return steps * CaveBlock::CAVE_BLOCK_WIDTH / STRAIGHT_STEP;
+}
+
+int CaveNavField::getSafeY(int x)
+{
+	if (columns == 0) {
+		return -1;
+	}
+	return safeRow[columnAt(x)] * CaveBlock::CAVE_BLOCK_HEIGHT + CaveBlock::CAVE_BLOCK_HEIGHT / 2;
+}
+
+int CaveNavField::getOpenTop(int x)
+{
+	if (columns == 0) {
+		return 0;
+	}
+	return openTop[columnAt(x)] * CaveBlock::CAVE_BLOCK_HEIGHT;
+}
+
+int CaveNavField::getOpenBottom(int x)
+{
+	if (columns == 0) {
+		return 0;
+	}
+	return (openBottom[columnAt(x)] + 1) * CaveBlock::CAVE_BLOCK_HEIGHT;
+}
+
+int CaveNavField::getClearance(int x, int y)
+{
+	if (columns == 0) {
+		return 0;
+	}
+	int row = y / CaveBlock::CAVE_BLOCK_HEIGHT;
+	if (y < 0 || row >= rows) {
+		return 0;
+	}
+	return toPixels(distance[row * columns + columnAt(x)]);
+}
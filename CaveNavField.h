@@ -0,0 +1,56 @@
+#ifndef CaveNavField_H
+#define CaveNavField_H
+
+#include <SDL.h>
+#include <vector>
+
+class CaveSystem;
+
+// What the AI needs to know to fly through a cave, worked out once when the cave is made. Each
+// column has the open stretch the main passage runs through and the height in it furthest from the
+// walls, and every block has its distance to the nearest wall, so any of it is a lookup wherever the
+// enemy is. Positions are in pixels from the cave's top left corner.
+class CaveNavField
+{
+public:
+	CaveNavField();
+
+	// Reads the cave's blocks and path. Only touches the cave, so it can run on the cave thread.
+	void build(CaveSystem *cave);
+	// Catches up with blocks in these columns having been blown away. Only columns near them are
+	// worked out again; walls further off than that keep their old, shorter, distances.
+	void refresh(CaveSystem *cave, int firstColumn, int lastColumn);
+
+	// The height to fly at in the column under x: the middle of the roomiest part of the passage
+	int getSafeY(int x);
+	// The passage's top and bottom edges in the column under x. Bottom is above top where the
+	// column is solid all the way down.
+	int getOpenTop(int x);
+	int getOpenBottom(int x);
+	// How far (x, y) is from the nearest wall; 0 inside one
+	int getClearance(int x, int y);
+
+private:
+	// Distances are in chamfer steps: 3 to the next block over, 4 to the next one diagonally
+	static const int STRAIGHT_STEP = 3;
+	static const int DIAGONAL_STEP = 4;
+	// Columns either side of a change that get their distances worked out again
+	static const int REFRESH_MARGIN = 8;
+
+	int columns;
+	int rows;
+	std::vector<Uint8> solid;			// rows * columns, row by row
+	std::vector<Uint16> distance;
+	std::vector<Sint16> pathRow;		// Per column, in rows
+	std::vector<Sint16> openTop;
+	std::vector<Sint16> openBottom;
+	std::vector<Sint16> safeRow;
+
+	int columnAt(int x);
+	int toPixels(int steps);
+	void readBlocks(CaveSystem *cave, int firstColumn, int lastColumn);
+	void computeDistances(int firstColumn, int lastColumn);
+	void findPassage(int column);
+};
+
+#endif
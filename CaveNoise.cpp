@@ -0,0 +1,130 @@
+#include "CaveNoise.h"
+#include <math.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define CAVE_NOISE_SSE2
+#endif
+
+// Hash constants for mixing lattice coordinates
+static const Uint32 HASH_X = 0x27d4eb2d;
+static const Uint32 HASH_Y = 0x165667b1;
+static const Uint32 HASH_MIX = 0x2c1b3c6d;
+
+CaveNoise::CaveNoise(Uint32 seed) : seed{seed} {}
+
+static inline Uint32 hashCorner(Uint32 seed, int x, int y)
+{
+	Uint32 h = ((Uint32) x * HASH_X) ^ ((Uint32) y * HASH_Y) ^ seed;
+	h ^= h >> 15;
+	h *= HASH_MIX;
+	h ^= h >> 12;
+	return h;
+}
+
+// One of four diagonal gradients picked by the low bits of the hash, dotted with (x, y)
+static inline float gradient(Uint32 h, float x, float y)
+{
+	return ((h & 1) ? x : -x) + ((h & 2) ? y : -y);
+}
+
+static inline float fade(float t)
+{
+	return t * t * t * (t * (t * 6.0f - 15.0f) + 10.0f);
+}
+
+float CaveNoise::at(float x, float y)
+{
+	int ix = (int) floorf(x);
+	int iy = (int) floorf(y);
+	float fx = x - (float) ix;
+	float fy = y - (float) iy;
+
+	float n00 = gradient(hashCorner(seed, ix, iy), fx, fy);
+	float n10 = gradient(hashCorner(seed, ix + 1, iy), fx - 1.0f, fy);
+	float n01 = gradient(hashCorner(seed, ix, iy + 1), fx, fy - 1.0f);
+	float n11 = gradient(hashCorner(seed, ix + 1, iy + 1), fx - 1.0f, fy - 1.0f);
+
+	float u = fade(fx);
+	float v = fade(fy);
+	float bottom = n00 + u * (n10 - n00);
+	float top = n01 + u * (n11 - n01);
+	return bottom + v * (top - bottom);
+}
+
+#ifdef CAVE_NOISE_SSE2
+// SSE2 has no 32-bit multiply that keeps the low halves, so put one together from two 64-bit ones
+static inline __m128i multiplyLow(__m128i a, __m128i b)
+{
+	__m128i even = _mm_mul_epu32(a, b);
+	__m128i odd = _mm_mul_epu32(_mm_srli_si128(a, 4), _mm_srli_si128(b, 4));
+	return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)), _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+
+static inline __m128i hashCorners(__m128i seed, __m128i x, __m128i y)
+{
+	__m128i h = _mm_xor_si128(_mm_xor_si128(multiplyLow(x, _mm_set1_epi32(HASH_X)), multiplyLow(y, _mm_set1_epi32(HASH_Y))), seed);
+	h = _mm_xor_si128(h, _mm_srli_epi32(h, 15));
+	h = multiplyLow(h, _mm_set1_epi32(HASH_MIX));
+	return _mm_xor_si128(h, _mm_srli_epi32(h, 12));
+}
+
+static inline __m128 gradients(__m128i h, __m128 x, __m128 y)
+{
+	// Flip the sign bit of x where bit 0 is clear and of y where bit 1 is clear
+	__m128i one = _mm_set1_epi32(1);
+	__m128i flipX = _mm_slli_epi32(_mm_andnot_si128(h, one), 31);
+	__m128i flipY = _mm_slli_epi32(_mm_andnot_si128(_mm_srli_epi32(h, 1), one), 31);
+	return _mm_add_ps(_mm_xor_ps(x, _mm_castsi128_ps(flipX)), _mm_xor_ps(y, _mm_castsi128_ps(flipY)));
+}
+
+static inline __m128 fades(__m128 t)
+{
+	__m128 inner = _mm_add_ps(_mm_mul_ps(t, _mm_sub_ps(_mm_mul_ps(t, _mm_set1_ps(6.0f)), _mm_set1_ps(15.0f))), _mm_set1_ps(10.0f));
+	return _mm_mul_ps(_mm_mul_ps(_mm_mul_ps(t, t), t), inner);
+}
+
+static inline __m128i floors(__m128 v)
+{
+	// Truncating rounds negative numbers up, so take one off where that happened
+	__m128i truncated = _mm_cvttps_epi32(v);
+	__m128 roundedUp = _mm_cmpgt_ps(_mm_cvtepi32_ps(truncated), v);
+	return _mm_sub_epi32(truncated, _mm_and_si128(_mm_castps_si128(roundedUp), _mm_set1_epi32(1)));
+}
+#endif
+
+void CaveNoise::sample(const float* xs, const float* ys, float* out, int count)
+{
+	int i = 0;
+#ifdef CAVE_NOISE_SSE2
+	__m128i seeds = _mm_set1_epi32(seed);
+	__m128i one = _mm_set1_epi32(1);
+	__m128 onef = _mm_set1_ps(1.0f);
+	for (; i + 4 <= count; i += 4) {
+		__m128 x = _mm_loadu_ps(xs + i);
+		__m128 y = _mm_loadu_ps(ys + i);
+		__m128i ix = floors(x);
+		__m128i iy = floors(y);
+		__m128 fx = _mm_sub_ps(x, _mm_cvtepi32_ps(ix));
+		__m128 fy = _mm_sub_ps(y, _mm_cvtepi32_ps(iy));
+		__m128i ix1 = _mm_add_epi32(ix, one);
+		__m128i iy1 = _mm_add_epi32(iy, one);
+		__m128 fx1 = _mm_sub_ps(fx, onef);
+		__m128 fy1 = _mm_sub_ps(fy, onef);
+
+		__m128 n00 = gradients(hashCorners(seeds, ix, iy), fx, fy);
+		__m128 n10 = gradients(hashCorners(seeds, ix1, iy), fx1, fy);
+		__m128 n01 = gradients(hashCorners(seeds, ix, iy1), fx, fy1);
+		__m128 n11 = gradients(hashCorners(seeds, ix1, iy1), fx1, fy1);
+
+		__m128 u = fades(fx);
+		__m128 v = fades(fy);
+		__m128 bottom = _mm_add_ps(n00, _mm_mul_ps(u, _mm_sub_ps(n10, n00)));
+		__m128 top = _mm_add_ps(n01, _mm_mul_ps(u, _mm_sub_ps(n11, n01)));
+		_mm_storeu_ps(out + i, _mm_add_ps(bottom, _mm_mul_ps(v, _mm_sub_ps(top, bottom))));
+	}
+#endif
+	for (; i < count; i++) {
+		out[i] = at(xs[i], ys[i]);
+	}
+}
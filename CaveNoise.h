@@ -0,0 +1,23 @@
+#ifndef CaveNoise_H
+#define CaveNoise_H
+
+#include <SDL.h>
+
+// 2D gradient (Perlin) noise for the noise cave generator. Values come out roughly between -1 and 1
+// and depend only on the seed and the position, so any column of a cave can be worked out on its own.
+// Points are done four at a time with SSE2 where the compiler has it, and one at a time otherwise,
+// giving the same values either way.
+class CaveNoise
+{
+public:
+	CaveNoise(Uint32 seed);
+
+	// Noise at (xs[i], ys[i]) into out[i] for count points
+	void sample(const float* xs, const float* ys, float* out, int count);
+	float at(float x, float y);
+
+private:
+	Uint32 seed;
+};
+
+#endif
@@ -1,4 +1,10 @@
 #include "CaveSystem.h"
+#include "AssetCache.h"
+#include "CaveNoise.h"
+#include "LevelFile.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
 
 int CaveSystem::CAVE_END_ABS_X;
 int CaveSystem::CAVE_START_ABS_X;
@@ -12,6 +18,11 @@ CaveSystem::CaveSystem()
     CAVE_END_ABS_X = -1;
     CAVE_START_ABS_X = -1;
     isEnabled = false;
+    ceilSprite = nullptr;
+    floorSprite = nullptr;
+    offsetX = -1;
+    seed = 0;
+    style = CAVE_TUNNEL;
 }
 
 std::string CaveBlock::toString()
@@ -30,13 +41,45 @@ void printMatrix(CaveBlock *mat[CaveSystem::CAVE_SYSTEM_HEIGHT][CaveSystem::CAVE
     std::cout<<std::endl;
 }
 
-CaveSystem::CaveSystem(int camX, int camY, int SCREEN_WIDTH, int difficulty)
+CaveSystem::CaveSystem(int offsetX, int difficulty, Uint32 seed, CaveStyle style) : offsetX{offsetX}, seed{seed}, style{style}
 {
+    createBlocks();
+    diff = difficulty;
+    if (style == CAVE_NOISE) {
+        generateNoiseCave();
+    }
+    else {
+        ChunkRandom random(seed);
+        generateRandomCave(random);
+    }
+    refreshBlocks(0, CAVE_SYSTEM_WIDTH - 1, 0, CAVE_SYSTEM_HEIGHT - 1);
+    nav.build(this);
+    // printMatrix(cave_system, CAVE_SYSTEM_HEIGHT, CAVE_SYSTEM_WIDTH);
+}
+
+CaveSystem::CaveSystem(const LevelCave &saved, int difficulty, CaveStyle style) : offsetX{saved.offsetX}, seed{saved.seed}, style{style}
+{
+    createBlocks();
+    diff = difficulty;
     int i, j;
-    int offsetX = camX;
+    for (i = 0; i < CAVE_SYSTEM_HEIGHT; i++)
+        for (j = 0; j < CAVE_SYSTEM_WIDTH; j++)
+            cave_system[i][j]->enabled = (saved.solid[i][j / 8] >> (j % 8)) & 1;
+    path.length = saved.pathLength;
+    if (path.length < 0 || path.length > CAVE_SYSTEM_WIDTH) {
+        path.length = 0;
+    }
+    for (i = 0; i < path.length; i++) {
+        path.x[i] = saved.pathX[i];
+        path.y[i] = saved.pathY[i];
+    }
+    refreshBlocks(0, CAVE_SYSTEM_WIDTH - 1, 0, CAVE_SYSTEM_HEIGHT - 1);
+    nav.build(this);
+}
 
-    CAVE_START_ABS_X = offsetX + SCREEN_WIDTH;
-    CAVE_END_ABS_X = offsetX + CaveBlock::CAVE_SYSTEM_PIXEL_WIDTH + SCREEN_WIDTH;
+void CaveSystem::createBlocks()
+{
+    int i, j;
 
     for (i = 0; i < CAVE_SYSTEM_HEIGHT; i++)
         for (j = 0; j < CAVE_SYSTEM_WIDTH; j++)
@@ -48,15 +91,39 @@ CaveSystem::CaveSystem(int camX, int camY, int SCREEN_WIDTH, int difficulty)
             curr_block->CAVE_BLOCK_REL_X = curr_block->CAVE_BLOCK_ABS_X;
             curr_block->CAVE_BLOCK_REL_Y = curr_block->CAVE_BLOCK_ABS_Y;
             curr_block->isPointy = 0;
+            curr_block->tile = TILE_OPEN;
             cave_system[i][j] = curr_block;
         }
 
     ceilSprite = nullptr;
     floorSprite = nullptr;
+    isEnabled = false;
+}
+
+void CaveSystem::save(LevelCave &saved)
+{
+    memset(&saved, 0, sizeof(saved));
+    saved.offsetX = offsetX;
+    saved.seed = seed;
+    int i, j;
+    for (i = 0; i < CAVE_SYSTEM_HEIGHT; i++)
+        for (j = 0; j < CAVE_SYSTEM_WIDTH; j++)
+            if (cave_system[i][j]->enabled == 1)
+                saved.solid[i][j / 8] |= 1 << (j % 8);
+    saved.pathLength = path.length;
+    for (i = 0; i < path.length; i++) {
+        saved.pathX[i] = path.x[i];
+        saved.pathY[i] = path.y[i];
+    }
+}
+
+void CaveSystem::enable()
+{
+    CAVE_START_ABS_X = offsetX + SCREEN_WIDTH;
+    CAVE_END_ABS_X = offsetX + CaveBlock::CAVE_SYSTEM_PIXEL_WIDTH + SCREEN_WIDTH;
+    ceilSprite = gAssets->acquire(ASSET_STALACTITE_1);
+    floorSprite = gAssets->acquire(ASSET_STALAGMITE_1);
     isEnabled = true;
-    diff = difficulty;
-    generateRandomCave();
-    // printMatrix(cave_system, CAVE_SYSTEM_HEIGHT, CAVE_SYSTEM_WIDTH);
 }
 
 CaveSystem::~CaveSystem()
@@ -72,6 +139,15 @@ CaveSystem::~CaveSystem()
         }
     }
     // delete[] &cave_system;
+
+    // render() destroys the cave once it scrolls off screen, so only give the sprites back once
+    if (ceilSprite != nullptr)
+    {
+        gAssets->release(ASSET_STALACTITE_1);
+        gAssets->release(ASSET_STALAGMITE_1);
+        ceilSprite = nullptr;
+        floorSprite = nullptr;
+    }
 }
 
 PathSequence* CaveSystem::getPathSequence()
@@ -79,7 +155,7 @@ PathSequence* CaveSystem::getPathSequence()
     return &path;
 }
 
-void CaveSystem::generateRandomCave()
+void CaveSystem::generateRandomCave(ChunkRandom &random)
 {
     /*
 
@@ -119,7 +195,7 @@ void CaveSystem::generateRandomCave()
             cx = path->x[i];
             cy = path->y[i];
 
-            int padding = (3 * cos(i/7) + y_padding) + rand() % 2;
+            int padding = (3 * cos(i/7) + y_padding) + random.next(2);
             for (j = (padding * -1); j < padding; j++)
             {
                
@@ -140,7 +216,7 @@ void CaveSystem::generateRandomCave()
 
     auto rnd_i0 = [&](int n) {
         /* 0 <= rnd_i0(n) < n */
-        return ((int)(rand() % n));
+        return random.next(n);
     };
 
     auto int_sign = [&](int n) {
@@ -259,7 +335,78 @@ void CaveSystem::generateRandomCave()
     bresenham_line(&path, x1, y1, x2, y2);
     uti_perturb(&path, 2, 5, 40);
 
-    insert_path(CaveSystem::cave_system, &path, rand() % 6 + 8);
+    insert_path(CaveSystem::cave_system, &path, random.next(6) + 8);
+}
+
+// Noise cave shape, all in cave blocks
+constexpr float PATH_FREQ = 0.02f;			// How quickly the main passage wanders up and down
+constexpr float PATH_SWING = 10.0f;			// and how far
+constexpr float HEIGHT_FREQ = 0.035f;		// How quickly the main passage gets taller and shorter
+constexpr float MIN_HALF_HEIGHT = 4.0f;
+constexpr float MAX_HALF_HEIGHT = 9.0f;
+constexpr float WARP_FREQ = 0.05f;			// Domain warp, so chambers and side passages aren't blobs on a grid
+constexpr float WARP_DISTANCE = 6.0f;
+constexpr float CELL_FREQ = 0.08f;			// Size of chambers and side passages
+constexpr float CHAMBER_LEVEL = 0.55f;		// Noise above this opens a chamber
+constexpr float BRANCH_WIDTH = 0.05f;		// Noise this close to zero opens a side passage; the zero line branches and winds
+
+// The noise a noise cave is carved from, each part with its own seed
+struct NoiseCaveFields
+{
+    CaveNoise path;
+    CaveNoise height;
+    CaveNoise warpX;
+    CaveNoise warpY;
+    CaveNoise chamber;
+    CaveNoise branch;
+
+    NoiseCaveFields(Uint32 seed) : path{seed ^ 0x1u}, height{seed ^ 0x2u}, warpX{seed ^ 0x3u}, warpY{seed ^ 0x4u}, chamber{seed ^ 0x5u}, branch{seed ^ 0x6u} {}
+};
+
+void CaveSystem::generateNoiseCave()
+{
+    NoiseCaveFields fields(seed);
+    for (int j = 0; j < CAVE_SYSTEM_WIDTH; j++) {
+        carveNoiseColumn(fields, j);
+    }
+    path.length = CAVE_SYSTEM_WIDTH;
+}
+
+void CaveSystem::carveNoiseColumn(NoiseCaveFields &fields, int column)
+{
+    // The main passage, kept clear of the top and bottom like the tunnel's path
+    float center = CAVE_SYSTEM_HEIGHT / 2 + PATH_SWING * fields.path.at(column * PATH_FREQ, 0.5f);
+    int pathY = std::max(3, std::min(CAVE_SYSTEM_HEIGHT - 4, (int) center));
+    float halfHeight = MIN_HALF_HEIGHT + (MAX_HALF_HEIGHT - MIN_HALF_HEIGHT) * (fields.height.at(column * HEIGHT_FREQ, 0.5f) + 1) / 2;
+    path.x[column] = column;
+    path.y[column] = pathY;
+
+    // Every row of the column at once
+    float xs[CAVE_SYSTEM_HEIGHT], ys[CAVE_SYSTEM_HEIGHT];
+    float warpX[CAVE_SYSTEM_HEIGHT], warpY[CAVE_SYSTEM_HEIGHT];
+    float chamber[CAVE_SYSTEM_HEIGHT], branch[CAVE_SYSTEM_HEIGHT];
+    int i;
+    for (i = 0; i < CAVE_SYSTEM_HEIGHT; i++) {
+        xs[i] = column * WARP_FREQ;
+        ys[i] = i * WARP_FREQ;
+    }
+    fields.warpX.sample(xs, ys, warpX, CAVE_SYSTEM_HEIGHT);
+    fields.warpY.sample(xs, ys, warpY, CAVE_SYSTEM_HEIGHT);
+    for (i = 0; i < CAVE_SYSTEM_HEIGHT; i++) {
+        xs[i] = (column + WARP_DISTANCE * warpX[i]) * CELL_FREQ;
+        ys[i] = (i + WARP_DISTANCE * warpY[i]) * CELL_FREQ;
+    }
+    fields.chamber.sample(xs, ys, chamber, CAVE_SYSTEM_HEIGHT);
+    fields.branch.sample(xs, ys, branch, CAVE_SYSTEM_HEIGHT);
+
+    for (i = 0; i < CAVE_SYSTEM_HEIGHT; i++) {
+        bool open = fabsf(i - center) < halfHeight || chamber[i] > CHAMBER_LEVEL || fabsf(branch[i]) < BRANCH_WIDTH;
+        // The top and bottom rows stay solid so the cave has a ceiling and a floor
+        if (i == 0 || i == CAVE_SYSTEM_HEIGHT - 1) {
+            open = false;
+        }
+        cave_system[i][column]->enabled = open ? 0 : 1;
+    }
 }
 
 void CaveSystem::moveCaveBlocks(int camX, int camY)
@@ -282,11 +429,119 @@ bool checkCollide(int x, int y, int pWidth, int pHeight, int xTwo, int yTwo, int
     return true;
 }
 
-void CaveSystem::checkCollision(Player *p)
+// Division rounding down and up, for positions left of or above the cave
+static int floorDiv(int a, int b)
+{
+    return a >= 0 ? a / b : -((-a + b - 1) / b);
+}
+
+static int ceilDiv(int a, int b)
+{
+    return -floorDiv(-a, b);
+}
+
+bool CaveSystem::findBlocks(int x, int y, int w, int h, int &firstColumn, int &lastColumn, int &firstRow, int &lastRow)
 {
+    // Touching counts, as in checkCollide
+    int left = x - cave_system[0][0]->CAVE_BLOCK_REL_X;
+    int top = y - cave_system[0][0]->CAVE_BLOCK_REL_Y;
+    firstColumn = std::max(0, ceilDiv(left - CaveBlock::CAVE_BLOCK_WIDTH, CaveBlock::CAVE_BLOCK_WIDTH));
+    lastColumn = std::min(CAVE_SYSTEM_WIDTH - 1, floorDiv(left + w, CaveBlock::CAVE_BLOCK_WIDTH));
+    firstRow = std::max(0, ceilDiv(top - CaveBlock::CAVE_BLOCK_HEIGHT, CaveBlock::CAVE_BLOCK_HEIGHT));
+    lastRow = std::min(CAVE_SYSTEM_HEIGHT - 1, floorDiv(top + h, CaveBlock::CAVE_BLOCK_HEIGHT));
+    return firstColumn <= lastColumn && firstRow <= lastRow;
+}
+
+bool CaveSystem::hitsWall(int x, int y, int w, int h)
+{
+    int firstColumn, lastColumn, firstRow, lastRow;
+    if (!findBlocks(x, y, w, h, firstColumn, lastColumn, firstRow, lastRow)) {
+        return false;
+    }
+    Uint64 rows = ((2ULL << lastRow) - 1) & ~((1ULL << firstRow) - 1);
+    for (int j = firstColumn; j <= lastColumn; j++) {
+        if (solidRows[j] & rows) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void CaveSystem::refreshBlocks(int firstColumn, int lastColumn, int firstRow, int lastRow)
+{
+    firstColumn = std::max(0, firstColumn);
+    lastColumn = std::min(CAVE_SYSTEM_WIDTH - 1, lastColumn);
+    firstRow = std::max(0, firstRow);
+    lastRow = std::min(CAVE_SYSTEM_HEIGHT - 1, lastRow);
     int i, j;
-    for (i = 0; i < CAVE_SYSTEM_HEIGHT; i++)
-        for (j = 0; j < CAVE_SYSTEM_WIDTH; j++)
+    for (j = firstColumn; j <= lastColumn; j++)
+        for (i = firstRow; i <= lastRow; i++)
+        {
+            CaveBlock *curr_block = cave_system[i][j];
+            if (curr_block->enabled != 1) {
+                curr_block->tile = TILE_OPEN;
+            }
+            else if (i != 0 && cave_system[i-1][j]->enabled == 0) {
+                curr_block->tile = TILE_FLOOR;
+            }
+            else if (i != CAVE_SYSTEM_HEIGHT - 1 && cave_system[i+1][j]->enabled == 0) {
+                curr_block->tile = TILE_CEILING;
+            }
+            else {
+                curr_block->tile = TILE_SOLID;
+            }
+            curr_block->isPointy = curr_block->tile == TILE_FLOOR || curr_block->tile == TILE_CEILING ? 1 : 0;
+
+            if (curr_block->enabled == 1) {
+                solidRows[j] |= 1ULL << i;
+            }
+            else {
+                solidRows[j] &= ~(1ULL << i);
+            }
+        }
+}
+
+void CaveSystem::blast(int x, int y, int radius)
+{
+    int firstColumn, lastColumn, firstRow, lastRow;
+    if (!findBlocks(x - radius, y - radius, 2 * radius, 2 * radius, firstColumn, lastColumn, firstRow, lastRow)) {
+        return;
+    }
+
+    // Knock out every block whose middle is inside the blast, keeping track of the ones that went
+    int centerX = x - cave_system[0][0]->CAVE_BLOCK_REL_X;
+    int centerY = y - cave_system[0][0]->CAVE_BLOCK_REL_Y;
+    int dirtyLeft = CAVE_SYSTEM_WIDTH, dirtyRight = -1, dirtyTop = CAVE_SYSTEM_HEIGHT, dirtyBottom = -1;
+    int i, j;
+    for (j = firstColumn; j <= lastColumn; j++)
+        for (i = firstRow; i <= lastRow; i++)
+        {
+            int dx = j * CaveBlock::CAVE_BLOCK_WIDTH + CaveBlock::CAVE_BLOCK_WIDTH / 2 - centerX;
+            int dy = i * CaveBlock::CAVE_BLOCK_HEIGHT + CaveBlock::CAVE_BLOCK_HEIGHT / 2 - centerY;
+            if (cave_system[i][j]->enabled == 1 && dx * dx + dy * dy <= radius * radius) {
+                cave_system[i][j]->enabled = 0;
+                dirtyLeft = std::min(dirtyLeft, j);
+                dirtyRight = std::max(dirtyRight, j);
+                dirtyTop = std::min(dirtyTop, i);
+                dirtyBottom = std::max(dirtyBottom, i);
+            }
+        }
+    if (dirtyRight < 0) {
+        return;
+    }
+
+    // The blocks just above and below the hole now have open space next to them too
+    refreshBlocks(dirtyLeft, dirtyRight, dirtyTop - 1, dirtyBottom + 1);
+    nav.refresh(this, dirtyLeft, dirtyRight);
+}
+
+void CaveSystem::checkCollision(Player *p)
+{
+    int i, j, firstColumn, lastColumn, firstRow, lastRow;
+    if (!findBlocks(p->getPosX() + 12, p->getPosY() + 12, p->PLAYER_HURT_WIDTH, p->PLAYER_HURT_HEIGHT, firstColumn, lastColumn, firstRow, lastRow))
+        return;
+    for (i = firstRow; i <= lastRow; i++)
+        for (j = firstColumn; j <= lastColumn; j++)
         {
             // If there's a collision, cancel the player's move
             if (cave_system[i][j]->enabled == 1 && (checkCollide(p->getPosX() + 12, p->getPosY() + 12, p->PLAYER_HURT_WIDTH, p->PLAYER_HURT_HEIGHT, cave_system[i][j]->CAVE_BLOCK_REL_X, cave_system[i][j]->CAVE_BLOCK_REL_Y, cave_system[i][j]->CAVE_BLOCK_WIDTH, cave_system[i][j]->CAVE_BLOCK_HEIGHT)))
@@ -336,9 +591,11 @@ void CaveSystem::checkCollision(Player *p)
 }
 
 void CaveSystem::checkCollision(Enemy *e){
-    int i, j;
-    for (i = 0; i < CAVE_SYSTEM_HEIGHT; i++)
-        for (j = 0; j < CAVE_SYSTEM_WIDTH; j++)
+    int i, j, firstColumn, lastColumn, firstRow, lastRow;
+    if (!findBlocks(e->getX(), e->getY(), e->getWidth(), e->getHeight(), firstColumn, lastColumn, firstRow, lastRow))
+        return;
+    for (i = firstRow; i <= lastRow; i++)
+        for (j = firstColumn; j <= lastColumn; j++)
         {
             // If there's a collision, cancel the player's move
             if (cave_system[i][j]->enabled == 1 && (checkCollide(e->getX(), e->getY(), e->getWidth(), e->getHeight(), cave_system[i][j]->CAVE_BLOCK_REL_X, cave_system[i][j]->CAVE_BLOCK_REL_Y, cave_system[i][j]->CAVE_BLOCK_WIDTH, cave_system[i][j]->CAVE_BLOCK_HEIGHT)))
@@ -349,53 +606,15 @@ void CaveSystem::checkCollision(Enemy *e){
 }
 
 bool CaveSystem::checkCollision(Bullet *b){
-    int i, j;
-    for (i = 0; i < CAVE_SYSTEM_HEIGHT; i++)
-	{
-        for (j = 0; j < CAVE_SYSTEM_WIDTH; j++)
-        {
-            // If there's a collision, cancel the player's move
-            if (cave_system[i][j]->enabled == 1 && (checkCollide(b->getX(), b->getY(), b->getWidth(), b->getHeight(), cave_system[i][j]->CAVE_BLOCK_REL_X, cave_system[i][j]->CAVE_BLOCK_REL_Y, cave_system[i][j]->CAVE_BLOCK_WIDTH, cave_system[i][j]->CAVE_BLOCK_HEIGHT)))
-            {
-                return true;
-            }
-        }
-	}
-	return false;
+    return hitsWall(b->getX(), b->getY(), b->getWidth(), b->getHeight());
 }
 
 bool CaveSystem::checkCollision(Missile *m){
-    int i, j;
-    for (i = 0; i < CAVE_SYSTEM_HEIGHT; i++)
-	{
-        for (j = 0; j < CAVE_SYSTEM_WIDTH; j++)
-        {
-            // If there's a collision, cancel the player's move
-            if (cave_system[i][j]->enabled == 1 && (checkCollide(m->getX(), m->getY(), m->getWidth(), m->getHeight(), cave_system[i][j]->CAVE_BLOCK_REL_X, cave_system[i][j]->CAVE_BLOCK_REL_Y, cave_system[i][j]->CAVE_BLOCK_WIDTH, cave_system[i][j]->CAVE_BLOCK_HEIGHT)))
-            {
-                return true;
-            }
-        }
-	}
-	return false;
+    return hitsWall(m->getX(), m->getY(), m->getWidth(), m->getHeight());
 }
 
-void CaveSystem::render(int SCREEN_WIDTH, int SCREEN_HEIGHT, SDL_Renderer *gRenderer)
+void CaveSystem::render(int SCREEN_WIDTH, int SCREEN_HEIGHT, RenderSnapshot *frame)
 {
-    if(ceilSprite == nullptr){
-        SDL_Texture* newText = nullptr;
-        std::string fname = "sprites/stalagt1.png";
-	    SDL_Surface* startSurf = IMG_Load(fname.c_str());
-	    newText = SDL_CreateTextureFromSurface(gRenderer, startSurf);
-	    SDL_FreeSurface(startSurf);
-        ceilSprite = newText;
-        newText = nullptr;
-        fname = "sprites/stalagm1.png";
-	    startSurf = IMG_Load(fname.c_str());
-	    newText = SDL_CreateTextureFromSurface(gRenderer, startSurf);
-	    SDL_FreeSurface(startSurf);
-        floorSprite = newText;
-    }
     int i, j;
     bool isStillShowing = false;
     for (i = 0; i < CAVE_SYSTEM_HEIGHT; i++)
@@ -406,17 +625,15 @@ void CaveSystem::render(int SCREEN_WIDTH, int SCREEN_HEIGHT, SDL_Renderer *gRend
             if (curr_block->CAVE_BLOCK_REL_X < SCREEN_WIDTH && curr_block->CAVE_BLOCK_REL_Y < SCREEN_HEIGHT && curr_block->enabled == 1)
             {
                 SDL_Rect fillRect = {curr_block->CAVE_BLOCK_REL_X, curr_block->CAVE_BLOCK_REL_Y, CaveBlock::CAVE_BLOCK_WIDTH, CaveBlock::CAVE_BLOCK_HEIGHT};
-                if(i != 0 && CaveSystem::cave_system[i-1][j]->enabled == 0){
-                    curr_block->isPointy = 1;
-                    SDL_RenderCopyEx(gRenderer, floorSprite, nullptr, &fillRect, 0.0, nullptr, SDL_FLIP_NONE);
+                if(curr_block->tile == TILE_FLOOR){
+                    frame->copy(floorSprite, &fillRect);
                 }
-                else if(i != CaveSystem::CAVE_SYSTEM_HEIGHT - 1 && CaveSystem::cave_system[i+1][j]->enabled == 0){
-                    curr_block->isPointy = 1;
-                    SDL_RenderCopyEx(gRenderer, ceilSprite, nullptr, &fillRect, 0.0, nullptr, SDL_FLIP_NONE);
+                else if(curr_block->tile == TILE_CEILING){
+                    frame->copy(ceilSprite, &fillRect);
                 }
                 else{
-                SDL_SetRenderDrawColor(gRenderer, 0x7F, 0x33, 0x00, 0xFF);
-                SDL_RenderFillRect(gRenderer, &fillRect);
+                frame->setDrawColor(0x7F, 0x33, 0x00, 0xFF);
+                frame->fillRect(fillRect);
                 }   
             }
 
@@ -8,6 +8,20 @@
 #include "Player.h"
 #include "Enemy.h"
 #include "missile.h"
+#include "RenderSnapshot.h"
+#include "Screen.h"
+#include "PlacementSampler.h"
+#include "CaveNavField.h"
+
+// How a cave block is drawn. Solid blocks with open space above or below get the stalag sprites,
+// and are the pointy ones.
+enum CaveTile
+{
+	TILE_OPEN,
+	TILE_SOLID,
+	TILE_FLOOR,
+	TILE_CEILING
+};
 
 class CaveBlock
 {
@@ -22,10 +36,11 @@ public:
 
     int enabled; // Is the cave block going to be visible? 1 = yes, 0 = no
     int isPointy; //Pointy blocks only deal quarty damage to player and enemy
+    int tile; // What the block is drawn as, kept up to date as the cave gets blown apart
 
     static const int CAVE_BLOCK_HEIGHT = 20;
     static const int CAVE_BLOCK_WIDTH = 20;
-	static const int CAVE_SYSTEM_PIXEL_HEIGHT = 720;
+	static const int CAVE_SYSTEM_PIXEL_HEIGHT = SCREEN_HEIGHT;
 	static const int CAVE_SYSTEM_PIXEL_WIDTH = 4000;
     CaveBlock();
     std::string toString();
@@ -43,6 +58,19 @@ public:
 };
 
 
+// How a cave's passages are laid out
+enum CaveStyle
+{
+	// One winding tunnel along a perturbed line
+	CAVE_TUNNEL,
+	// Carved out of noise: a main passage that changes height, with side passages that branch off
+	// it and chambers along the way
+	CAVE_NOISE
+};
+
+struct NoiseCaveFields;
+struct LevelCave;
+
 class CaveSystem
 {
 public:
@@ -55,19 +83,39 @@ public:
 
     bool isEnabled = false;
     PathSequence path;
+    // Where the AI can fly, built along with the cave
+    CaveNavField nav;
     CaveBlock *cave_system[CAVE_SYSTEM_HEIGHT][CAVE_SYSTEM_WIDTH];
+    // Where the cave was made for and from what, so a cave made ahead of time can be matched up
+    int offsetX;
+    Uint32 seed;
+    CaveStyle style;
 
     CaveSystem();
-    CaveSystem(int camX, int camY, int SCREEN_WIDTH, int difficulty);
+    // Generates the cave that starts a screen past offsetX. Only touches the cave itself, so it can
+    // run on another thread; call enable() on the main thread to put it in the level.
+    CaveSystem(int offsetX, int difficulty, Uint32 seed, CaveStyle style = CAVE_TUNNEL);
+    // A cave from a saved level. Like a generated one, call enable() to put it in the level.
+    CaveSystem(const LevelCave &saved, int difficulty, CaveStyle style);
     ~CaveSystem();
 
+    void enable();
+    // Copies the blocks and path out for a level file
+    void save(LevelCave &saved);
+
+    // Blows away the blocks within radius of (x, y), relative to the camera like the collision checks.
+    // Only the blocks around the hole get redrawn, collided with and navigated differently.
+    void blast(int x, int y, int radius);
+
     void render(SDL_Renderer *gRenderer);
     void moveCaveBlocks(int camX, int camY);
     void checkCollision(Player *p);
     void checkCollision(Enemy *e);
 	bool checkCollision(Bullet *b);
 	bool checkCollision(Missile *m);
-    void render(int SCREEN_WIDTH, int SCREEN_HEIGHT, SDL_Renderer *gRenderer);
+    // Whether a box on screen overlaps a solid block
+    bool hitsWall(int x, int y, int w, int h);
+    void render(int SCREEN_WIDTH, int SCREEN_HEIGHT, RenderSnapshot *frame);
     PathSequence* getPathSequence();
 	int getStartX();
 	int getEndX();
@@ -76,7 +124,21 @@ public:
     SDL_Texture* floorSprite;
     int diff;
 private:
-    void generateRandomCave();
+    // A bit per row for each column, set where the block is solid, so checking something against
+    // the cave only tests the columns it overlaps
+    Uint64 solidRows[CAVE_SYSTEM_WIDTH];
+    static_assert(CAVE_SYSTEM_HEIGHT <= 64, "A column's rows have to fit in solidRows");
+
+    // Works out the tiles and collision mask of a rectangle of blocks again
+    void refreshBlocks(int firstColumn, int lastColumn, int firstRow, int lastRow);
+    // The blocks a rectangle on screen touches; false if it misses the cave
+    bool findBlocks(int x, int y, int w, int h, int &firstColumn, int &lastColumn, int &firstRow, int &lastRow);
+
+    void createBlocks();
+    void generateRandomCave(ChunkRandom &random);
+    void generateNoiseCave();
+    // Works out one column of a noise cave, path included, from nothing but the seed and the column
+    void carveNoiseColumn(NoiseCaveFields &fields, int column);
 };
 
 
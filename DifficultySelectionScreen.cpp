@@ -1,4 +1,5 @@
 #include "DifficultySelectionScreen.h"
+#include "Screen.h"
 #include <SDL.h>
 #include <SDL_image.h>
 
@@ -51,7 +52,7 @@ int DifficultySelectionScreen::handleEvent(SDL_Event&e)
 
 void DifficultySelectionScreen::render(SDL_Renderer *gRenderer)
 {
-	SDL_Rect bgRect = {0,0, 1280, 720};
+	SDL_Rect bgRect = {0,0, SCREEN_WIDTH, SCREEN_HEIGHT};
 	SDL_RenderCopy(gRenderer, gBackground, nullptr, &bgRect);
 
 	SDL_Rect fillRectButton = {EASY_BUTTON_X, EASY_BUTTON_Y, EASY_BUTTON_WIDTH, EASY_BUTTON_HEIGHT};
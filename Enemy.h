@@ -7,27 +7,54 @@
 #include <SDL.h>
 #include <SDL_image.h>
 #include "bullet.h"
+#include "RenderSnapshot.h"
+#include "Animation.h"
 #include <vector>
 using std::vector;
+
+struct EnemyPerception;
+
 class Enemy
 {
 
     public:
 
-		SDL_Texture* loadImage(std::string fname, SDL_Renderer *gRenderer);
+		// How long a destroyed enemy stays down
+		static const int SPAWN_FREQ = 3000;
+
+		// Limits on where the enemy can go
+		static const int MIN_X = 0;
+		static const int MAX_X = 500;
+		static const int MIN_Y = 110;
+		static const int MAX_Y = 610;
+
+		// Variables for squares and their corresponding risk scores
+		static const int SQUARE_WIDTH = 100;
+		static const int NUM_HORIZONTAL_SQUARES = (MAX_X - MIN_X) / SQUARE_WIDTH;
+		static const int NUM_VERTICAL_SQUARES = (MAX_Y - MIN_Y) / SQUARE_WIDTH;
 
         //Initializes the variables, Constructor
         Enemy(int x, int y, int w, int h, int xvel, int yvel, int diff, SDL_Renderer *gRenderer);
 		~Enemy();
 
         //Shows the enemy
-        void renderEnemy(SDL_Renderer* gRenderer);
-
-        //Moves the enemy
-        void move(int playerX, int playerY, std::vector<int> bulletX, std::vector<int> bulletY, std::vector<int> bulletVelX, std::vector<int> bulletVelY, std::vector<int> stalagmX, std::vector<int> stalagmH, std::vector<int> stalagtX, std::vector<int> stalagtH, std::vector<int> turretX, std::vector<int> turretH, std::vector<int> turretBottom, int kamiX, int kamiY, int cave_y);
+        void renderEnemy(RenderSnapshot* frame);
+
+        //Picks the direction to fly from the risk scores. Only touches this enemy, like move().
+        void think(const EnemyPerception &seen);
+        // Whether the enemy has moved into another square since it last thought
+        bool needsThink();
+        // In the player's line of fire, or just hit
+        bool isThreatened(const EnemyPerception &seen);
+        //Moves the enemy the way it last chose. Only touches this enemy, so the squadron runs it for every enemy at once.
+        void move(const EnemyPerception &seen, int cave_y, int cave_slack);
         bool checkCollide(int x, int y, int pWidth, int pHeight, int xTwo, int yTwo, int pTwoWidth, int pTwoHeight);
         bool checkCollision(int x, int y, int w, int h);
         void hit(int d);
+		// Brings the enemy back at x, y. The seed drives its choices between equally safe directions.
+		void spawn(int x, int y, int h, Uint32 seed);
+		bool isDestroyed();
+		int getTimeDestroyed();
 
         //Position, dimensions, and velocity accessors
         int getX();
@@ -35,6 +62,8 @@ class Enemy
 		int getWidth();
 		int getHeight();
         int getHealth();
+        // Which anchor the render thread interpolates this enemy from; new each time it spawns
+        Uint32 getEntityId();
         void setyVelo(int y);
         void setxVelo(int x);
 		void setPosX(int x);
@@ -49,31 +78,24 @@ class Enemy
         SDL_Rect* getHitbox();
         Bullet* handleFiring();
 		int chooseDirection();
-		void calculateRiskscores(int playerX, int playerY, std::vector<int> bulletX, std::vector<int> bulletY, std::vector<int> bulletVelX, std::vector<int> bulletVelY, int kamiX, int kamiY, std::vector<int> stalagmX, std::vector<int> stalagmH, std::vector<int> stalagtX, std::vector<int> stalagtH, std::vector<int> turretX, std::vector<int> turretH, std::vector<int> turretBottom);
+		// Fills in the risk every enemy shares: hazards, the kamikaze, the screen edges and the player
+		static void calculateRiskscores(EnemyPerception &seen, const std::vector<int> &stalagmX, const std::vector<int> &stalagmH, const std::vector<int> &stalagtX, const std::vector<int> &stalagtH, const std::vector<int> &turretX, const std::vector<int> &turretH, const std::vector<int> &turretBottom);
+		// Adds the bullets heading towards this enemy to the shared risk
+		void calculateBulletRisk(const EnemyPerception &seen);
 
-		// Sprites for the enemy
-		SDL_Texture* sprite1;
-		SDL_Texture* sprite2;
+		// Flying normally, or flickering after being hit
+		AnimationState animation;
 
     private:
 
-		// Animation and shooting frequencies of the enemy
-		static const int ANIMATION_FREQ = 100;
+		// Shooting frequency of the enemy
 		static const int FIRING_FREQ = 1000;
-    static const int FLICKER_FREQ = 50;
     static const int FLICKER_TIME = 500;
-    static const int SPAWN_FREQ = 3000;
+		// How far above or below the player an enemy counts as in its line of fire
+		static const int THREAT_LANE = 100;
+		// How much riskier the current direction can be than the safest before the enemy turns
+		static const int DIRECTION_HYSTERESIS = 30;
 
-		// Limits on where the enemy can go
-		static const int MIN_X = 0;
-		static const int MAX_X = 500;
-		static const int MIN_Y = 110;
-		static const int MAX_Y = 610;
-
-		// Variables for squares and their corresponding risk scores
-		static const int SQUARE_WIDTH = 100;
-		static const int NUM_HORIZONTAL_SQUARES = (MAX_X - MIN_X) / SQUARE_WIDTH;
-		static const int NUM_VERTICAL_SQUARES = (MAX_Y - MIN_Y) / SQUARE_WIDTH;
 		double riskScores[NUM_HORIZONTAL_SQUARES][NUM_VERTICAL_SQUARES];
 
         //Position and size of the enemy sprite on screen
@@ -84,6 +106,12 @@ class Enemy
         const int width;
         const int height;
 		int prev_direction;
+		// Square the enemy was in when it last thought
+		int thought_x_square;
+		int thought_y_square;
+		// Breaks ties between directions. Each enemy has its own so they can decide in parallel.
+		Uint32 rng;
+		Uint32 entityId;
 
         //Velocity of the enemy
 		int maxXVelo;
@@ -110,6 +138,20 @@ class Enemy
     int time_destroyed;
     int health;
     bool is_destroyed;
+
+		int nextRandom();
+};
+
+// What every enemy sees this tick. Gathered once on the simulation thread and shared by the squadron.
+struct EnemyPerception
+{
+	Uint32 ticks;
+	int playerX, playerY;
+	std::vector<int> kamiX, kamiY;
+	// Bullets and missiles in flight
+	std::vector<int> bulletX, bulletY, bulletVelX, bulletVelY;
+	// Risk from everything but bullets, which are only a threat to the enemies they are heading towards
+	double riskScores[Enemy::NUM_HORIZONTAL_SQUARES][Enemy::NUM_VERTICAL_SQUARES];
 };
 
 #endif
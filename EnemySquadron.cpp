@@ -0,0 +1,267 @@
+#include "EnemySquadron.h"
+#include <algorithm>
+#include <cmath>
+#include <stdlib.h>
+#include "Player.h"
+#include "KamikazeSwarm.h"
+#include "missile.h"
+#include "MapBlocks.h"
+#include "CaveSystem.h"
+#include "GameClock.h"
+#include "Screen.h"
+#include "JobSystem.h"
+
+EnemySquadron::EnemySquadron(int difficulty, SDL_Renderer *gRenderer) :
+	scheduler{MAX_FIGHTERS}
+{
+	waves = difficulty == 3;
+	int count = waves ? MAX_FIGHTERS : 1;
+	fighters.reserve(count);
+	for (int i = 0; i < count; i++) {
+		//start enemy on left side behind player
+		fighters.emplace_back(100, SCREEN_HEIGHT/2, 125, 53, 200, 200, difficulty, gRenderer);
+	}
+
+	if (waves) {
+		waveSize = HARD_WAVE_SIZE;
+		nextWaveSize = HARD_WAVE_SIZE;
+		spawnWave();
+	}
+	else {
+		waveSize = 1;
+		nextWaveSize = 1;
+		fighters[0].spawn(fighters[0].getX(), fighters[0].getY(), fighters[0].getHealth(), rand());
+		scheduler.reset(0);
+	}
+}
+
+void EnemySquadron::update(Player* player, KamikazeSwarm* kamikazes, const std::vector<Bullet*> &bullets, const std::vector<Missile*> &missiles, MapBlocks* blocks, CaveSystem* cave, double camX)
+{
+	Uint32 now = GameClock::getTicks();
+	if (waves) {
+		// The next wave comes once the last fighter of this one has been down long enough
+		bool wave_down = true;
+		int last_destroyed = 0;
+		for (int i = 0; i < waveSize && wave_down; i++) {
+			wave_down = fighters[i].isDestroyed();
+			last_destroyed = std::max(last_destroyed, fighters[i].getTimeDestroyed());
+		}
+		if (wave_down && now - last_destroyed >= Enemy::SPAWN_FREQ) {
+			waveSize = nextWaveSize;
+			spawnWave();
+		}
+	}
+	else if (fighters[0].isDestroyed() && now - fighters[0].getTimeDestroyed() >= Enemy::SPAWN_FREQ) {
+		// Comes back where it went down
+		fighters[0].spawn(fighters[0].getX(), fighters[0].getY(), RESPAWN_HEALTH, rand());
+		scheduler.reset(0);
+	}
+
+	perceive(player, kamikazes, bullets, missiles, blocks, camX);
+	planThinking(now);
+	MoveJob job = {this, cave, (int) camX};
+	gJobs->parallelFor(waveSize, moveFighter, &job);
+	Uint64 think_time = 0;
+	for (int i = 0; i < waveSize; i++) {
+		think_time += thinkTime[i];
+	}
+	scheduler.endTick(now, think_time);
+}
+
+void EnemySquadron::handleFiring(std::vector<Bullet*> &bullets)
+{
+	for (int i = 0; i < waveSize; i++) {
+		Bullet* newBullet = fighters[i].handleFiring();
+		if (newBullet != nullptr) {
+			bullets.push_back(newBullet);
+		}
+	}
+}
+
+void EnemySquadron::checkCollision(MapBlocks* blocks)
+{
+	for (int i = 0; i < waveSize; i++) {
+		if (!fighters[i].isDestroyed()) {
+			blocks->checkCollision(&fighters[i]);
+		}
+	}
+}
+
+int EnemySquadron::findHit(int x, int y, int w, int h)
+{
+	for (int i = 0; i < waveSize; i++) {
+		if (fighters[i].checkCollision(x, y, w, h)) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+void EnemySquadron::render(RenderSnapshot* frame)
+{
+	for (int i = 0; i < waveSize; i++) {
+		frame->beginEntity(fighters[i].getEntityId());
+		fighters[i].renderEnemy(frame);
+		frame->endEntity();
+	}
+}
+
+int EnemySquadron::size()
+{
+	return waveSize;
+}
+
+Enemy& EnemySquadron::get(int i)
+{
+	return fighters[i];
+}
+
+// Everything here is the same for every fighter, so it is only worked out once a tick
+void EnemySquadron::perceive(Player* player, KamikazeSwarm* kamikazes, const std::vector<Bullet*> &bullets, const std::vector<Missile*> &missiles, MapBlocks* blocks, double camX)
+{
+	seen.ticks = GameClock::getTicks();
+	seen.playerX = player->getPosX() + player->PLAYER_WIDTH/2;
+	seen.playerY = player->getPosY() + player->PLAYER_HEIGHT/2;
+	seen.kamiX.clear();
+	seen.kamiY.clear();
+	for (int i = 0; i < kamikazes->size(); i++) {
+		seen.kamiX.push_back(kamikazes->getX(i));
+		seen.kamiY.push_back(kamikazes->getY(i));
+	}
+
+	seen.bulletX.clear();
+	seen.bulletY.clear();
+	seen.bulletVelX.clear();
+	seen.bulletVelY.clear();
+	for (int i = 0; i < bullets.size(); i++) {
+		seen.bulletX.push_back(bullets[i]->getX());
+		seen.bulletY.push_back(bullets[i]->getY());
+		seen.bulletVelX.push_back(bullets[i]->getXVel());
+		seen.bulletVelY.push_back(bullets[i]->getYVel());
+	}
+	// For now, just have the AI treat missiles as bullets
+	for (int i = 0; i < missiles.size(); i++) {
+		seen.bulletX.push_back(missiles[i]->getX());
+		seen.bulletY.push_back(missiles[i]->getY());
+		seen.bulletVelX.push_back(missiles[i]->getXVel());
+		seen.bulletVelY.push_back(missiles[i]->getYVel());
+	}
+
+	std::vector<int> stalagmX;
+	std::vector<int> stalagmH;
+	std::vector<int> stalagtX;
+	std::vector<int> stalagtH;
+	std::vector<int> turretX;
+	std::vector<int> turretBottom;
+	std::vector<int> turretH;
+	const std::vector<Stalagmite> &stalagmites = blocks->getStalagmites();
+	const std::vector<Stalagtite> &stalagtites = blocks->getStalagtites();
+	const std::vector<Turret> &turrets = blocks->getTurrets();
+	for (int i = 0; i < stalagmites.size(); i++) {
+		if (stalagmites[i].STALAG_ABS_X - camX > 0 && stalagmites[i].STALAG_ABS_X - camX < SCREEN_WIDTH) {
+			stalagmX.push_back(stalagmites[i].STALAG_ABS_X - camX);
+			stalagmH.push_back(stalagmites[i].STALAG_HEIGHT + WallBlock::block_side);
+		}
+	}
+	for (int i = 0; i < stalagtites.size(); i++) {
+		if (stalagtites[i].STALAG_ABS_X - camX > 0 && stalagtites[i].STALAG_ABS_X - camX < SCREEN_WIDTH) {
+			stalagtX.push_back(stalagtites[i].STALAG_ABS_X - camX);
+			stalagtH.push_back(stalagtites[i].STALAG_HEIGHT + WallBlock::block_side);
+		}
+	}
+	for (int i = 0; i < turrets.size(); i++) {
+		if (turrets[i].BLOCK_ABS_X - camX > 0 && turrets[i].BLOCK_ABS_X - camX < SCREEN_WIDTH) {
+			turretX.push_back(turrets[i].BLOCK_ABS_X - camX);
+			turretBottom.push_back(turrets[i].bottom);
+			turretH.push_back(turrets[i].BLOCK_HEIGHT + WallBlock::block_side);
+		}
+	}
+	Enemy::calculateRiskscores(seen, stalagmX, stalagmH, stalagtX, stalagtH, turretX, turretH, turretBottom);
+}
+
+// Fighters near the player or in its line of fire think more often than the rest
+void EnemySquadron::planThinking(Uint32 now)
+{
+	int cost = THINK_COST_NS + THINK_COST_PER_BULLET_NS * seen.bulletX.size();
+	for (int i = 0; i < waveSize; i++) {
+		Enemy &fighter = fighters[i];
+		live[i] = !fighter.isDestroyed();
+		if (!live[i]) {
+			continue;
+		}
+		double dx = fighter.getX() + fighter.getWidth() / 2 - seen.playerX;
+		double dy = fighter.getY() + fighter.getHeight() / 2 - seen.playerY;
+		distance[i] = (int) sqrt(dx * dx + dy * dy);
+		urgent[i] = fighter.isThreatened(seen) || fighter.needsThink();
+	}
+	scheduler.schedule(now, waveSize, live, distance, urgent, cost, thinking);
+}
+
+void EnemySquadron::spawnWave()
+{
+	for (int i = 0; i < waveSize; i++) {
+		int x, y;
+		spawnPoint(i, x, y);
+		fighters[i].spawn(x, y, RESPAWN_HEALTH, rand());
+		scheduler.reset(i);
+	}
+	nextWaveSize = std::min(MAX_FIGHTERS, waveSize + WAVE_GROWTH);
+}
+
+// Spreads a wave over the area the fighters fly in, four to a row
+void EnemySquadron::spawnPoint(int i, int &x, int &y)
+{
+	Enemy &fighter = fighters[i];
+	int rows = (waveSize + 3) / 4;
+	x = Enemy::MIN_X + (i % 4) * (Enemy::MAX_X - Enemy::MIN_X - fighter.getWidth()) / 3;
+	y = Enemy::MIN_Y;
+	if (rows > 1) {
+		y += (i / 4) * (Enemy::MAX_Y - Enemy::MIN_Y - fighter.getHeight()) / (rows - 1);
+	}
+}
+
+// Runs on the job system. Reads the shared perception and the cave's navigation field, writes only fighter i.
+// Fighters only think out in the open; in a cave they follow the navigation field.
+void EnemySquadron::moveFighter(int i, void* data)
+{
+	MoveJob* job = (MoveJob*) data;
+	Enemy &en = job->squadron->fighters[i];
+	job->squadron->thinkTime[i] = 0;
+	if (en.isDestroyed()) {
+		return;
+	}
+
+	int cave_y = -1;				// Height to fly at through the cave. -1 if there is no relevant cave
+	int cave_slack = 0;				// How far the enemy can stray from cave_y before getting near a wall
+	CaveSystem* cave = job->cave;
+	if (cave->isEnabled)
+	{
+		int abs_enemy_x = en.getX() + en.getWidth() / 2 + job->camX;
+		// Absolute start and end coordinates of the cave
+		int startX = cave->getStartX();
+		int endX = cave->getEndX();
+		// Where in the cave to look: under the enemy's nose, or the first column while it is on the way in
+		int cave_x = -1;
+		if (abs_enemy_x > startX && abs_enemy_x < endX)
+		{
+			cave_x = abs_enemy_x + en.getWidth() / 2 - startX;
+		}
+		else if (abs_enemy_x < startX && abs_enemy_x + 400 > startX)
+		{
+			cave_x = 0;
+		}
+		if (cave_x >= 0)
+		{
+			cave_y = cave->nav.getSafeY(cave_x);
+			// Clearance is measured between block centres
+			cave_slack = std::max(0, cave->nav.getClearance(cave_x, cave_y) - CaveBlock::CAVE_BLOCK_HEIGHT / 2 - en.getHeight() / 2);
+		}
+	}
+	if (cave_y == -1 && job->squadron->thinking[i]) {
+		// Only the thinking counts against the AI budget, not the moving
+		Uint64 start = SDL_GetPerformanceCounter();
+		en.think(job->squadron->seen);
+		job->squadron->thinkTime[i] = SDL_GetPerformanceCounter() - start;
+	}
+	en.move(job->squadron->seen, cave_y, cave_slack);
+}
@@ -0,0 +1,84 @@
+#ifndef EnemySquadron_H
+#define EnemySquadron_H
+
+#include <SDL.h>
+#include <vector>
+#include "Enemy.h"
+#include "AIScheduler.h"
+
+class Player;
+class KamikazeSwarm;
+class Missile;
+class MapBlocks;
+class CaveSystem;
+
+// Every enemy fighter in play, kept side by side in one array. Each tick the squadron gathers what
+// the fighters can see and the risk everyone shares once, then moves every fighter on the job system.
+// Picking a direction is the expensive part, so only the fighters the AI scheduler picks rethink on a
+// given tick; the rest keep flying the way they chose last. Firing, collisions and damage stay on the
+// simulation thread.
+//
+// Easy and normal fly a single fighter that comes back a few seconds after going down. Hard sends
+// waves, starting at HARD_WAVE_SIZE and growing each time a whole wave is shot down.
+class EnemySquadron
+{
+public:
+	static const int MAX_FIGHTERS = 32;
+	static const int HARD_WAVE_SIZE = 20;
+	static const int WAVE_GROWTH = 2;
+	// Health of a fighter that comes back
+	static const int RESPAWN_HEALTH = 20;
+	// Estimated cost of a fighter thinking, measured at -O0: a base plus a bit for every bullet it weighs up
+	static const int THINK_COST_NS = 600;
+	static const int THINK_COST_PER_BULLET_NS = 35;
+
+	EnemySquadron(int difficulty, SDL_Renderer *gRenderer);
+
+	// Brings back whoever is due, then moves every fighter. camX places the fighters in the cave.
+	void update(Player* player, KamikazeSwarm* kamikazes, const std::vector<Bullet*> &bullets, const std::vector<Missile*> &missiles, MapBlocks* blocks, CaveSystem* cave, double camX);
+	// Adds the shots of every fighter ready to fire
+	void handleFiring(std::vector<Bullet*> &bullets);
+	// Runs each live fighter into the walls and hazards
+	void checkCollision(MapBlocks* blocks);
+	// The first live fighter overlapping the box, or -1
+	int findHit(int x, int y, int w, int h);
+
+	void render(RenderSnapshot* frame);
+
+	int size();
+	Enemy& get(int i);
+
+private:
+	struct MoveJob
+	{
+		EnemySquadron* squadron;
+		CaveSystem* cave;
+		int camX;
+	};
+
+	// Reserved up front and never grown past MAX_FIGHTERS, so fighters are never moved or copied
+	std::vector<Enemy> fighters;
+	// Fighters in the current wave; the rest of the array sits out
+	int waveSize;
+	int nextWaveSize;
+	bool waves;
+	EnemyPerception seen;
+	AIScheduler scheduler;
+	// Per fighter, for the scheduler
+	bool live[MAX_FIGHTERS];
+	int distance[MAX_FIGHTERS];
+	bool urgent[MAX_FIGHTERS];
+	// How long each fighter spent thinking this tick, in performance counter units
+	Uint64 thinkTime[MAX_FIGHTERS];
+	// Whether each fighter thinks this tick
+	std::vector<char> thinking;
+
+	void perceive(Player* player, KamikazeSwarm* kamikazes, const std::vector<Bullet*> &bullets, const std::vector<Missile*> &missiles, MapBlocks* blocks, double camX);
+	void planThinking(Uint32 now);
+	void spawnWave();
+	void spawnPoint(int i, int &x, int &y);
+
+	static void moveFighter(int i, void* data);
+};
+
+#endif
@@ -0,0 +1,78 @@
+#include "FramePacer.h"
+#include <iostream>
+
+FramePacer::FramePacer(int targetFPS, bool spin)
+{
+	this->spin = spin;
+	nextFrame = 0;
+	setTargetFPS(targetFPS);
+}
+
+void FramePacer::setTargetFPS(int targetFPS)
+{
+	this->targetFPS = targetFPS;
+	frameLength = targetFPS > 0 ? SDL_GetPerformanceFrequency() / targetFPS : 0;
+	nextFrame = 0;
+}
+
+int FramePacer::getTargetFPS()
+{
+	return targetFPS;
+}
+
+int FramePacer::getFrameMS()
+{
+	return targetFPS > 0 ? (1000 + targetFPS - 1) / targetFPS : 0;
+}
+
+void FramePacer::wait()
+{
+	if (frameLength == 0) {
+		return;
+	}
+
+	Uint64 now = SDL_GetPerformanceCounter();
+	// First frame, or more than a frame behind: start counting from now instead of catching up
+	if (nextFrame == 0 || now >= nextFrame + frameLength) {
+		nextFrame = now + frameLength;
+		return;
+	}
+
+	Uint64 frequency = SDL_GetPerformanceFrequency();
+	if (!spin) {
+		// Waking up to a millisecond early or late is fine, since the next deadline doesn't move
+		SDL_Delay((Uint32) ((nextFrame - now) * 1000 / frequency));
+		nextFrame += frameLength;
+		return;
+	}
+	Uint64 margin = frequency * SPIN_MARGIN_MS / 1000;
+	if (nextFrame > now + margin) {
+		SDL_Delay((Uint32) ((nextFrame - now - margin) * 1000 / frequency));
+	}
+	while (SDL_GetPerformanceCounter() < nextFrame) {}
+
+	nextFrame += frameLength;
+}
+
+Uint32 FramePacer::getRendererFlags(VSyncMode mode)
+{
+	// Accelerated isn't asked for, so SDL can still pick the software renderer when there's no GPU
+	if (mode == VSYNC_OFF) {
+		return 0;
+	}
+	return SDL_RENDERER_PRESENTVSYNC;
+}
+
+void FramePacer::applyVSync(SDL_Renderer *gRenderer, VSyncMode mode)
+{
+	if (mode != VSYNC_ADAPTIVE) {
+		return;
+	}
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+	if (SDL_RenderSetVSync(gRenderer, -1) != 0) {
+		std::cout << "Adaptive vsync not supported, using regular vsync. SDL Error: " << SDL_GetError() << std::endl;
+	}
+#else
+	std::cout << "Adaptive vsync needs SDL 2.0.18, using regular vsync" << std::endl;
+#endif
+}
@@ -0,0 +1,49 @@
+#ifndef FramePacer_H
+#define FramePacer_H
+
+#include <SDL.h>
+
+enum VSyncMode
+{
+	VSYNC_OFF,
+	VSYNC_ON,
+	// Syncs when the game keeps up with the display and tears instead of stuttering when it doesn't
+	VSYNC_ADAPTIVE
+};
+
+// Keeps a loop to a target rate. wait() sleeps most of the remaining frame with SDL_Delay and spins
+// on the performance counter for the last couple of milliseconds, since SDL_Delay can oversleep by a
+// whole scheduler tick. Loops that don't put anything on screen can be paced by sleeping alone,
+// which costs a little jitter but no CPU.
+class FramePacer
+{
+public:
+	static const int DEFAULT_TARGET_FPS = 60;
+	// How close to the deadline wait() stops sleeping and starts spinning
+	static const int SPIN_MARGIN_MS = 2;
+
+	// A target of 0 leaves the loop uncapped (vsync can still pace it). Without spin, wait() only sleeps.
+	FramePacer(int targetFPS = DEFAULT_TARGET_FPS, bool spin = true);
+
+	void setTargetFPS(int targetFPS);
+	int getTargetFPS();
+	// Length of one frame in milliseconds, rounded up; 0 when uncapped
+	int getFrameMS();
+
+	// Call once per frame. Returns straight away if the frame already ran long, and doesn't try to
+	// make up for frames that were missed.
+	void wait();
+
+	// Renderer flags to create the renderer with for the given mode
+	static Uint32 getRendererFlags(VSyncMode mode);
+	// Finishes setting up a mode that can't be requested through the creation flags
+	static void applyVSync(SDL_Renderer *gRenderer, VSyncMode mode);
+
+private:
+	int targetFPS;
+	Uint64 frameLength;		// In performance counter ticks
+	Uint64 nextFrame;
+	bool spin;
+};
+
+#endif
@@ -0,0 +1,50 @@
+#include "GameClock.h"
+
+bool GameClock::manual = false;
+Uint32 GameClock::manualTicks = 0;
+bool GameClock::paused = false;
+Uint32 GameClock::pausedAt = 0;
+Uint32 GameClock::pausedTotal = 0;
+
+Uint32 GameClock::getTicks()
+{
+	if (manual) {
+		return manualTicks;
+	}
+	if (paused) {
+		return pausedAt - pausedTotal;
+	}
+	return SDL_GetTicks() - pausedTotal;
+}
+
+void GameClock::pause()
+{
+	if (!paused) {
+		pausedAt = SDL_GetTicks();
+		paused = true;
+	}
+}
+
+void GameClock::resume()
+{
+	if (paused) {
+		pausedTotal += SDL_GetTicks() - pausedAt;
+		paused = false;
+	}
+}
+
+bool GameClock::isPaused()
+{
+	return paused;
+}
+
+void GameClock::useManualTime(Uint32 start)
+{
+	manual = true;
+	manualTicks = start;
+}
+
+void GameClock::advance(Uint32 ms)
+{
+	manualTicks += ms;
+}
@@ -0,0 +1,31 @@
+#ifndef GameClock_H
+#define GameClock_H
+
+#include <SDL.h>
+
+// SDL_GetTicks() with the time spent paused taken out. Gameplay code times everything with this, so
+// pausing and resuming doesn't make every object jump by however long the game was paused.
+// Only used from the simulation thread.
+class GameClock
+{
+public:
+	static Uint32 getTicks();
+
+	static void pause();
+	static void resume();
+	static bool isPaused();
+
+	// Stops following SDL_GetTicks(); time then only moves through advance(). Used by headless runs so
+	// the same seed and tick count always give the same frame.
+	static void useManualTime(Uint32 start);
+	static void advance(Uint32 ms);
+
+private:
+	static bool manual;
+	static Uint32 manualTicks;
+	static bool paused;
+	static Uint32 pausedAt;
+	static Uint32 pausedTotal;
+};
+
+#endif
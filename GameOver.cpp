@@ -5,6 +5,7 @@
 #include <SDL_image.h>
 #include "CaveSystem.h"
 #include "DifficultySelectionScreen.h"
+#include "AssetCache.h"
 
 GameOver::GameOver(SDL_Texture *cred, SDL_Texture *rest){
     btn_restart = rest;
@@ -54,12 +55,12 @@ int GameOver::handleEvent(SDL_Event &e, SDL_Renderer *gRenderer)
     return 0;
 }
 
-void GameOver::render(SDL_Renderer *gRenderer)
+void GameOver::render(RenderSnapshot *frame)
 {
-    SDL_SetRenderDrawColor(gRenderer, 0xFF, 0xFF, 0xFF, 0xa1);
-    SDL_SetRenderDrawBlendMode(gRenderer, SDL_BLENDMODE_BLEND);
-    SDL_Rect fillRectOverlay = {0, 0, 1280, 720};
-    SDL_RenderFillRect(gRenderer, &fillRectOverlay);
+    frame->setDrawColor(0xFF, 0xFF, 0xFF, 0xa1);
+    frame->setBlendMode(SDL_BLENDMODE_BLEND);
+    SDL_Rect fillRectOverlay = {0, 0, SCREEN_WIDTH, SCREEN_HEIGHT};
+    frame->fillRect(fillRectOverlay);
 
     // SDL_SetRenderDrawColor(gRenderer, 0x4F, 0xa7, 0x00, 0xFF);
     SDL_Rect fillRectRestartButton = {RESTART_BUTTON_X, RESTART_BUTTON_Y, RESTART_BUTTON_WIDTH, RESTART_BUTTON_HEIGHT};
@@ -68,54 +69,44 @@ void GameOver::render(SDL_Renderer *gRenderer)
     SDL_Texture *restart_button_texture = nullptr;
     
     restart_button_texture = btn_restart;
-    SDL_RenderCopyEx(gRenderer, restart_button_texture, nullptr, &fillRectRestartButton, 0.0, nullptr, SDL_FLIP_NONE);
+    frame->copy(restart_button_texture, &fillRectRestartButton);
 
     SDL_Rect fillRectCredButton = {CRED_BUTTON_X, CRED_BUTTON_Y, CRED_BUTTON_WIDTH, CRED_BUTTON_HEIGHT};
 
     SDL_Texture *cred_button_texture = nullptr;
    
     cred_button_texture = btn_credits;
-    SDL_RenderCopyEx(gRenderer, cred_button_texture, nullptr, &fillRectCredButton, 0.0, nullptr, SDL_FLIP_NONE);
+    frame->copy(cred_button_texture, &fillRectCredButton);
 }
 
 void GameOver::restart(SDL_Renderer* gRenderer)
 {
-    DifficultySelectionScreen *diff_sel_screen;
-
-    SDL_Texture *back_tex = nullptr;
-    SDL_Surface *back_surf = IMG_Load("sprites/DiffScreen.png");
-    back_tex = SDL_CreateTextureFromSurface(gRenderer, back_surf);
-    SDL_FreeSurface(back_surf);
-
-    SDL_Texture *e_tex = nullptr;
-    SDL_Surface *e_surf = IMG_Load("sprites/easy_button.png");
-    e_tex = SDL_CreateTextureFromSurface(gRenderer, e_surf);
-    SDL_FreeSurface(e_surf);
-
-    SDL_Texture *m_tex = nullptr;
-    SDL_Surface *m_surf = IMG_Load("sprites/med_button.png");
-    m_tex = SDL_CreateTextureFromSurface(gRenderer, m_surf);
-    SDL_FreeSurface(m_surf);
-
-    SDL_Texture *h_tex = nullptr;
-    SDL_Surface *h_surf = IMG_Load("sprites/hard_button.png");
-    h_tex = SDL_CreateTextureFromSurface(gRenderer, h_surf);
-    SDL_FreeSurface(h_surf);
-    
-
-    diff_sel_screen = new DifficultySelectionScreen(back_tex, e_tex, m_tex, h_tex);
+    // The difficulty screen textures were loaded at startup, so reuse them from the cache
+    DifficultySelectionScreen diff_sel_screen(gAssets->acquire(ASSET_DIFF_SCREEN), gAssets->acquire(ASSET_EASY_BUTTON), gAssets->acquire(ASSET_MED_BUTTON), gAssets->acquire(ASSET_HARD_BUTTON));
     SDL_Event e;
     diff = 0;
+    // Nothing on this screen moves, so only redraw when there was input (or the window was exposed)
+    bool redraw = true;
     while(diff == 0){
-		while(SDL_PollEvent(&e)) {
-			if(e.type==SDL_QUIT){
-				diff=4;
-			}
-			diff = diff_sel_screen->handleEvent(e);
+		if (SDL_WaitEventTimeout(&e, MENU_IDLE_TIMEOUT)) {
+			do {
+				if(e.type==SDL_QUIT){
+					diff=4;
+				}
+				diff = diff_sel_screen.handleEvent(e);
+			} while(diff == 0 && SDL_PollEvent(&e));
+			redraw = true;
+		}
+		if (redraw) {
+			diff_sel_screen.render(gRenderer);
+			SDL_RenderPresent(gRenderer);
+			redraw = false;
 		}
-		diff_sel_screen->render(gRenderer);
-		SDL_RenderPresent(gRenderer);
 	}
+    gAssets->release(ASSET_DIFF_SCREEN);
+    gAssets->release(ASSET_EASY_BUTTON);
+    gAssets->release(ASSET_MED_BUTTON);
+    gAssets->release(ASSET_HARD_BUTTON);
     isGameOver = false;
 }
 
@@ -130,56 +121,9 @@ void GameOver::displayCredits(SDL_Renderer* gRenderer){
 	int retFlags = IMG_Init(imgFlags);
 
 	// Load media
-    SDL_Texture* newText = nullptr;
-	SDL_Surface* startSurf = IMG_Load("slides/Hellested_credit_roll.png");
-	newText = SDL_CreateTextureFromSurface(gRenderer, startSurf);
-	SDL_FreeSurface(startSurf);
-    gTex.push_back(newText);
-
-    startSurf = IMG_Load("slides/dilan.png");
-	newText = SDL_CreateTextureFromSurface(gRenderer, startSurf);
-	SDL_FreeSurface(startSurf);
-    gTex.push_back(newText);
-
-    startSurf = IMG_Load("slides/Trant-RandomLevelGeneration.png");
-	newText = SDL_CreateTextureFromSurface(gRenderer, startSurf);
-	SDL_FreeSurface(startSurf);
-    gTex.push_back(newText);
-
-    startSurf = IMG_Load("slides/JakeZomperCredit.png");
-	newText = SDL_CreateTextureFromSurface(gRenderer, startSurf);
-	SDL_FreeSurface(startSurf);
-    gTex.push_back(newText);
-
-    startSurf = IMG_Load("slides/Kenneth Choo Physics.png");
-	newText = SDL_CreateTextureFromSurface(gRenderer, startSurf);
-	SDL_FreeSurface(startSurf);
-    gTex.push_back(newText);
-
-    startSurf = IMG_Load("slides/Faruk Yucel.png");
-	newText = SDL_CreateTextureFromSurface(gRenderer, startSurf);
-	SDL_FreeSurface(startSurf);
-    gTex.push_back(newText);
-
-    startSurf = IMG_Load("slides/mdcredit.PNG");
-	newText = SDL_CreateTextureFromSurface(gRenderer, startSurf);
-	SDL_FreeSurface(startSurf);
-    gTex.push_back(newText);
-
-    startSurf = IMG_Load("slides/connor_schwartz_credit.png");
-	newText = SDL_CreateTextureFromSurface(gRenderer, startSurf);
-	SDL_FreeSurface(startSurf);
-    gTex.push_back(newText);
-
-    startSurf = IMG_Load("slides/Brandon's Credit 1.png");
-	newText = SDL_CreateTextureFromSurface(gRenderer, startSurf);
-	SDL_FreeSurface(startSurf);
-    gTex.push_back(newText);
-
-    startSurf = IMG_Load("slides/jeroen_credit1280x720.png");
-	newText = SDL_CreateTextureFromSurface(gRenderer, startSurf);
-	SDL_FreeSurface(startSurf);
-    gTex.push_back(newText);
+	for (int i = ASSET_CREDIT_HELLESTED; i <= ASSET_CREDIT_JEROEN; i++) {
+		gTex.push_back(gAssets->acquire((AssetID) i));
+	}
 
 	SDL_RenderClear(gRenderer);
 
@@ -223,15 +167,12 @@ void GameOver::displayCredits(SDL_Renderer* gRenderer){
 	SDL_RenderPresent(gRenderer);
 	SDL_Delay(3000);
 
-	for (auto i : gTex) {
-		SDL_DestroyTexture(i);
-		i = nullptr;
+	for (int i = ASSET_CREDIT_HELLESTED; i <= ASSET_CREDIT_JEROEN; i++) {
+		gAssets->release((AssetID) i);
 	}
+	gTex.clear();
 
-	SDL_DestroyRenderer(gRenderer);
-	gRenderer = nullptr;
-
-	// Quit SDL subsystems
+	// The renderer and SDL itself are shut down by close() in the main loop, after the asset cache
+	// has destroyed its textures
 	IMG_Quit();
-	SDL_Quit();
 }
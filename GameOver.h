@@ -4,17 +4,17 @@
 #include <SDL.h>
 #include "Player.h"
 #include "MapBlocks.h"
+#include "RenderSnapshot.h"
+#include "Screen.h"
 
 class GameOver
 {
 public:
     bool isGameOver = false;
-    // constexpr int SCREEN_WIDTH = 1280;
-    // constexpr int SCREEN_HEIGHT = 720;
     static const int RESTART_BUTTON_WIDTH = 200;
     static const int RESTART_BUTTON_HEIGHT = 50;
-    static const int RESTART_BUTTON_X = (int)(1280/2) - 100;
-    static const int RESTART_BUTTON_Y = (int)(720/1.5) - 25;
+    static const int RESTART_BUTTON_X = (int)(SCREEN_WIDTH/2) - 100;
+    static const int RESTART_BUTTON_Y = (int)(SCREEN_HEIGHT/1.5) - 25;
     GameOver(SDL_Texture *cred, SDL_Texture *rest);
 
     SDL_Texture* btn_restart;
@@ -23,12 +23,12 @@ public:
 
     static const int CRED_BUTTON_WIDTH = 200;
     static const int CRED_BUTTON_HEIGHT = 50;
-    static const int CRED_BUTTON_X = (int)(1280/2) - 100;
-    static const int CRED_BUTTON_Y = (int)(720/1.5) + 50;
+    static const int CRED_BUTTON_X = (int)(SCREEN_WIDTH/2) - 100;
+    static const int CRED_BUTTON_Y = (int)(SCREEN_HEIGHT/1.5) + 50;
 
     void stopGame(Player*, MapBlocks*);
     int handleEvent(SDL_Event &e, SDL_Renderer *gRenderer);
-    void render(SDL_Renderer *gRenderer);
+    void render(RenderSnapshot *frame);
 private:
     void restart(SDL_Renderer *gRenderer);
     void displayCredits(SDL_Renderer* gRenderer);
@@ -0,0 +1,178 @@
+#include "HudLayer.h"
+#include "Player.h"
+#include "Text.h"
+#include <iostream>
+
+HudLayer::HudLayer(SDL_Renderer *gRenderer, TTF_Font *font, int screenWidth, int screenHeight) : gRenderer{gRenderer}, font{font}, screenWidth{screenWidth}, screenHeight{screenHeight}
+{
+	drawnOnce = false;
+	for (int i = 0; i < WIDGET_COUNT; i++) {
+		drawn[i] = {0, 0, 0, 0};
+	}
+	layer = SDL_CreateTexture(gRenderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET, screenWidth, screenHeight);
+	if (layer == nullptr) {
+		std::cout << "Unable to create HUD layer! SDL Error: " << SDL_GetError() << std::endl;
+		return;
+	}
+	SDL_SetTextureBlendMode(layer, SDL_BLENDMODE_BLEND);
+}
+
+HudLayer::~HudLayer()
+{
+	if (layer != nullptr) {
+		SDL_DestroyTexture(layer);
+	}
+}
+
+void HudLayer::draw(const HudState &state)
+{
+	if (layer == nullptr) {
+		return;
+	}
+
+	bool changed = !drawnOnce;
+	for (int i = 0; i < WIDGET_COUNT && !changed; i++) {
+		changed = isDirty((Widget) i, state);
+	}
+	if (changed) {
+		Uint8 r, g, b, a;
+		SDL_BlendMode blend_mode;
+		SDL_GetRenderDrawColor(gRenderer, &r, &g, &b, &a);
+		SDL_GetRenderDrawBlendMode(gRenderer, &blend_mode);
+		SDL_Texture* old_target = SDL_GetRenderTarget(gRenderer);
+		// Changing targets resets the scale, which the resolution scaler may have set
+		float scale_x, scale_y;
+		SDL_RenderGetScale(gRenderer, &scale_x, &scale_y);
+
+		// Everything is drawn as is, alpha included, so the layer blends like the HUD drawn straight on screen
+		SDL_SetRenderTarget(gRenderer, layer);
+		SDL_SetRenderDrawBlendMode(gRenderer, SDL_BLENDMODE_NONE);
+		if (!drawnOnce) {
+			SDL_SetRenderDrawColor(gRenderer, 0x00, 0x00, 0x00, 0x00);
+			SDL_RenderClear(gRenderer);
+			drawLabels();
+		}
+		for (int i = 0; i < WIDGET_COUNT; i++) {
+			if (!drawnOnce || isDirty((Widget) i, state)) {
+				redraw((Widget) i, state);
+			}
+		}
+		shown = state;
+		drawnOnce = true;
+
+		SDL_SetRenderTarget(gRenderer, old_target);
+		SDL_RenderSetScale(gRenderer, scale_x, scale_y);
+		SDL_SetRenderDrawBlendMode(gRenderer, blend_mode);
+		SDL_SetRenderDrawColor(gRenderer, r, g, b, a);
+	}
+
+	SDL_RenderCopy(gRenderer, layer, nullptr, nullptr);
+}
+
+bool HudLayer::isDirty(Widget widget, const HudState &state)
+{
+	switch (widget) {
+		case WIDGET_FPS:
+			return state.fps != shown.fps;
+		case WIDGET_SCORE:
+			return state.score != shown.score;
+		case WIDGET_HIGH_SCORE:
+			return state.highScore != shown.highScore;
+		case WIDGET_HEALTH:
+			return state.health != shown.health || state.invincible != shown.invincible;
+		case WIDGET_BACK_HEAT:
+			return state.backHeat != shown.backHeat || state.backMaxed != shown.backMaxed;
+		case WIDGET_FRONT_HEAT:
+			return state.frontHeat != shown.frontHeat || state.frontMaxed != shown.frontMaxed;
+		default:
+			return false;
+	}
+}
+
+void HudLayer::redraw(Widget widget, const HudState &state)
+{
+	// Wipe what the widget drew last time; text can get shorter
+	SDL_SetRenderDrawColor(gRenderer, 0x00, 0x00, 0x00, 0x00);
+	SDL_RenderFillRect(gRenderer, &drawn[widget]);
+
+	SDL_Color color;
+	switch (widget) {
+		case WIDGET_FPS:
+			drawn[widget] = {0, 0, 0, 0};
+			if (state.fps >= 0) {
+				drawn[widget] = drawText(std::to_string(state.fps) + " fps", 20, 20);
+			}
+			break;
+		case WIDGET_SCORE:
+			drawn[widget] = drawText("Score: " + std::to_string(state.score), screenWidth - 130, 7);
+			break;
+		case WIDGET_HIGH_SCORE:
+			drawn[widget] = drawText("High Score: " + std::to_string(state.highScore), screenWidth - 130, 32);
+			break;
+		case WIDGET_HEALTH:
+			if (state.invincible) {
+				color = {0xD4, 0xAF, 0x37, 0xFF};
+			}
+			else if (state.health > 75) {
+				color = {0x00, 0x00, 0xFF, 0xFF};
+			}
+			else if (state.health >= 50) {
+				color = {0x00, 0xFF, 0x00, 0xFF};
+			}
+			else if (state.health >= 20) {
+				color = {0xFF, 0xFF, 0x00, 0xFF};
+			}
+			else {
+				color = {0xFF, 0x00, 0x00, 0xFF};
+			}
+			drawn[widget] = drawBar(199, 202, 2 * state.health, color);
+			break;
+		case WIDGET_BACK_HEAT:
+			color = state.backMaxed ? SDL_Color{0xFF, 0x00, 0x00, 0xFF} : SDL_Color{0x00, 0x00, 0xFF, 0xFF};
+			drawn[widget] = drawBar(749, 152, state.backHeat * 150 / Player::MAX_SHOOT_HEAT, color);
+			break;
+		case WIDGET_FRONT_HEAT:
+			color = state.frontMaxed ? SDL_Color{0xFF, 0x00, 0x00, 0xFF} : SDL_Color{0x00, 0x00, 0xFF, 0xFF};
+			drawn[widget] = drawBar(1049, 152, state.frontHeat * 150 / Player::MAX_SHOOT_HEAT, color);
+			break;
+		default:
+			break;
+	}
+}
+
+SDL_Rect HudLayer::drawText(const std::string &message_text, int x, int y)
+{
+	SDL_Rect text_rect = {x, y, 0, 0};
+	SDL_Texture* text = Text::loadFont(gRenderer, message_text, {255, 255, 255, 255}, font);
+	if (text == nullptr) {
+		return text_rect;
+	}
+	SDL_QueryTexture(text, nullptr, nullptr, &text_rect.w, &text_rect.h);
+	SDL_SetTextureBlendMode(text, SDL_BLENDMODE_NONE);
+	SDL_RenderCopy(gRenderer, text, nullptr, &text_rect);
+	SDL_DestroyTexture(text);
+	return text_rect;
+}
+
+SDL_Rect HudLayer::drawBar(int x, int width, int fill, const SDL_Color &color)
+{
+	SDL_Rect outline = {x, screenHeight - 56, width, 32};
+	SDL_SetRenderDrawColor(gRenderer, 0x00, 0x00, 0x00, 0xFF);
+	SDL_RenderDrawRect(gRenderer, &outline);
+
+	SDL_Rect fill_rect = {x + 1, screenHeight - 55, fill, 30};
+	SDL_SetRenderDrawColor(gRenderer, color.r, color.g, color.b, color.a);
+	SDL_RenderFillRect(gRenderer, &fill_rect);
+
+	SDL_Rect covered;
+	SDL_UnionRect(&outline, &fill_rect, &covered);
+	return covered;
+}
+
+// The labels never change, so they are only drawn when the layer is first filled in
+void HudLayer::drawLabels()
+{
+	drawText("Health ", 140, screenHeight - 52);
+	drawText("Back Gun", 670, screenHeight - 52);
+	drawText("Front Gun", 960, screenHeight - 52);
+}
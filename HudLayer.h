@@ -0,0 +1,65 @@
+#ifndef HudLayer_H
+#define HudLayer_H
+
+#include <SDL.h>
+#include <SDL_ttf.h>
+#include <string>
+
+// What the HUD shows. The simulation fills one in every tick; only the parts that differ from what
+// the HUD last drew get drawn again.
+struct HudState
+{
+	int health;
+	bool invincible;
+	int frontHeat;
+	bool frontMaxed;
+	int backHeat;
+	bool backMaxed;
+	int score;
+	int highScore;
+	// Frames presented over the last second, or -1 before the first second has passed
+	int fps;
+};
+
+// The score panel and the health and heat bars, kept in a screen-sized texture. Each widget is
+// redrawn into the texture when its values change, and the whole HUD goes on screen with one copy.
+// Lives on the drawing side next to the renderer.
+class HudLayer
+{
+public:
+	HudLayer(SDL_Renderer *gRenderer, TTF_Font *font, int screenWidth, int screenHeight);
+	~HudLayer();
+
+	void draw(const HudState &state);
+
+private:
+	enum Widget
+	{
+		WIDGET_FPS,
+		WIDGET_SCORE,
+		WIDGET_HIGH_SCORE,
+		WIDGET_HEALTH,
+		WIDGET_BACK_HEAT,
+		WIDGET_FRONT_HEAT,
+		WIDGET_COUNT
+	};
+
+	SDL_Renderer *gRenderer;
+	TTF_Font *font;
+	int screenWidth, screenHeight;
+	SDL_Texture *layer;
+	HudState shown;
+	bool drawnOnce;
+	// Where each widget last drew, so it can be cleared before being drawn again
+	SDL_Rect drawn[WIDGET_COUNT];
+
+	bool isDirty(Widget widget, const HudState &state);
+	void redraw(Widget widget, const HudState &state);
+	// Draws text with its top left corner at x, y and returns the area it covered
+	SDL_Rect drawText(const std::string &message_text, int x, int y);
+	// Draws a bar's outline and fills it in to fill pixels. Returns the area it covered.
+	SDL_Rect drawBar(int x, int width, int fill, const SDL_Color &color);
+	void drawLabels();
+};
+
+#endif
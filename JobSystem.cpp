@@ -0,0 +1,220 @@
+#include "JobSystem.h"
+#include <iostream>
+#include <algorithm>
+
+JobSystem *gJobs = nullptr;
+
+JobSystem::Counter::Counter()
+{
+	SDL_AtomicSet(&pending, 0);
+}
+
+JobSystem::JobSystem()
+{
+	quitting = false;
+	SDL_AtomicSet(&queued, 0);
+
+	lock = SDL_CreateMutex();
+	wake = SDL_CreateCond();
+	finished = SDL_CreateCond();
+	if (lock == nullptr || wake == nullptr || finished == nullptr) {
+		std::cout << "Unable to create job system locks, running single threaded! SDL Error: " << SDL_GetError() << std::endl;
+		return;
+	}
+
+	int worker_count = SDL_GetCPUCount() - 2;
+	if (worker_count > MAX_WORKERS) worker_count = MAX_WORKERS;
+	if (worker_count < 0) worker_count = 0;
+	queues.resize(worker_count + 1);
+	for (int i = 0; i < queues.size(); i++) {
+		queues[i].lock = SDL_CreateMutex();
+		if (queues[i].lock == nullptr) {
+			std::cout << "Unable to create job queue locks, running single threaded! SDL Error: " << SDL_GetError() << std::endl;
+			worker_count = 0;
+		}
+	}
+
+	// Kept in place for the workers to point at
+	workerInfo.resize(worker_count);
+	for (int i = 0; i < worker_count; i++) {
+		workerInfo[i].system = this;
+		workerInfo[i].index = i + 1;
+		SDL_Thread* worker = SDL_CreateThread(workerLoop, "SimWorker", &workerInfo[i]);
+		if (worker == nullptr) {
+			std::cout << "Unable to start a simulation worker! SDL Error: " << SDL_GetError() << std::endl;
+			break;
+		}
+		workers.push_back(worker);
+	}
+}
+
+JobSystem::~JobSystem()
+{
+	if (lock != nullptr) {
+		SDL_LockMutex(lock);
+		quitting = true;
+		SDL_CondBroadcast(wake);
+		SDL_UnlockMutex(lock);
+	}
+	for (int i = 0; i < workers.size(); i++) {
+		SDL_WaitThread(workers[i], nullptr);
+	}
+	for (int i = 0; i < queues.size(); i++) {
+		if (queues[i].lock != nullptr) SDL_DestroyMutex(queues[i].lock);
+	}
+	if (finished != nullptr) SDL_DestroyCond(finished);
+	if (wake != nullptr) SDL_DestroyCond(wake);
+	if (lock != nullptr) SDL_DestroyMutex(lock);
+}
+
+void JobSystem::parallelFor(int count, Task task, void* data, Counter* done, int grain, Counter* after)
+{
+	// Without workers everything before this has already run, so nothing needs holding back
+	if (workers.empty()) {
+		for (int i = 0; i < count; i++) {
+			task(i, data);
+		}
+		return;
+	}
+	if (count <= 0) {
+		return;
+	}
+
+	if (grain <= 0) {
+		grain = count / (CHUNKS_PER_THREAD * (workers.size() + 1));
+		if (grain < 1) grain = 1;
+	}
+	std::vector<Job> jobs;
+	jobs.reserve((count + grain - 1) / grain);
+	for (int begin = 0; begin < count; begin += grain) {
+		Job job = {task, data, begin, std::min(begin + grain, count), done};
+		jobs.push_back(job);
+	}
+
+	SDL_LockMutex(lock);
+	SDL_AtomicAdd(&done->pending, jobs.size());
+	if (after != nullptr && SDL_AtomicGet(&after->pending) > 0) {
+		after->held.insert(after->held.end(), jobs.begin(), jobs.end());
+		SDL_UnlockMutex(lock);
+		return;
+	}
+	SDL_UnlockMutex(lock);
+	push(0, jobs);
+}
+
+void JobSystem::wait(Counter* done)
+{
+	// Help out while there is anything to take, then sleep until the last job reports in
+	Job job;
+	while (SDL_AtomicGet(&done->pending) > 0 && take(0, job)) {
+		run(0, job);
+	}
+	if (lock == nullptr) {
+		return;
+	}
+	SDL_LockMutex(lock);
+	while (SDL_AtomicGet(&done->pending) > 0) {
+		SDL_CondWait(finished, lock);
+	}
+	SDL_UnlockMutex(lock);
+}
+
+void JobSystem::parallelFor(int count, Task task, void* data)
+{
+	Counter done;
+	parallelFor(count, task, data, &done);
+	wait(&done);
+}
+
+int JobSystem::getWorkerCount()
+{
+	return workers.size();
+}
+
+// Puts jobs on the end of thread self's queue and wakes the workers
+void JobSystem::push(int self, const std::vector<Job> &jobs)
+{
+	SDL_LockMutex(queues[self].lock);
+	queues[self].jobs.insert(queues[self].jobs.end(), jobs.begin(), jobs.end());
+	SDL_UnlockMutex(queues[self].lock);
+	SDL_AtomicAdd(&queued, jobs.size());
+
+	SDL_LockMutex(lock);
+	if (jobs.size() == 1) {
+		SDL_CondSignal(wake);
+	}
+	else {
+		SDL_CondBroadcast(wake);
+	}
+	SDL_UnlockMutex(lock);
+}
+
+// Newest job from thread self's own queue, or else the oldest from someone else's
+bool JobSystem::take(int self, Job &job)
+{
+	if (queues.empty() || SDL_AtomicGet(&queued) == 0) {
+		return false;
+	}
+	for (int i = 0; i < queues.size(); i++) {
+		Queue &queue = queues[(self + i) % queues.size()];
+		SDL_LockMutex(queue.lock);
+		if (!queue.jobs.empty()) {
+			if (i == 0) {
+				job = queue.jobs.back();
+				queue.jobs.pop_back();
+			}
+			else {
+				job = queue.jobs.front();
+				queue.jobs.pop_front();
+			}
+			SDL_UnlockMutex(queue.lock);
+			SDL_AtomicAdd(&queued, -1);
+			return true;
+		}
+		SDL_UnlockMutex(queue.lock);
+	}
+	return false;
+}
+
+// Runs a job, then reports it done. The last job of a counter lets go of whatever was held back on it.
+void JobSystem::run(int self, const Job &job)
+{
+	for (int i = job.begin; i < job.end; i++) {
+		job.task(i, job.data);
+	}
+
+	// Under the lock, so a waiter can't see the counter reach zero and free it while it is still in use here
+	std::vector<Job> released;
+	SDL_LockMutex(lock);
+	if (SDL_AtomicAdd(&job.done->pending, -1) == 1) {
+		released.swap(job.done->held);
+		SDL_CondBroadcast(finished);
+	}
+	SDL_UnlockMutex(lock);
+	if (!released.empty()) {
+		push(self, released);
+	}
+}
+
+int JobSystem::workerLoop(void* data)
+{
+	Worker* worker = (Worker*) data;
+	JobSystem* system = worker->system;
+	Job job;
+	while (true) {
+		if (system->take(worker->index, job)) {
+			system->run(worker->index, job);
+			continue;
+		}
+		SDL_LockMutex(system->lock);
+		while (SDL_AtomicGet(&system->queued) == 0 && !system->quitting) {
+			SDL_CondWait(system->wake, system->lock);
+		}
+		bool quitting = system->quitting;
+		SDL_UnlockMutex(system->lock);
+		if (quitting) {
+			break;
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,103 @@
+#ifndef JobSystem_H
+#define JobSystem_H
+
+#include <SDL.h>
+#include <deque>
+#include <vector>
+
+// Splits a tick's work across the cores. Work goes in as jobs, each running a task over a chunk of
+// indices. Every thread has its own queue: it works newest first from its own queue and steals oldest
+// first from the others once its own runs dry. The simulation thread is thread 0 and helps run jobs
+// while it waits on them.
+//
+// Jobs report to a Counter, which is the join point for wait(). A batch can also be held back until
+// another counter is done, so later stages can be queued before the ones they depend on have run.
+//
+// A task may only touch its own index's data and things nobody writes until its counter is done.
+// Jobs are only queued and waited on from the simulation thread.
+class JobSystem
+{
+public:
+	typedef void (*Task)(int index, void* data);
+	class Counter;
+
+private:
+	struct Job
+	{
+		Task task;
+		void* data;
+		int begin;
+		int end;
+		Counter* done;
+	};
+
+public:
+	// How many jobs are still to finish. Has to outlive them.
+	class Counter
+	{
+	public:
+		Counter();
+
+	private:
+		friend class JobSystem;
+		SDL_atomic_t pending;
+		// Jobs held back until this is done. Guarded by the system lock.
+		std::vector<Job> held;
+	};
+
+	// Most workers started, on top of the simulation thread
+	static const int MAX_WORKERS = 7;
+	// Chunks a parallel for is split into per thread, so a thread that finishes early has some to steal
+	static const int CHUNKS_PER_THREAD = 4;
+
+	// Sized to the cores left once the simulation and render threads have one each
+	JobSystem();
+	// Stops and joins the workers
+	~JobSystem();
+
+	// Queues task(i, data) for every i in [0, count), grain indices to a job (0 picks a size from the
+	// thread count). None of them start before after, if given, is done. Waiting on done doesn't wait on
+	// after, which still needs waiting on itself (with count 0 nothing holds on to it at all).
+	void parallelFor(int count, Task task, void* data, Counter* done, int grain = 0, Counter* after = nullptr);
+	// Runs queued jobs until done has no jobs left
+	void wait(Counter* done);
+	// Runs task(i, data) for every i in [0, count) and waits for all of them
+	void parallelFor(int count, Task task, void* data);
+
+	int getWorkerCount();
+
+private:
+	struct Queue
+	{
+		SDL_mutex *lock;
+		std::deque<Job> jobs;
+	};
+	struct Worker
+	{
+		JobSystem* system;
+		int index;
+	};
+
+	// One per thread, the simulation thread's first
+	std::vector<Queue> queues;
+	std::vector<Worker> workerInfo;
+	std::vector<SDL_Thread*> workers;
+	// Guards counters and sleeping
+	SDL_mutex *lock;
+	SDL_cond *wake;
+	SDL_cond *finished;
+	bool quitting;
+	// Jobs sitting in any queue
+	SDL_atomic_t queued;
+
+	void push(int self, const std::vector<Job> &jobs);
+	bool take(int self, Job &job);
+	void run(int self, const Job &job);
+
+	static int workerLoop(void* worker);
+};
+
+// The job system shared by the whole game, created in main()
+extern JobSystem *gJobs;
+
+#endif
@@ -0,0 +1,218 @@
+#include "KamikazeSwarm.h"
+#include <algorithm>
+#include "AssetCache.h"
+#include "GameClock.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define KAMIKAZE_SWARM_SSE2
+#endif
+
+// Planes in the swarm, the gap between their arrivals and how soon one that flew past comes back, by difficulty
+static const int SWARM_SIZE[] = {3, 5, 8};
+static const int SWARM_STAGGER[] = {1200, 800, 400};
+static const int SWARM_PASS_DELAY[] = {500, 300, 100};
+// Formation heights around the player, handed out in turn
+static const float FORMATION_OFFSETS[] = {0, -90, 90, -180, 180};
+
+KamikazeSwarm::KamikazeSwarm(int difficulty)
+{
+	int level = std::min(2, std::max(0, difficulty - 1));
+	count = SWARM_SIZE[level];
+	stagger = SWARM_STAGGER[level];
+	passDelay = SWARM_PASS_DELAY[level];
+	nextSlot = GameClock::getTicks();
+	lastMove = GameClock::getTicks();
+	held = false;
+	gAssets->acquireAnimation(ANIM_KAMIKAZE);
+	animation = Animator::play(ANIM_KAMIKAZE);
+
+	for (int i = 0; i < CAPACITY; i++) {
+		offsetY[i] = FORMATION_OFFSETS[i % 5];
+		tiltAngle[i] = 0;
+		shootable[i] = 1;
+		xPos[i] = PARK_X;
+		yPos[i] = SCREEN_HEIGHT / 2;
+		arrivalTime[i] = 0;
+		entityId[i] = 0;
+	}
+	for (int i = 0; i < count; i++) {
+		schedule(i, RETURN_DELAY);
+	}
+}
+
+KamikazeSwarm::~KamikazeSwarm()
+{
+	gAssets->releaseAnimation(ANIM_KAMIKAZE);
+}
+
+void KamikazeSwarm::move(int playerX, int playerY)
+{
+	for (int i = 0; i < count; i++) {
+		if (xPos[i] < -WIDTH) {
+			schedule(i, passDelay);
+		}
+	}
+	Uint32 now = GameClock::getTicks();
+	steer(playerX, playerY, now, (now - lastMove) / 1000.0f);
+	lastMove = now;
+}
+
+void KamikazeSwarm::destroy(int i, int delay)
+{
+	explosions.push_back({(int) xPos[i], (int) yPos[i], WIDTH, HEIGHT});
+	schedule(i, delay);
+}
+
+void KamikazeSwarm::hold()
+{
+	held = true;
+	for (int i = 0; i < count; i++) {
+		if (xPos[i] >= SCREEN_WIDTH) {
+			schedule(i, 0);
+		}
+	}
+}
+
+void KamikazeSwarm::release()
+{
+	held = false;
+	nextSlot = GameClock::getTicks();
+	lastMove = GameClock::getTicks();
+	// Planes still flying from before the cave carry on
+	for (int i = 0; i < count; i++) {
+		if (xPos[i] >= SCREEN_WIDTH) {
+			schedule(i, 50);
+		}
+	}
+}
+
+bool KamikazeSwarm::isHeld()
+{
+	return held;
+}
+
+int KamikazeSwarm::findHit(int x, int y, int w, int h, bool shotsOnly)
+{
+	for (int i = 0; i < count; i++) {
+		if (shotsOnly && !shootable[i]) {
+			continue;
+		}
+		if (x + w < xPos[i] || x > xPos[i] + WIDTH)
+			continue;
+		if (y + h < yPos[i] || y > yPos[i] + HEIGHT)
+			continue;
+		return i;
+	}
+	return -1;
+}
+
+std::vector<SDL_Rect> KamikazeSwarm::takeExplosions()
+{
+	std::vector<SDL_Rect> taken;
+	taken.swap(explosions);
+	return taken;
+}
+
+void KamikazeSwarm::render(RenderSnapshot* frame)
+{
+	for (int i = 0; i < count; i++) {
+		if (xPos[i] < SCREEN_WIDTH) {
+			SDL_Rect kam_sprite = {(int) xPos[i], (int) yPos[i], WIDTH, HEIGHT};
+			frame->beginEntity(entityId[i]);
+			Animator::draw(frame, animation, kam_sprite, tiltAngle[i]);
+			frame->endEntity();
+		}
+	}
+}
+
+int KamikazeSwarm::size()
+{
+	return count;
+}
+
+int KamikazeSwarm::getX(int i)
+{
+	return (int) xPos[i];
+}
+
+int KamikazeSwarm::getY(int i)
+{
+	return (int) yPos[i];
+}
+
+// Parks plane i off screen and books it the next free arrival at least delay ms away. While the
+// swarm is held it stays parked until release() books it again.
+void KamikazeSwarm::schedule(int i, int delay)
+{
+	if (held) {
+		arrivalTime[i] = SDL_MAX_SINT32;
+	}
+	else {
+		Sint32 now = GameClock::getTicks();
+		arrivalTime[i] = std::max(now + delay, nextSlot);
+		nextSlot = arrivalTime[i] + stagger;
+	}
+	xPos[i] = PARK_X;
+	yPos[i] = SCREEN_HEIGHT / 2;
+	entityId[i] = RenderSnapshot::newEntityId();
+}
+
+// Flies in once a plane's time comes, then follows the player up and down until it is past them,
+// and dives once ASSAULT_FREQ is up. Four planes at a time with SSE2, the same sums one at a time otherwise.
+void KamikazeSwarm::steer(float playerX, float playerY, Sint32 now, float seconds)
+{
+	const float hold_line = SCREEN_WIDTH - WIDTH - 10;
+	const float half_height = HEIGHT / 2;
+	int i = 0;
+#ifdef KAMIKAZE_SWARM_SSE2
+	__m128i nows = _mm_set1_epi32(now);
+	__m128i assault_nows = _mm_set1_epi32(now - ASSAULT_FREQ);
+	__m128 all = _mm_castsi128_ps(_mm_set1_epi32(-1));
+	__m128 px = _mm_set1_ps(playerX);
+	__m128 py = _mm_set1_ps(playerY);
+	__m128 line = _mm_set1_ps(hold_line);
+	__m128 half = _mm_set1_ps(half_height);
+	__m128 move_back = _mm_set1_ps(-MAX_MOVE_VELO);
+	__m128 move_on = _mm_set1_ps(MAX_MOVE_VELO);
+	__m128 dive = _mm_set1_ps(-MAX_ASSAULT_VELO);
+	__m128 tilt_up = _mm_set1_ps(15);
+	__m128 tilt_down = _mm_set1_ps(-15);
+	__m128 dt = _mm_set1_ps(seconds);
+	for (; i + 4 <= count; i += 4) {
+		__m128 x = _mm_loadu_ps(xPos + i);
+		__m128 y = _mm_loadu_ps(yPos + i);
+		__m128i arrivals = _mm_loadu_si128((const __m128i*) (arrivalTime + i));
+
+		__m128 flying_in = _mm_and_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(nows, arrivals)), _mm_cmpgt_ps(x, line));
+		__m128 tracking = _mm_andnot_ps(_mm_or_ps(flying_in, _mm_cmplt_ps(x, px)), all);
+		__m128 target = _mm_add_ps(py, _mm_loadu_ps(offsetY + i));
+		// Never both at once
+		__m128 up = _mm_and_ps(tracking, _mm_cmpgt_ps(y, _mm_add_ps(target, half)));
+		__m128 down = _mm_and_ps(tracking, _mm_cmplt_ps(y, _mm_sub_ps(target, half)));
+		__m128 assault = _mm_castsi128_ps(_mm_cmpgt_epi32(assault_nows, arrivals));
+
+		__m128 x_velo = _mm_or_ps(_mm_and_ps(assault, dive), _mm_andnot_ps(assault, _mm_and_ps(flying_in, move_back)));
+		__m128 y_velo = _mm_or_ps(_mm_and_ps(up, move_back), _mm_and_ps(down, move_on));
+		_mm_storeu_ps(tiltAngle + i, _mm_or_ps(_mm_and_ps(up, tilt_up), _mm_and_ps(down, tilt_down)));
+		_mm_storeu_si128((__m128i*) (shootable + i), _mm_castps_si128(_mm_andnot_ps(flying_in, all)));
+		_mm_storeu_ps(xPos + i, _mm_add_ps(x, _mm_mul_ps(x_velo, dt)));
+		_mm_storeu_ps(yPos + i, _mm_add_ps(y, _mm_mul_ps(y_velo, dt)));
+	}
+#endif
+	for (; i < count; i++) {
+		bool flying_in = now > arrivalTime[i] && xPos[i] > hold_line;
+		bool tracking = !flying_in && !(xPos[i] < playerX);
+		float target = playerY + offsetY[i];
+		bool up = tracking && yPos[i] > target + half_height;
+		bool down = tracking && yPos[i] < target - half_height;
+		bool assault = now - ASSAULT_FREQ > arrivalTime[i];
+
+		float x_velo = assault ? -MAX_ASSAULT_VELO : (flying_in ? -MAX_MOVE_VELO : 0);
+		float y_velo = up ? -MAX_MOVE_VELO : (down ? MAX_MOVE_VELO : 0);
+		tiltAngle[i] = up ? 15 : (down ? -15 : 0);
+		shootable[i] = flying_in ? 0 : -1;
+		xPos[i] += x_velo * seconds;
+		yPos[i] += y_velo * seconds;
+	}
+}
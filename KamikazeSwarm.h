@@ -0,0 +1,87 @@
+#ifndef KamikazeSwarm_H
+#define KamikazeSwarm_H
+
+#include <SDL.h>
+#include <vector>
+#include "RenderSnapshot.h"
+#include "Animation.h"
+#include "Screen.h"
+
+// Every kamikaze plane, kept as parallel arrays so the whole swarm moves in one pass. A plane waits
+// off the right edge for its arrival time, flies in, keeps level with the player at its own place in
+// the formation, then dives across the screen once ASSAULT_FREQ has passed.
+//
+// Arrivals are staggered, so the swarm comes in a plane at a time however many go down at once.
+// Harder difficulties fly more planes, closer together. Planes that go off are queued for
+// takeExplosions() rather than drawing anything themselves.
+class KamikazeSwarm
+{
+public:
+	static const int CAPACITY = 16;
+	static const int WIDTH = 125;
+	static const int HEIGHT = 53;
+	// How much cave a kamikaze blows away when it goes off
+	static const int BLAST_RADIUS = 60;
+	// How long a plane that crashed or was shot down takes to come back
+	static const int RETURN_DELAY = 1000;
+
+	KamikazeSwarm(int difficulty);
+	~KamikazeSwarm();
+
+	// Sends planes that flew off the left edge back to wait their turn, then moves every plane
+	void move(int playerX, int playerY);
+	// Blows plane i up and sends it back to wait its turn, at least delay ms from now
+	void destroy(int i, int delay);
+
+	// For the caves: planes already on screen fly on, but no more come in until release()
+	void hold();
+	void release();
+	bool isHeld();
+
+	// The first plane overlapping the box, or -1. Planes still flying in can't be shot.
+	int findHit(int x, int y, int w, int h, bool shotsOnly);
+	// Where planes went off since the last call
+	std::vector<SDL_Rect> takeExplosions();
+
+	void render(RenderSnapshot* frame);
+
+	int size();
+	int getX(int i);
+	int getY(int i);
+
+private:
+	static const int ASSAULT_FREQ = 4000;
+	static const int MAX_MOVE_VELO = 175;
+	static const int MAX_ASSAULT_VELO = 800;
+	// Where waiting planes sit, off the right of the screen
+	static const int PARK_X = SCREEN_WIDTH + 125;
+
+	int count;
+	// Gap kept between arrivals, and how soon a plane that flew past comes back
+	int stagger;
+	int passDelay;
+	// Earliest time the next plane may arrive
+	Sint32 nextSlot;
+	Uint32 lastMove;
+	bool held;
+
+	float xPos[CAPACITY];
+	float yPos[CAPACITY];
+	// How far above or below the player each plane keeps
+	float offsetY[CAPACITY];
+	float tiltAngle[CAPACITY];
+	Sint32 arrivalTime[CAPACITY];
+	// Zero while a plane is flying in and can't be shot
+	Sint32 shootable[CAPACITY];
+	// Each plane takes a new one every time it is sent back to wait
+	Uint32 entityId[CAPACITY];
+
+	// Every plane flies the same clip
+	AnimationState animation;
+	std::vector<SDL_Rect> explosions;
+
+	void schedule(int i, int delay);
+	void steer(float playerX, float playerY, Sint32 now, float seconds);
+};
+
+#endif
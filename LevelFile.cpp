@@ -0,0 +1,227 @@
+#include "LevelFile.h"
+#include "MapBlocks.h"
+#include "CaveGenerator.h"
+#include "Screen.h"
+#include <iostream>
+#include <cstring>
+
+const char LevelFile::MAGIC[4] = {'T', 'A', 'L', 'V'};
+
+// Sections start on 8 byte boundaries so they can be used in place
+static Uint64 alignSection(Uint64 offset)
+{
+	return (offset + 7) & ~(Uint64) 7;
+}
+
+LevelFile::LevelFile()
+{
+	header = nullptr;
+	chunkIndex = nullptr;
+	records = nullptr;
+	caves = nullptr;
+}
+
+LevelFile::~LevelFile()
+{
+	close();
+}
+
+bool LevelFile::open(const char* path)
+{
+	close();
+	if (!file.open(path)) {
+		std::cout << "Unable to open level " << path << "!" << std::endl;
+		return false;
+	}
+	const Uint8* data = file.getData();
+	size_t dataSize = file.getSize();
+
+	header = (const LevelHeader*) data;
+	if (dataSize < sizeof(LevelHeader) || memcmp(header->magic, MAGIC, 4) != 0 || header->version != VERSION) {
+		std::cout << "Unable to use level " << path << "! It is not a version " << VERSION << " level" << std::endl;
+		close();
+		return false;
+	}
+	const char* problem = checkParams(header->params);
+	if (problem == nullptr && !isSeedOnly() && header->chunkWidth != (Uint32) header->params.caveFreq) {
+		problem = "Its chunks are not one cave period wide";
+	}
+	if (problem != nullptr) {
+		std::cout << "Unable to use level " << path << "! " << problem << std::endl;
+		close();
+		return false;
+	}
+	if (isSeedOnly()) {
+		if (header->params.generatorVersion != GENERATOR_VERSION) {
+			std::cout << "Unable to use level " << path << "! It needs level generator version " << header->params.generatorVersion << ", this is version " << GENERATOR_VERSION << std::endl;
+			close();
+			return false;
+		}
+		return true;
+	}
+
+	Uint64 chunkEnd = header->chunkOffset + ((Uint64) header->chunkCount + 1) * sizeof(Uint32);
+	Uint64 recordEnd = header->recordOffset + (Uint64) header->recordCount * sizeof(LevelRecord);
+	Uint64 caveEnd = header->caveOffset + (Uint64) header->caveCount * sizeof(LevelCave);
+	if (chunkEnd > dataSize || recordEnd > dataSize || caveEnd > dataSize) {
+		std::cout << "Unable to use level " << path << "! It is truncated" << std::endl;
+		close();
+		return false;
+	}
+	chunkIndex = (const Uint32*) (data + header->chunkOffset);
+	records = (const LevelRecord*) (data + header->recordOffset);
+	caves = (const LevelCave*) (data + header->caveOffset);
+	for (Uint32 i = 0; i < header->chunkCount; i++) {
+		if (chunkIndex[i] > chunkIndex[i + 1] || chunkIndex[i + 1] > header->recordCount) {
+			std::cout << "Unable to use level " << path << "! Its chunk index is bad" << std::endl;
+			close();
+			return false;
+		}
+	}
+	return true;
+}
+
+const char* LevelFile::checkParams(const LevelParams &params)
+{
+	// Levels are streamed a cave period at a time, and the game loop only brings caves in (and seeds
+	// them) every CAVE_SYSTEM_FREQ, so hazards placed around any other period would overlap the caves
+	if (params.caveFreq != CaveSystem::CAVE_SYSTEM_FREQ) {
+		return "Its cave period is not the one the game plays";
+	}
+	if (params.caveWidth != CaveBlock::CAVE_SYSTEM_PIXEL_WIDTH) {
+		return "Its cave width is not the one the game plays";
+	}
+	if (params.width < SCREEN_WIDTH || params.height < SCREEN_HEIGHT) {
+		return "It is smaller than the screen";
+	}
+	if (params.difficulty < 1 || params.difficulty > 3) {
+		return "Its difficulty is out of range";
+	}
+	if (params.caveStyle > CAVE_NOISE) {
+		return "Its cave style is unknown";
+	}
+	return nullptr;
+}
+
+void LevelFile::close()
+{
+	file.close();
+	header = nullptr;
+	chunkIndex = nullptr;
+	records = nullptr;
+	caves = nullptr;
+}
+
+bool LevelFile::isOpen()
+{
+	return file.isOpen();
+}
+
+const LevelParams& LevelFile::getParams()
+{
+	return header->params;
+}
+
+bool LevelFile::isSeedOnly()
+{
+	return header->chunkCount == 0 && header->caveCount == 0;
+}
+
+const LevelRecord* LevelFile::getChunk(int chunk, int* count)
+{
+	*count = 0;
+	if (chunkIndex == nullptr || chunk < 0 || (Uint32) chunk >= header->chunkCount) {
+		return nullptr;
+	}
+	*count = chunkIndex[chunk + 1] - chunkIndex[chunk];
+	return records + chunkIndex[chunk];
+}
+
+const LevelCave* LevelFile::findCave(int offsetX)
+{
+	// Caves are saved in order, one per cave period starting with the first
+	if (caves == nullptr || offsetX % header->params.caveFreq != 0) {
+		return nullptr;
+	}
+	int i = offsetX / header->params.caveFreq - 1;
+	if (i < 0 || (Uint32) i >= header->caveCount || caves[i].offsetX != offsetX) {
+		return nullptr;
+	}
+	return &caves[i];
+}
+
+bool LevelFile::write(const char* path, const LevelParams &params)
+{
+	// A level of its own, so the one being played doesn't end up generated all the way through
+	MapBlocks blocks(params.width, params.height, nullptr, params.caveFreq, params.caveWidth, params.openAir, params.openAirLength, params.difficulty, params.levelSeed);
+	std::vector<Uint32> chunkIndex;
+	std::vector<LevelRecord> records;
+	int chunkWidth = blocks.listLevel(chunkIndex, records);
+
+	// Every cave the camera can reach: one each time it crosses a cave period
+	std::vector<LevelCave> caves;
+	for (int offsetX = params.caveFreq; offsetX <= params.width - SCREEN_WIDTH; offsetX += params.caveFreq) {
+		CaveSystem cave(offsetX, params.difficulty, CaveGenerator::getCaveSeed(params.caveSeed, offsetX), (CaveStyle) params.caveStyle);
+		caves.push_back(LevelCave());
+		cave.save(caves.back());
+	}
+
+	LevelHeader header = {};
+	memcpy(header.magic, MAGIC, 4);
+	header.version = VERSION;
+	header.params = params;
+	header.chunkWidth = chunkWidth;
+	header.chunkCount = chunkIndex.size() - 1;
+	header.recordCount = records.size();
+	header.caveCount = caves.size();
+	return writeFile(path, header, chunkIndex, records, caves);
+}
+
+bool LevelFile::writeSeed(const char* path, const LevelParams &params)
+{
+	LevelHeader header = {};
+	memcpy(header.magic, MAGIC, 4);
+	header.version = VERSION;
+	header.params = params;
+	return writeFile(path, header, std::vector<Uint32>(), std::vector<LevelRecord>(), std::vector<LevelCave>());
+}
+
+bool LevelFile::writeFile(const char* path, const LevelHeader &header, const std::vector<Uint32> &chunkIndex, const std::vector<LevelRecord> &records, const std::vector<LevelCave> &caves)
+{
+	// Everything's size is known up front, so the offsets are filled in and the file written front to back
+	LevelHeader out = header;
+	Uint64 end = sizeof(LevelHeader);
+	if (!chunkIndex.empty()) {
+		out.chunkOffset = alignSection(end);
+		end = out.chunkOffset + chunkIndex.size() * sizeof(Uint32);
+		out.recordOffset = alignSection(end);
+		end = out.recordOffset + records.size() * sizeof(LevelRecord);
+		out.caveOffset = alignSection(end);
+	}
+
+	SDL_RWops* rw = SDL_RWFromFile(path, "wb");
+	if (rw == nullptr) {
+		std::cout << "Unable to save level " << path << "! SDL Error: " << SDL_GetError() << std::endl;
+		return false;
+	}
+	static const Uint8 padding[8] = {};
+	Uint64 written = 0;
+	// Pads up to where the section starts, then writes it
+	auto writeSection = [&](Uint64 offset, const void* section, size_t size) {
+		size_t pad = offset - written;
+		bool done = (pad == 0 || SDL_RWwrite(rw, padding, pad, 1) == 1) && (size == 0 || SDL_RWwrite(rw, section, size, 1) == 1);
+		written = offset + size;
+		return done;
+	};
+	bool ok = writeSection(0, &out, sizeof(out));
+	if (ok && !chunkIndex.empty()) {
+		ok = writeSection(out.chunkOffset, chunkIndex.data(), chunkIndex.size() * sizeof(Uint32))
+			&& writeSection(out.recordOffset, records.data(), records.size() * sizeof(LevelRecord))
+			&& writeSection(out.caveOffset, caves.data(), caves.size() * sizeof(LevelCave));
+	}
+	if (SDL_RWclose(rw) != 0 || !ok) {
+		std::cout << "Unable to save level " << path << "! SDL Error: " << SDL_GetError() << std::endl;
+		return false;
+	}
+	return true;
+}
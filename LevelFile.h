@@ -0,0 +1,126 @@
+#ifndef LevelFile_H
+#define LevelFile_H
+
+#include <SDL.h>
+#include "CaveSystem.h"
+#include "MappedFile.h"
+#include <vector>
+
+// Everything a level is generated from. With the same generator version this makes the same level
+// again, so a level can be shared as just this. The walls are here too: the floor runs the whole
+// level and the ceiling has one gap, the open air section.
+struct LevelParams
+{
+	Uint32 generatorVersion;
+	Uint32 levelSeed;		// Hazards and powerups
+	Uint32 caveSeed;
+	Sint32 width;
+	Sint32 height;
+	Sint32 caveFreq;
+	Sint32 caveWidth;
+	Sint32 openAir;			// In wall blocks
+	Sint32 openAirLength;
+	Sint32 difficulty;
+	Uint32 caveStyle;
+};
+
+enum LevelRecordType
+{
+	RECORD_TURRET,
+	RECORD_STALAGMITE,
+	RECORD_STALACTITE,
+	RECORD_HEALTH,
+	RECORD_INF_FIRE,
+	RECORD_INVINCE,
+	RECORD_AUTOFIRE
+};
+
+// A hazard or powerup, in absolute level coordinates
+struct LevelRecord
+{
+	Uint32 type;
+	Sint32 x;
+	Sint32 y;
+	Sint32 width;
+	Sint32 height;
+	Sint32 variant;		// 1 for a floor turret, the shape of a stalag, 1 for an enabled powerup
+};
+
+// One cave, as generated
+struct LevelCave
+{
+	Sint32 offsetX;
+	Uint32 seed;
+	Sint32 pathLength;
+	Uint32 reserved;
+	// A bit per cave block, set if the block is solid
+	Uint8 solid[CaveSystem::CAVE_SYSTEM_HEIGHT][(CaveSystem::CAVE_SYSTEM_WIDTH + 7) / 8];
+	Sint16 pathX[CaveSystem::CAVE_SYSTEM_WIDTH];
+	Sint16 pathY[CaveSystem::CAVE_SYSTEM_WIDTH];
+};
+
+// A level file starts with this header. A full level follows it with the chunk index, the records
+// grouped by chunk, and the caves in order. A header with nothing after it is the short form, and
+// the level is generated from its params when it is played.
+// Like the asset archive, everything is in the writing machine's byte order.
+struct LevelHeader
+{
+	char magic[4];
+	Uint32 version;
+	LevelParams params;
+	Uint32 chunkWidth;
+	Uint32 chunkCount;
+	Uint32 recordCount;
+	Uint32 caveCount;
+	Uint64 chunkOffset;		// chunkCount + 1 record indexes; chunk i's records are [index[i], index[i + 1])
+	Uint64 recordOffset;
+	Uint64 caveOffset;
+};
+
+// Read-only view of a saved level. The file is memory mapped and its records are used in place, so
+// loading a level costs no more than opening it; chunks are turned back into game objects as the
+// camera reaches them, just like generated ones.
+class LevelFile
+{
+public:
+	static const char MAGIC[4];
+	static const Uint32 VERSION = 1;
+	// Bump whenever MapBlocks or CaveSystem make something different from the same params, so levels
+	// saved in the short form from an older build are refused instead of coming out different
+	static const Uint32 GENERATOR_VERSION = 1;
+
+	LevelFile();
+	~LevelFile();
+
+	// Maps the level and checks it. Returns false (and stays closed) if it is missing, bad, has params
+	// the game can't play, or is a short form from another generator version.
+	bool open(const char* path);
+	void close();
+	bool isOpen();
+
+	const LevelParams& getParams();
+	// True for the short form, which has only the params
+	bool isSeedOnly();
+	// Chunk's records, or nullptr (and a count of 0) for a chunk past the end of the level
+	const LevelRecord* getChunk(int chunk, int* count);
+	// The cave for offsetX, or nullptr if the file doesn't have it
+	const LevelCave* findCave(int offsetX);
+
+	// Generates the whole level from params and writes it in one go. Needs the asset cache.
+	static bool write(const char* path, const LevelParams &params);
+	// Writes the short form
+	static bool writeSeed(const char* path, const LevelParams &params);
+	// Why params can't be played, or nullptr if they can
+	static const char* checkParams(const LevelParams &params);
+
+private:
+	MappedFile file;
+	const LevelHeader* header;
+	const Uint32* chunkIndex;
+	const LevelRecord* records;
+	const LevelCave* caves;
+
+	static bool writeFile(const char* path, const LevelHeader &header, const std::vector<Uint32> &chunkIndex, const std::vector<LevelRecord> &records, const std::vector<LevelCave> &caves);
+};
+
+#endif
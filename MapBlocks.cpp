@@ -2,55 +2,34 @@
 #include "Player.h"
 #include "MapBlocks.h"
 #include "missile.h"
+#include "AssetCache.h"
+#include "GameClock.h"
+#include "Screen.h"
+#include "JobSystem.h"
 #include "iostream"
 #include <vector>
-
-SDL_Texture* loadImage(std::string fname, SDL_Renderer *gRenderer) {
-	SDL_Texture* newText = nullptr;
-
-	SDL_Surface* startSurf = IMG_Load(fname.c_str());
-    if(gRenderer == nullptr){
-        return nullptr;
-    }
-	if (startSurf == nullptr) {
-		std::cout << "Unable to load image " << fname << "! SDL Error: " << SDL_GetError() << std::endl;
-		return nullptr;
-	}
-
-	newText = SDL_CreateTextureFromSurface(gRenderer, startSurf);
-	if (newText == nullptr) {
-		std::cout << "Unable to create texture from " << fname << "! SDL Error: " << SDL_GetError() << std::endl;
-	}
-
-	SDL_FreeSurface(startSurf);
-
-	return newText;
-}
+#include <algorithm>
 
 WallBlock::WallBlock(){};
 WallBlock::WallBlock(int num){
     CEILING_ABS_X = num * block_side;
     FLOOR_ABS_X = num * block_side;
     CEILING_ABS_Y = 0;
-    FLOOR_ABS_Y = 720 - WallBlock::block_side;
+    FLOOR_ABS_Y = SCREEN_HEIGHT - WallBlock::block_side;
     CEILING_REL_X = CEILING_ABS_X;
     FLOOR_REL_X = FLOOR_ABS_X;
     CEILING_REL_Y = CEILING_ABS_Y;
     FLOOR_REL_Y = FLOOR_ABS_Y;
 }
 HealthBlock::HealthBlock(){
-    SDL_Renderer *gRenderer= nullptr;
-    HealthBlock(1,1,gRenderer, 5500, 2000, 0, 0);
+    ChunkRandom random(1);
+    HealthBlock(random, 0, 1, 0, 0);
 }
-HealthBlock::HealthBlock(int LEVEL_WIDTH,int LEVEL_HEIGHT, SDL_Renderer *gRenderer, int cave_freq, int cave_width, int openAir, int openAirLength){
+HealthBlock::HealthBlock(ChunkRandom &random, int x, int LEVEL_HEIGHT, int openAir, int openAirLength){
     HEALTH_HEIGHT=20;
     HEALTH_WIDTH=20;
-    HEALTH_ABS_X = rand() % LEVEL_WIDTH;
-    HEALTH_ABS_Y= LEVEL_HEIGHT-600+rand()%500;
-
-    while ((HEALTH_ABS_X - 1280) % cave_freq <= cave_width) {
-        HEALTH_ABS_X = rand() % LEVEL_WIDTH;
-    }
+    HEALTH_ABS_X = x;
+    HEALTH_ABS_Y= LEVEL_HEIGHT-600+random.next(500);
 
     HEALTH_REL_X=HEALTH_ABS_X;
     HEALTH_REL_Y=HEALTH_ABS_Y;
@@ -63,20 +42,27 @@ HealthBlock::HealthBlock(int LEVEL_WIDTH,int LEVEL_HEIGHT, SDL_Renderer *gRender
 
 
 }
+HealthBlock::HealthBlock(const LevelRecord &record){
+    HEALTH_HEIGHT=record.height;
+    HEALTH_WIDTH=record.width;
+    HEALTH_ABS_X=record.x;
+    HEALTH_ABS_Y=record.y;
+
+    HEALTH_REL_X=HEALTH_ABS_X;
+    HEALTH_REL_Y=HEALTH_ABS_Y;
+
+    enabled=record.variant==1;
+}
 
 InfFireBlock::InfFireBlock(){
-    SDL_Renderer *gRenderer= nullptr;
-    InfFireBlock(1,1,gRenderer, 5500, 2000, 0, 0);
+    ChunkRandom random(1);
+    InfFireBlock(random, 0, 1, 0, 0);
 }
-InfFireBlock::InfFireBlock(int LEVEL_WIDTH,int LEVEL_HEIGHT, SDL_Renderer *gRenderer, int cave_freq, int cave_width, int openAir, int openAirLength){
+InfFireBlock::InfFireBlock(ChunkRandom &random, int x, int LEVEL_HEIGHT, int openAir, int openAirLength){
     INF_FIRE_HEIGHT=35;
     INF_FIRE_WIDTH=35;
-    INF_FIRE_ABS_X = rand() % LEVEL_WIDTH;
-    INF_FIRE_ABS_Y= LEVEL_HEIGHT-600+rand()%500;
-
-    while ((INF_FIRE_ABS_X - 1280) % cave_freq <= cave_width) {
-        INF_FIRE_ABS_X = rand() % LEVEL_WIDTH;
-    }
+    INF_FIRE_ABS_X = x;
+    INF_FIRE_ABS_Y= LEVEL_HEIGHT-600+random.next(500);
 
     INF_FIRE_REL_X=INF_FIRE_ABS_X;
     INF_FIRE_REL_Y=INF_FIRE_ABS_Y;
@@ -87,20 +73,27 @@ InfFireBlock::InfFireBlock(int LEVEL_WIDTH,int LEVEL_HEIGHT, SDL_Renderer *gRend
         enabled=true;
     }
 }
+InfFireBlock::InfFireBlock(const LevelRecord &record){
+    INF_FIRE_HEIGHT=record.height;
+    INF_FIRE_WIDTH=record.width;
+    INF_FIRE_ABS_X=record.x;
+    INF_FIRE_ABS_Y=record.y;
+
+    INF_FIRE_REL_X=INF_FIRE_ABS_X;
+    INF_FIRE_REL_Y=INF_FIRE_ABS_Y;
+
+    enabled=record.variant==1;
+}
 
 AutoFireBlock::AutoFireBlock(){
-    SDL_Renderer *gRenderer= nullptr;
-    AutoFireBlock(1,1,gRenderer, 5500, 2000, 0, 0);
+    ChunkRandom random(1);
+    AutoFireBlock(random, 0, 1, 0, 0);
 }
-AutoFireBlock::AutoFireBlock(int LEVEL_WIDTH,int LEVEL_HEIGHT, SDL_Renderer *gRenderer, int cave_freq, int cave_width, int openAir, int openAirLength){
+AutoFireBlock::AutoFireBlock(ChunkRandom &random, int x, int LEVEL_HEIGHT, int openAir, int openAirLength){
     AUTOFIRE_HEIGHT=35;
     AUTOFIRE_WIDTH=35;
-    AUTOFIRE_ABS_X = rand() % LEVEL_WIDTH;
-    AUTOFIRE_ABS_Y= LEVEL_HEIGHT-600+rand()%500;
-
-    while ((AUTOFIRE_ABS_X - 1280) % cave_freq <= cave_width) {
-        AUTOFIRE_ABS_X = rand() % LEVEL_WIDTH;
-    }
+    AUTOFIRE_ABS_X = x;
+    AUTOFIRE_ABS_Y= LEVEL_HEIGHT-600+random.next(500);
 
     AUTOFIRE_REL_X=AUTOFIRE_ABS_X;
     AUTOFIRE_REL_Y=AUTOFIRE_ABS_Y;
@@ -111,20 +104,27 @@ AutoFireBlock::AutoFireBlock(int LEVEL_WIDTH,int LEVEL_HEIGHT, SDL_Renderer *gRe
         enabled=true;
     }
 }
+AutoFireBlock::AutoFireBlock(const LevelRecord &record){
+    AUTOFIRE_HEIGHT=record.height;
+    AUTOFIRE_WIDTH=record.width;
+    AUTOFIRE_ABS_X=record.x;
+    AUTOFIRE_ABS_Y=record.y;
+
+    AUTOFIRE_REL_X=AUTOFIRE_ABS_X;
+    AUTOFIRE_REL_Y=AUTOFIRE_ABS_Y;
+
+    enabled=record.variant==1;
+}
 
 InvincBlock::InvincBlock(){
-    SDL_Renderer *gRenderer= nullptr;
-    InvincBlock(1,1,gRenderer, 5500, 2000, 0, 0);
+    ChunkRandom random(1);
+    InvincBlock(random, 0, 1, 0, 0);
 }
-InvincBlock::InvincBlock(int LEVEL_WIDTH,int LEVEL_HEIGHT, SDL_Renderer *gRenderer, int cave_freq, int cave_width, int openAir, int openAirLength){
+InvincBlock::InvincBlock(ChunkRandom &random, int x, int LEVEL_HEIGHT, int openAir, int openAirLength){
     INVINCE_HEIGHT=35;
     INVINCE_WIDTH=35;
-    INVINCE_ABS_X = rand() % LEVEL_WIDTH;
-    INVINCE_ABS_Y= LEVEL_HEIGHT-600+rand()%500;
-
-    while ((INVINCE_ABS_X - 1280) % cave_freq <= cave_width) {
-        INVINCE_ABS_X = rand() % LEVEL_WIDTH;
-    }
+    INVINCE_ABS_X = x;
+    INVINCE_ABS_Y= LEVEL_HEIGHT-600+random.next(500);
 
     INVINCE_REL_X=INVINCE_ABS_X;
     INVINCE_REL_Y=INVINCE_ABS_Y;
@@ -135,57 +135,92 @@ InvincBlock::InvincBlock(int LEVEL_WIDTH,int LEVEL_HEIGHT, SDL_Renderer *gRender
         enabled=true;
     }
 }
+InvincBlock::InvincBlock(const LevelRecord &record){
+    INVINCE_HEIGHT=record.height;
+    INVINCE_WIDTH=record.width;
+    INVINCE_ABS_X=record.x;
+    INVINCE_ABS_Y=record.y;
+
+    INVINCE_REL_X=INVINCE_ABS_X;
+    INVINCE_REL_Y=INVINCE_ABS_Y;
+
+    enabled=record.variant==1;
+}
 
 Stalagmite::Stalagmite()
 {
-    SDL_Renderer *gRenderer= nullptr;
-    Stalagmite(1,1,gRenderer, 5500, 2000, 0, 0);
+    ChunkRandom random(1);
+    Stalagmite(random, 0, 1);
 }
-Stalagmite::Stalagmite(int LEVEL_WIDTH, int LEVEL_HEIGHT, SDL_Renderer *gRenderer, int cave_freq, int cave_width, int openAir, int openAirLength)
+Stalagmite::Stalagmite(ChunkRandom &random, int x, int LEVEL_HEIGHT)
 {
-    STALAG_WIDTH = rand() % 16 + 60;
-    STALAG_HEIGHT = rand() % 141 + 50;
+    STALAG_WIDTH = random.next(16) + 60;
+    STALAG_HEIGHT = random.next(141) + 50;
     hitboxWidth = STALAG_WIDTH / 2;
 
-    STALAG_ABS_X = rand() % LEVEL_WIDTH;
+    STALAG_ABS_X = x;
     STALAG_ABS_Y = LEVEL_HEIGHT - WallBlock::block_side - STALAG_HEIGHT;//growing from bottom of cave
-	// Select a new x coordinate if the current one is in a cave or open air section
-	while ((STALAG_ABS_X - 1280) % cave_freq <= cave_width || (STALAG_ABS_X>(openAir*72) && STALAG_ABS_X+STALAG_WIDTH<(openAir+openAirLength)*72)) {
-		STALAG_ABS_X = rand() % LEVEL_WIDTH;
-	}
-    //STALAG_ABS_Y= rand() % LEVEL_HEIGHT;
 
     STALAG_REL_X = STALAG_ABS_X;
     STALAG_REL_Y = STALAG_ABS_Y;
     alreadyExploded = 0;
 
-    stalagShapeNum = rand() % 4 + 1;
+    stalagShapeNum = random.next(4) + 1;
+}
+
+Stalagmite::Stalagmite(const LevelRecord &record)
+{
+    STALAG_WIDTH = record.width;
+    STALAG_HEIGHT = record.height;
+    hitboxWidth = STALAG_WIDTH / 2;
+
+    STALAG_ABS_X = record.x;
+    STALAG_ABS_Y = record.y;
+
+    STALAG_REL_X = STALAG_ABS_X;
+    STALAG_REL_Y = STALAG_ABS_Y;
+    alreadyExploded = 0;
+
+    stalagShapeNum = record.variant;
 }
 
 Stalagtite::Stalagtite()
 {
-    SDL_Renderer *gRenderer= nullptr;
-    Stalagtite(1,1,gRenderer, 5500, 2000, 0, 0);
+    ChunkRandom random(1);
+    Stalagtite(random, 0, 1);
 }
-Stalagtite::Stalagtite(int LEVEL_WIDTH, int LEVEL_HEIGHT, SDL_Renderer *gRenderer, int cave_freq, int cave_width, int openAir, int openAirLength)
+Stalagtite::Stalagtite(ChunkRandom &random, int x, int LEVEL_HEIGHT)
 {
-    STALAG_WIDTH = rand() % 16 + 60;
-    STALAG_HEIGHT = rand() % 141 + 50;
+    STALAG_WIDTH = random.next(16) + 60;
+    STALAG_HEIGHT = random.next(141) + 50;
     hitboxWidth = STALAG_WIDTH / 2;
 
-    STALAG_ABS_X = rand() % LEVEL_WIDTH;
+    STALAG_ABS_X = x;
 
-    STALAG_ABS_Y = LEVEL_HEIGHT - 720 + WallBlock::block_side;//growing from top of cave
-	// Select a new x coordinate if the current one is in a cave or open air section
-	while ((STALAG_ABS_X - 1280) % cave_freq <= cave_width || (STALAG_ABS_X>(openAir*72) && STALAG_ABS_X+STALAG_WIDTH<(openAir+openAirLength)*72)) {
-		STALAG_ABS_X = rand() % LEVEL_WIDTH;
-	}
-    //STALAG_ABS_Y= rand() % LEVEL_HEIGHT;
+    STALAG_ABS_Y = LEVEL_HEIGHT - SCREEN_HEIGHT + WallBlock::block_side;//growing from top of cave
 
     STALAG_REL_X = STALAG_ABS_X;
     STALAG_REL_Y = STALAG_ABS_Y;
 
-    stalagShapeNum = rand() % 4 + 1;
+    stalagShapeNum = random.next(4) + 1;
+
+    beenShot = 0;
+    acceleration = 0;
+}
+
+Stalagtite::Stalagtite(const LevelRecord &record)
+{
+    STALAG_WIDTH = record.width;
+    STALAG_HEIGHT = record.height;
+    hitboxWidth = STALAG_WIDTH / 2;
+
+    STALAG_ABS_X = record.x;
+    STALAG_ABS_Y = record.y;
+
+    STALAG_REL_X = STALAG_ABS_X;
+    STALAG_REL_Y = STALAG_ABS_Y;
+
+    stalagShapeNum = record.variant;
 
     beenShot = 0;
     acceleration = 0;
@@ -196,83 +231,68 @@ Turret::Turret()
     SDL_Renderer *gRenderer= nullptr;
     SDL_Texture *tex1 = nullptr;
     SDL_Texture *tex2 = nullptr;
-    Turret(1, 1, gRenderer, 5500, 2000, 0, 0, tex1, tex2);
+    Turret(0, false, 1, gRenderer, tex1, tex2);
 }
 
-Turret::Turret(int LEVEL_WIDTH, int LEVEL_HEIGHT, SDL_Renderer *gRenderer, int cave_freq, int cave_width, int openAir, int openAirLength, SDL_Texture* mSprite1, SDL_Texture* mSprite2) :
+Turret::Turret(int x, bool onFloor, int LEVEL_HEIGHT, SDL_Renderer *gRenderer, SDL_Texture* mSprite1, SDL_Texture* mSprite2) :
     gRenderer{ gRenderer }
 {
-    BLOCK_ABS_X = rand() % LEVEL_WIDTH;
-	BLOCK_ABS_Y = LEVEL_HEIGHT - WallBlock::block_side - Turret::BLOCK_HEIGHT;
-	if (rand() % 2 == 1) {
-		BLOCK_ABS_Y = LEVEL_HEIGHT - 720 + WallBlock::block_side;
+    //Standard Enemy plane size
+    BLOCK_WIDTH = TURRET_SIZE;
+    BLOCK_HEIGHT = TURRET_SIZE;
+
+    BLOCK_ABS_X = x;
+	if (onFloor) {
+		BLOCK_ABS_Y = LEVEL_HEIGHT - WallBlock::block_side - BLOCK_HEIGHT;
 	}
-	while ((BLOCK_ABS_X - 1280) % cave_freq <= cave_width || (BLOCK_ABS_X>(openAir*72) && BLOCK_ABS_X+BLOCK_WIDTH<(openAir+openAirLength)*72 && BLOCK_ABS_Y==LEVEL_HEIGHT -720 + WallBlock::block_side)) {
-		BLOCK_ABS_X = rand() % LEVEL_WIDTH;
+	else {
+		BLOCK_ABS_Y = LEVEL_HEIGHT - SCREEN_HEIGHT + WallBlock::block_side;
 	}
 
     // These should be the same first
     BLOCK_REL_X = BLOCK_ABS_X;
     BLOCK_REL_Y = BLOCK_ABS_Y;
 
-    // BLOCK_WIDTH = 25 + (rand() % 100);
-    // BLOCK_HEIGHT = 25 + (rand() % 100);
-    //Standard Enemy plane size
-    BLOCK_WIDTH = 50;
-    BLOCK_HEIGHT = 50;
     missileSprite1 = mSprite1;
     missileSprite2 = mSprite2;
 
     // Select the ceiling or floor turret sprite
-	bottom = 0;
-    if(BLOCK_ABS_Y == LEVEL_HEIGHT - WallBlock::block_side - Turret::BLOCK_HEIGHT){
-        bottom = 1;
-    }
+	bottom = onFloor ? 1 : 0;
 
     FB_sprite = { BLOCK_ABS_X,  BLOCK_ABS_Y, BLOCK_WIDTH, BLOCK_HEIGHT};
     FB_hitbox = FB_sprite;
 
-	last_move = SDL_GetTicks();
+	last_move = GameClock::getTicks();
+	id = -1;
+	armed = false;
 }
 
+constexpr float Turret::HOMING_TURN_RATE;
+constexpr float Turret::HOMING_FUEL;
+
 int Turret::getRelX() { return BLOCK_REL_X; }
 int Turret::getRelY() { return BLOCK_REL_Y; }
 int Turret::getAbsX() { return BLOCK_ABS_X; }
 int Turret::getAbsY() { return BLOCK_ABS_Y; }
 
-Missile * Turret::handleFiring(int posX, int posY) {
-    int damage = 500;
-    int blast_radius = 150;
-
-	time_since_move = SDL_GetTicks() - last_move;
-	Missile * m = nullptr;
-	if (time_since_move >= SHOOT_FREQ) {
-		last_move = SDL_GetTicks();
-		int xDist = posX - BLOCK_REL_X;
-		int yDist = posY - BLOCK_REL_Y;
-		double math = (double)xDist / sqrt(xDist * xDist + yDist * yDist) * 400;
-		double math2 = ((double)yDist / sqrt(xDist * xDist + yDist * yDist)) * 400;
-		if (BLOCK_REL_Y >= posY){
-            int missType = rand()%5;//1 in 5 chance of missile being red
-            if(missType < 4){
-		        m = new Missile(damage, blast_radius, BLOCK_REL_X + BLOCK_WIDTH / 2, BLOCK_REL_Y - 20, ((double)xDist / sqrt(xDist * xDist + yDist * yDist)) * 400, ((double)yDist / sqrt(xDist * xDist + yDist * yDist)) * 400, missileSprite1, gRenderer);
-	        }
-	        else{
-                m = new Missile(damage, blast_radius, BLOCK_REL_X + BLOCK_WIDTH / 2, BLOCK_REL_Y - 20, ((double)xDist / sqrt(xDist * xDist + yDist * yDist)) * 400, ((double)yDist / sqrt(xDist * xDist + yDist * yDist)) * 400, missileSprite2, gRenderer);
-	        }
-		}
-		else {
-            int missType = rand()%5;//1 in 5 chance of missile being red
-	        SDL_Texture* missSprite;
-            if(missType < 4){
-		        m = new Missile(damage, blast_radius, BLOCK_REL_X + BLOCK_WIDTH / 2, BLOCK_REL_Y + 5 + BLOCK_HEIGHT, ((double)xDist / sqrt(xDist * xDist + yDist * yDist)) * 400, ((double)yDist / sqrt(xDist * xDist + yDist * yDist)) * 400, missileSprite1, gRenderer);
-	        }
-	        else{
-		        m = new Missile(damage, blast_radius, BLOCK_REL_X + BLOCK_WIDTH / 2, BLOCK_REL_Y + 5 + BLOCK_HEIGHT, ((double)xDist / sqrt(xDist * xDist + yDist * yDist)) * 400, ((double)yDist / sqrt(xDist * xDist + yDist * yDist)) * 400, missileSprite2, gRenderer);
-	        }
-		}
+bool Turret::isOnScreen() {
+	return BLOCK_REL_X > 0 && BLOCK_REL_Y > 0 && BLOCK_REL_X <= SCREEN_WIDTH && BLOCK_REL_Y <= SCREEN_HEIGHT;
+}
+
+void Turret::getMuzzle(int posY, int &x, int &y) {
+	x = BLOCK_REL_X + BLOCK_WIDTH / 2;
+	if (BLOCK_REL_Y >= posY) {
+		y = BLOCK_REL_Y - 20;
+	}
+	else {
+		y = BLOCK_REL_Y + 5 + BLOCK_HEIGHT;
 	}
-	return m;
+}
+
+Missile * Turret::fire(int x, int y, double xVel, double yVel) {
+	last_move = GameClock::getTicks();
+	int missType = rand()%5;//1 in 5 chance of missile being red
+	return new Missile(MISSILE_DAMAGE, MISSILE_BLAST_RADIUS, x, y, xVel, yVel, missType < 4 ? missileSprite1 : missileSprite2, gRenderer);
 }
 
 Explosion::Explosion()
@@ -289,37 +309,38 @@ Explosion::Explosion(int x_loc, int y_loc, int t, SDL_Renderer *gRenderer)
 	center_y = y_loc;
 	abs_x = center_x - current_size / 2;
 	abs_y = center_y - current_size / 2;
-	explosion_time = SDL_GetTicks();
     type = t;
+	animation = Animator::play(type == 0 ? ANIM_EXPLOSION : ANIM_DUST_CLOUD);
 }
 
 MapBlocks::MapBlocks()
 {
     gRenderer= nullptr;
-    MapBlocks(1, 1, gRenderer = nullptr, 5500, 2000, 0,0, 1);
+    MapBlocks(1, 1, gRenderer = nullptr, 5500, 2000, 0,0, 1, 0);
 }
 
-MapBlocks::MapBlocks(int LEVEL_WIDTH, int LEVEL_HEIGHT, SDL_Renderer *gr, int cave_freq, int cave_width, int openAir, int openAirLength, int diff)
+MapBlocks::MapBlocks(int LEVEL_WIDTH, int LEVEL_HEIGHT, SDL_Renderer *gr, int cave_freq, int cave_width, int openAir, int openAirLength, int diff, Uint32 seed, bool endless, LevelFile *level) :
+    endless{endless}, levelSeed{seed}, levelWidth{LEVEL_WIDTH}, levelHeight{LEVEL_HEIGHT}, caveFreq{cave_freq}, caveWidth{cave_width}, openAir{openAir}, openAirLength{openAirLength}, level{level}
 {
 	gRenderer = gr;
-	explosionSprite = loadImage("sprites/Explosion.png", gRenderer);
-    dustCloudSprite = loadImage("sprites/dustCloud.png", gRenderer);
-	topTurretSprite = loadImage("sprites/topturret.png", gRenderer);
-	bottomTurretSprite = loadImage("sprites/bottomturret.png", gRenderer);
-	stalactiteSprite1 = loadImage("sprites/stalagt1.png", gRenderer);
-	stalactiteSprite2 = loadImage("sprites/stalagt2.png", gRenderer);
-	stalactiteSprite3 = loadImage("sprites/stalagt3.png", gRenderer);
-	stalactiteSprite4 = loadImage("sprites/stalagt4.png", gRenderer);
-	stalagmiteSprite1 = loadImage("sprites/stalagm1.png", gRenderer);
-	stalagmiteSprite2 = loadImage("sprites/stalagm2.png", gRenderer);
-	stalagmiteSprite3 = loadImage("sprites/stalagm3.png", gRenderer);
-	stalagmiteSprite4 = loadImage("sprites/stalagm4.png", gRenderer);
-    healthSprite=loadImage("sprites/health.png", gRenderer);
-    mSprite1=loadImage("sprites/missile.png", gRenderer);
-    mSprite2=loadImage("sprites/missile2.png", gRenderer);
-    infFireSprite=loadImage("sprites/infFire.png", gRenderer);
-    invinceSprite=loadImage("sprites/invince.png", gRenderer);
-    autofireSprite=loadImage("sprites/autofire.png", gRenderer);
+	gAssets->acquireAnimation(ANIM_EXPLOSION);
+	gAssets->acquireAnimation(ANIM_DUST_CLOUD);
+	topTurretSprite = gAssets->acquire(ASSET_TOP_TURRET);
+	bottomTurretSprite = gAssets->acquire(ASSET_BOTTOM_TURRET);
+	stalactiteSprite1 = gAssets->acquire(ASSET_STALACTITE_1);
+	stalactiteSprite2 = gAssets->acquire(ASSET_STALACTITE_2);
+	stalactiteSprite3 = gAssets->acquire(ASSET_STALACTITE_3);
+	stalactiteSprite4 = gAssets->acquire(ASSET_STALACTITE_4);
+	stalagmiteSprite1 = gAssets->acquire(ASSET_STALAGMITE_1);
+	stalagmiteSprite2 = gAssets->acquire(ASSET_STALAGMITE_2);
+	stalagmiteSprite3 = gAssets->acquire(ASSET_STALAGMITE_3);
+	stalagmiteSprite4 = gAssets->acquire(ASSET_STALAGMITE_4);
+    healthSprite=gAssets->acquire(ASSET_HEALTH);
+    mSprite1=gAssets->acquire(ASSET_MISSILE_1);
+    mSprite2=gAssets->acquire(ASSET_MISSILE_2);
+    infFireSprite=gAssets->acquire(ASSET_INF_FIRE);
+    invinceSprite=gAssets->acquire(ASSET_INVINCE);
+    autofireSprite=gAssets->acquire(ASSET_AUTOFIRE);
 
 
     if(diff == 3){
@@ -346,71 +367,267 @@ MapBlocks::MapBlocks(int LEVEL_WIDTH, int LEVEL_HEIGHT, SDL_Renderer *gr, int ca
 
     }
 
+    nextTurretId = 0;
+    homingMissiles = diff == 3;
+    chunkWidth = cave_freq;
+    nextChunk = 0;
+    discardedChunk = 0;
+    streamChunks(0);
+}
+
+void MapBlocks::streamChunks(int camX)
+{
+    // Keep the chunk past the right edge of the screen ready too, so nothing appears at the last moment
+    while ((endless || nextChunk * chunkWidth < levelWidth) && nextChunk * chunkWidth < camX + SCREEN_WIDTH + chunkWidth) {
+        generateChunk(nextChunk);
+        nextChunk++;
+    }
+
+    // Clear out what has gone off the left of the screen every time another chunk has scrolled past
+    int behind = (camX - DISCARD_MARGIN) / chunkWidth;
+    if (behind > discardedChunk) {
+        discardedChunk = behind;
+        discardBefore(camX - DISCARD_MARGIN);
+    }
+}
+
+void MapBlocks::generateChunk(int chunk)
+{
+    int chunkX = chunk * chunkWidth;
+    int width = chunkWidth;
+    if (!endless && chunkX + width > levelWidth) {
+        width = levelWidth - chunkX;
+    }
+    ChunkRandom random(levelSeed ^ (Uint32) chunk);
+
+    // In endless mode there are more hazards and fewer powerups the further the player gets
+    int hazardPercent = 100;
+    if (endless) {
+        hazardPercent += (int) ((double) ENDLESS_HAZARD_GROWTH * chunkX / levelWidth);
+    }
+    int powerupPercent = 100 * 100 / hazardPercent;
+
     int i;
-    for(i = 0; i<CEILING_N; i++){
+    int columns = levelWidth / WallBlock::block_side;
+    for (i = (chunkX + WallBlock::block_side - 1) / WallBlock::block_side; i * WallBlock::block_side < chunkX + width; i++) {
         // Create blocks on the top of the screen if it isn't an open air section
-		if(!(i>openAir && i<openAir+openAirLength && openAir+openAirLength<CEILING_N)){
+		if(!(i>openAir && i<openAir+openAirLength && openAir+openAirLength<columns)){
 			ceiling_arr.push_back(WallBlock(i));
         }
 		// Create blocks on the bottom of the screen
         floor_arr.push_back(WallBlock(i));
     }
 
-    for (i = 0; i < BLOCKS_N; i++)
-    {
-        blocks_arr.push_back(Turret(LEVEL_WIDTH, LEVEL_HEIGHT, gRenderer, cave_freq, cave_width, openAir, openAirLength, mSprite1, mSprite2)); // Initiating each Turret
+    // A saved level has everything else placed already
+    if (level != nullptr) {
+        int count;
+        const LevelRecord* saved = level->getChunk(chunk, &count);
+        if (saved != nullptr) {
+            for (i = 0; i < count; i++) {
+                addRecord(saved[i]);
+            }
+            return;
+        }
     }
 
-    for (i=0; i < HEALTH_N; i++)
+    // Where things can go: anywhere outside of caves (nothing starts in the first screen either), and
+    // for things that need a ceiling or shouldn't be left floating in open air, outside of that too
+    PlacementSampler open(chunkX, chunkX + width);
+    open.exclude(chunkX, SCREEN_WIDTH);
+    open.excludeRepeating(SCREEN_WIDTH, caveWidth + 1, caveFreq);
+    PlacementSampler covered = open;
+    covered.exclude(openAir * WallBlock::block_side, (openAir + openAirLength) * WallBlock::block_side);
+
+    // Hazards go first and keep their distance from each other on the ceiling and floor alike
+    int count = chunkCount(random, BLOCKS_N, width, hazardPercent);
+    for (i = 0; i < count; i++)
     {
-        health_arr.push_back(HealthBlock(LEVEL_WIDTH, LEVEL_HEIGHT, gRenderer, cave_freq, cave_width, openAir, openAirLength));//Initiate the healthblocks
+        bool onFloor = random.next(2) == 0;
+        int x = onFloor ? open.sample(random, Turret::TURRET_SIZE) : covered.sample(random, Turret::TURRET_SIZE);
+        if (x >= 0) {
+            blocks_arr.push_back(Turret(x, onFloor, levelHeight, gRenderer, mSprite1, mSprite2));
+            blocks_arr.back().id = nextTurretId++;
+            open.claim(x, Turret::TURRET_SIZE, HAZARD_SPACING);
+            covered.claim(x, Turret::TURRET_SIZE, HAZARD_SPACING);
+        }
     }
 
-    for (i=0; i < INF_FIRE_N; i++)
+    count = chunkCount(random, STALAG_N, width, hazardPercent);
+    for (i = 0; i < count; i++)
     {
-        infFire_arr.push_back(InfFireBlock(LEVEL_WIDTH, LEVEL_HEIGHT, gRenderer, cave_freq, cave_width, openAir, openAirLength));//Initiate the shooting powerup
+        int x = covered.sample(random, Stalagmite::MAX_WIDTH);
+        if (x >= 0) {
+            stalagm_arr.push_back(Stalagmite(random, x, levelHeight));
+            open.claim(x, Stalagmite::MAX_WIDTH, HAZARD_SPACING);
+            covered.claim(x, Stalagmite::MAX_WIDTH, HAZARD_SPACING);
+        }
+    }
+    count = chunkCount(random, STALAG_N, width, hazardPercent);
+    for (i = 0; i < count; i++)
+    {
+        int x = covered.sample(random, Stalagtite::MAX_WIDTH);
+        if (x >= 0) {
+            stalagt_arr.push_back(Stalagtite(random, x, levelHeight));
+            open.claim(x, Stalagtite::MAX_WIDTH, HAZARD_SPACING);
+            covered.claim(x, Stalagtite::MAX_WIDTH, HAZARD_SPACING);
+        }
     }
 
-    for (i=0; i < INVINCE_N; i++)
+    // Powerups fill in the gaps
+    count = chunkCount(random, HEALTH_N, width, powerupPercent);
+    for (i = 0; i < count; i++)
     {
-        invince_arr.push_back(InvincBlock(LEVEL_WIDTH, LEVEL_HEIGHT, gRenderer, cave_freq, cave_width, openAir, openAirLength));//Initiate the invincibility
+        int x = open.sample(random, 20);
+        if (x >= 0) {
+            health_arr.push_back(HealthBlock(random, x, levelHeight, openAir, openAirLength));
+            open.claim(x, health_arr.back().HEALTH_WIDTH, POWERUP_SPACING);
+        }
     }
 
-    for (i=0; i < AUTOFIRE_N; i++)
+    count = chunkCount(random, INF_FIRE_N, width, powerupPercent);
+    for (i = 0; i < count; i++)
     {
-        autofire_arr.push_back(AutoFireBlock(LEVEL_WIDTH, LEVEL_HEIGHT, gRenderer, cave_freq, cave_width, openAir, openAirLength));//Initiate the shooting powerup
+        int x = open.sample(random, 35);
+        if (x >= 0) {
+            infFire_arr.push_back(InfFireBlock(random, x, levelHeight, openAir, openAirLength));
+            open.claim(x, infFire_arr.back().INF_FIRE_WIDTH, POWERUP_SPACING);
+        }
     }
 
-    for (i=0; i < STALAG_N; i++)
+    count = chunkCount(random, INVINCE_N, width, powerupPercent);
+    for (i = 0; i < count; i++)
     {
-        stalagm_arr.push_back(Stalagmite(LEVEL_WIDTH, LEVEL_HEIGHT, gRenderer, cave_freq, cave_width, openAir, openAirLength));//Initiate the stalagmites
+        int x = open.sample(random, 35);
+        if (x >= 0) {
+            invince_arr.push_back(InvincBlock(random, x, levelHeight, openAir, openAirLength));
+            open.claim(x, invince_arr.back().INVINCE_WIDTH, POWERUP_SPACING);
+        }
     }
-    for (i=0; i < STALAG_N; i++)
+
+    count = chunkCount(random, AUTOFIRE_N, width, powerupPercent);
+    for (i = 0; i < count; i++)
     {
-        stalagt_arr.push_back(Stalagtite(LEVEL_WIDTH, LEVEL_HEIGHT, gRenderer, cave_freq, cave_width, openAir, openAirLength));//Initiate the stalagtites
+        int x = open.sample(random, 35);
+        if (x >= 0) {
+            autofire_arr.push_back(AutoFireBlock(random, x, levelHeight, openAir, openAirLength));
+            open.claim(x, autofire_arr.back().AUTOFIRE_WIDTH, POWERUP_SPACING);
+        }
     }
 }
 
+void MapBlocks::discardBefore(int x)
+{
+    blocks_arr.erase(std::remove_if(blocks_arr.begin(), blocks_arr.end(), [x](const Turret &t) { return t.BLOCK_ABS_X + t.BLOCK_WIDTH < x; }), blocks_arr.end());
+    stalagm_arr.erase(std::remove_if(stalagm_arr.begin(), stalagm_arr.end(), [x](const Stalagmite &s) { return s.STALAG_ABS_X + s.STALAG_WIDTH < x; }), stalagm_arr.end());
+    stalagt_arr.erase(std::remove_if(stalagt_arr.begin(), stalagt_arr.end(), [x](const Stalagtite &s) { return s.STALAG_ABS_X + s.STALAG_WIDTH < x; }), stalagt_arr.end());
+    ceiling_arr.erase(std::remove_if(ceiling_arr.begin(), ceiling_arr.end(), [x](const WallBlock &w) { return w.CEILING_ABS_X + WallBlock::block_side < x; }), ceiling_arr.end());
+    floor_arr.erase(std::remove_if(floor_arr.begin(), floor_arr.end(), [x](const WallBlock &w) { return w.FLOOR_ABS_X + WallBlock::block_side < x; }), floor_arr.end());
+    health_arr.erase(std::remove_if(health_arr.begin(), health_arr.end(), [x](const HealthBlock &h) { return h.HEALTH_ABS_X + h.HEALTH_WIDTH < x; }), health_arr.end());
+    infFire_arr.erase(std::remove_if(infFire_arr.begin(), infFire_arr.end(), [x](const InfFireBlock &p) { return p.INF_FIRE_ABS_X + p.INF_FIRE_WIDTH < x; }), infFire_arr.end());
+    invince_arr.erase(std::remove_if(invince_arr.begin(), invince_arr.end(), [x](const InvincBlock &p) { return p.INVINCE_ABS_X + p.INVINCE_WIDTH < x; }), invince_arr.end());
+    autofire_arr.erase(std::remove_if(autofire_arr.begin(), autofire_arr.end(), [x](const AutoFireBlock &p) { return p.AUTOFIRE_ABS_X + p.AUTOFIRE_WIDTH < x; }), autofire_arr.end());
+}
+
+void MapBlocks::addRecord(const LevelRecord &record)
+{
+    switch (record.type) {
+        case RECORD_TURRET:
+            blocks_arr.push_back(Turret(record.x, record.variant == 1, levelHeight, gRenderer, mSprite1, mSprite2));
+            blocks_arr.back().id = nextTurretId++;
+            break;
+        case RECORD_STALAGMITE:
+            stalagm_arr.push_back(Stalagmite(record));
+            break;
+        case RECORD_STALACTITE:
+            stalagt_arr.push_back(Stalagtite(record));
+            break;
+        case RECORD_HEALTH:
+            health_arr.push_back(HealthBlock(record));
+            break;
+        case RECORD_INF_FIRE:
+            infFire_arr.push_back(InfFireBlock(record));
+            break;
+        case RECORD_INVINCE:
+            invince_arr.push_back(InvincBlock(record));
+            break;
+        case RECORD_AUTOFIRE:
+            autofire_arr.push_back(AutoFireBlock(record));
+            break;
+        default:
+            break;
+    }
+}
+
+int MapBlocks::listLevel(std::vector<Uint32> &chunkIndex, std::vector<LevelRecord> &records)
+{
+    while (nextChunk * chunkWidth < levelWidth) {
+        generateChunk(nextChunk);
+        nextChunk++;
+    }
+
+    // Everything is placed inside the chunk it was generated for
+    for (int chunk = 0; chunk < nextChunk; chunk++) {
+        int from = chunk * chunkWidth;
+        int to = from + chunkWidth;
+        auto inChunk = [from, to](int x) { return x >= from && x < to; };
+        chunkIndex.push_back(records.size());
+        for (Turret &t : blocks_arr)
+            if (inChunk(t.BLOCK_ABS_X))
+                records.push_back({RECORD_TURRET, t.BLOCK_ABS_X, t.BLOCK_ABS_Y, t.BLOCK_WIDTH, t.BLOCK_HEIGHT, t.bottom});
+        for (Stalagmite &s : stalagm_arr)
+            if (inChunk(s.STALAG_ABS_X))
+                records.push_back({RECORD_STALAGMITE, s.STALAG_ABS_X, s.STALAG_ABS_Y, s.STALAG_WIDTH, s.STALAG_HEIGHT, s.stalagShapeNum});
+        for (Stalagtite &s : stalagt_arr)
+            if (inChunk(s.STALAG_ABS_X))
+                records.push_back({RECORD_STALACTITE, s.STALAG_ABS_X, s.STALAG_ABS_Y, s.STALAG_WIDTH, s.STALAG_HEIGHT, s.stalagShapeNum});
+        for (HealthBlock &p : health_arr)
+            if (inChunk(p.HEALTH_ABS_X))
+                records.push_back({RECORD_HEALTH, p.HEALTH_ABS_X, p.HEALTH_ABS_Y, p.HEALTH_WIDTH, p.HEALTH_HEIGHT, p.enabled});
+        for (InfFireBlock &p : infFire_arr)
+            if (inChunk(p.INF_FIRE_ABS_X))
+                records.push_back({RECORD_INF_FIRE, p.INF_FIRE_ABS_X, p.INF_FIRE_ABS_Y, p.INF_FIRE_WIDTH, p.INF_FIRE_HEIGHT, p.enabled});
+        for (InvincBlock &p : invince_arr)
+            if (inChunk(p.INVINCE_ABS_X))
+                records.push_back({RECORD_INVINCE, p.INVINCE_ABS_X, p.INVINCE_ABS_Y, p.INVINCE_WIDTH, p.INVINCE_HEIGHT, p.enabled});
+        for (AutoFireBlock &p : autofire_arr)
+            if (inChunk(p.AUTOFIRE_ABS_X))
+                records.push_back({RECORD_AUTOFIRE, p.AUTOFIRE_ABS_X, p.AUTOFIRE_ABS_Y, p.AUTOFIRE_WIDTH, p.AUTOFIRE_HEIGHT, p.enabled});
+    }
+    chunkIndex.push_back(records.size());
+    return chunkWidth;
+}
+
+int MapBlocks::chunkCount(ChunkRandom &random, int perLevel, int width, int percent)
+{
+    // Round up or down at random, so the counts add up right over a whole level
+    double expected = (double) perLevel * width / levelWidth * percent / 100;
+    int count = (int) expected;
+    if (random.next(1000) < (expected - count) * 1000) {
+        count++;
+    }
+    return count;
+}
+
 MapBlocks::~MapBlocks()
 {
-	SDL_DestroyTexture(explosionSprite);
-	SDL_DestroyTexture(dustCloudSprite);
-	SDL_DestroyTexture(topTurretSprite);
-	SDL_DestroyTexture(bottomTurretSprite);
-	SDL_DestroyTexture(stalactiteSprite1);
-	SDL_DestroyTexture(stalactiteSprite2);
-	SDL_DestroyTexture(stalactiteSprite3);
-	SDL_DestroyTexture(stalactiteSprite4);
-	SDL_DestroyTexture(stalagmiteSprite1);
-	SDL_DestroyTexture(stalagmiteSprite2);
-	SDL_DestroyTexture(stalagmiteSprite3);
-	SDL_DestroyTexture(stalagmiteSprite4);
-	SDL_DestroyTexture(healthSprite);
-	SDL_DestroyTexture(mSprite1);
-	SDL_DestroyTexture(mSprite2);
-    SDL_DestroyTexture(infFireSprite);
-    SDL_DestroyTexture(invinceSprite);
-    SDL_DestroyTexture(autofireSprite);
+	gAssets->releaseAnimation(ANIM_EXPLOSION);
+	gAssets->releaseAnimation(ANIM_DUST_CLOUD);
+	gAssets->release(ASSET_TOP_TURRET);
+	gAssets->release(ASSET_BOTTOM_TURRET);
+	gAssets->release(ASSET_STALACTITE_1);
+	gAssets->release(ASSET_STALACTITE_2);
+	gAssets->release(ASSET_STALACTITE_3);
+	gAssets->release(ASSET_STALACTITE_4);
+	gAssets->release(ASSET_STALAGMITE_1);
+	gAssets->release(ASSET_STALAGMITE_2);
+	gAssets->release(ASSET_STALAGMITE_3);
+	gAssets->release(ASSET_STALAGMITE_4);
+	gAssets->release(ASSET_HEALTH);
+	gAssets->release(ASSET_MISSILE_1);
+	gAssets->release(ASSET_MISSILE_2);
+    gAssets->release(ASSET_INF_FIRE);
+    gAssets->release(ASSET_INVINCE);
+    gAssets->release(ASSET_AUTOFIRE);
 }
 
 bool MapBlocks::checkCollide(int x, int y, int pWidth, int pHeight, int xTwo, int yTwo, int pTwoWidth, int pTwoHeight)
@@ -424,11 +641,24 @@ bool MapBlocks::checkCollide(int x, int y, int pWidth, int pHeight, int xTwo, in
 
 void MapBlocks::moveBlocks(int camX, int camY)
 {
+    streamChunks(camX);
+
+    // Explosions grow on the job system while everything else moves here
+    ExplosionJob grow = {this, camX, camY};
+    JobSystem::Counter grown;
+    gJobs->parallelFor(explosion_arr.size(), growExplosion, &grow, &grown);
+
     int i;
     for (i = 0; i < blocks_arr.size(); i++)
     {
         blocks_arr[i].BLOCK_REL_X = blocks_arr[i].BLOCK_ABS_X - camX;
         blocks_arr[i].BLOCK_REL_Y = blocks_arr[i].BLOCK_ABS_Y - camY;
+        // Turrets join the fire control queue as they come on screen
+        if (!blocks_arr[i].armed && blocks_arr[i].isOnScreen())
+        {
+            blocks_arr[i].armed = true;
+            fireControl.arm(blocks_arr[i].id, blocks_arr[i].last_move + Turret::SHOOT_FREQ);
+        }
 	}
     //ceiling and floor
     for(i = 0; i < ceiling_arr.size(); i++)
@@ -473,23 +703,18 @@ void MapBlocks::moveBlocks(int camX, int camY)
         stalagt_arr[i].STALAG_REL_X = stalagt_arr[i].STALAG_ABS_X - camX;
 		stalagt_arr[i].STALAG_REL_Y = stalagt_arr[i].STALAG_ABS_Y - camY;
         if(stalagt_arr[i].beenShot == 1){
-            stalagt_arr[i].time_since_move = SDL_GetTicks() - stalagt_arr[i].last_move;
+            stalagt_arr[i].time_since_move = GameClock::getTicks() - stalagt_arr[i].last_move;
             if(stalagt_arr[i].STALAG_REL_Y <  stalagt_arr[i].terminalVelocityYValue){
                 stalagt_arr[i].acceleration += 0.008 * stalagt_arr[i].time_since_move;
             }
             stalagt_arr[i].STALAG_ABS_Y += stalagt_arr[i].acceleration; // maybe make it fall until it reaches halfway down instead when the tip collides
-            stalagt_arr[i].last_move = SDL_GetTicks();
+            stalagt_arr[i].last_move = GameClock::getTicks();
         }
         // stalagt_arr[i].STALAG_REL_Y = stalagt_arr[i].STALAG_ABS_Y-camY - WallBlock::block_side - stalagt_arr[i].STALAG_HEIGHT;
     }
+	gJobs->wait(&grown);
 	for (i = explosion_arr.size() - 1; i >= 0; i--)
 	{
-		explosion_arr[i].current_size = (double) explosion_arr[i].INITIAL_EXPLOSION_SIZE + ((SDL_GetTicks() - explosion_arr[i].explosion_time) * explosion_arr[i].EXPLOSION_SPEED) / 1000;
-		explosion_arr[i].abs_x = explosion_arr[i].center_x - explosion_arr[i].current_size / 2;
-		explosion_arr[i].abs_y = explosion_arr[i].center_y - explosion_arr[i].current_size / 2;
-		explosion_arr[i].rel_x = explosion_arr[i].abs_x - camX;
-		explosion_arr[i].rel_y = explosion_arr[i].abs_y - camY;
-		explosion_arr[i].hitbox = {(int)explosion_arr[i].rel_x, (int)explosion_arr[i].rel_y, (int)explosion_arr[i].current_size, (int)explosion_arr[i].current_size};
 		// If the explosion has reached its maximum size, get rid of it
 		if (explosion_arr[i].current_size >= explosion_arr[i].FINAL_EXPLOSION_SIZE) {
 			explosion_arr.erase(explosion_arr.begin() + i);
@@ -497,24 +722,68 @@ void MapBlocks::moveBlocks(int camX, int camY)
 	}
 }
 
-std::vector<Missile*> MapBlocks::handleFiring(std::vector<Missile*> missiles, int posX, int posY) {
-	for (int i = 0; i < blocks_arr.size(); i++) {
-		if (blocks_arr[i].BLOCK_REL_X > 0 && blocks_arr[i].BLOCK_REL_Y > 0 && blocks_arr[i].BLOCK_REL_X <= 1280 && blocks_arr[i].BLOCK_REL_Y <= 720) {
-			Missile * newMissile = blocks_arr[i].handleFiring(posX, posY);
-			if (newMissile != nullptr) {
-				missiles.push_back(newMissile);
-			}
+// Runs on the job system. Only writes explosion i.
+void MapBlocks::growExplosion(int i, void* data)
+{
+	ExplosionJob* job = (ExplosionJob*) data;
+	Explosion &explosion = job->blocks->explosion_arr[i];
+	explosion.current_size = (double) explosion.INITIAL_EXPLOSION_SIZE + (Animator::getElapsed(explosion.animation) * explosion.EXPLOSION_SPEED) / 1000;
+	explosion.abs_x = explosion.center_x - explosion.current_size / 2;
+	explosion.abs_y = explosion.center_y - explosion.current_size / 2;
+	explosion.rel_x = explosion.abs_x - job->camX;
+	explosion.rel_y = explosion.abs_y - job->camY;
+	explosion.hitbox = {(int)explosion.rel_x, (int)explosion.rel_y, (int)explosion.current_size, (int)explosion.current_size};
+}
+
+std::vector<Missile*> MapBlocks::handleFiring(std::vector<Missile*> missiles, int posX, int posY, double velX, double velY, double driftX) {
+	Uint32 now = GameClock::getTicks();
+	shots.clear();
+	int id;
+	while (fireControl.nextDue(now, id)) {
+		Turret *turret = findTurret(id);
+		if (turret == nullptr) {
+			continue;
 		}
+		// Scrolled off since it was armed; it is armed again if it comes back
+		if (!turret->isOnScreen()) {
+			turret->armed = false;
+			continue;
+		}
+		Shot shot;
+		shot.turret = turret;
+		turret->getMuzzle(posY, shot.x, shot.y);
+		TurretFireControl::aim(posX - shot.x, posY - shot.y, velX - driftX, velY, Turret::MISSILE_SPEED, shot.xVel, shot.yVel);
+		shots.push_back(shot);
+		fireControl.arm(id, now + Turret::SHOOT_FREQ);
+	}
+
+	missiles.reserve(missiles.size() + shots.size());
+	for (int i = 0; i < shots.size(); i++) {
+		Missile* m = shots[i].turret->fire(shots[i].x, shots[i].y, shots[i].xVel, shots[i].yVel);
+		if (homingMissiles) {
+			m->makeHoming(Turret::HOMING_TURN_RATE, Turret::HOMING_FUEL);
+		}
+		missiles.push_back(m);
 	}
 	return missiles;
 }
 
-bool MapBlocks::checkCollision(Kamikaze *kam){
+Turret* MapBlocks::findTurret(int id) {
+	std::vector<Turret>::iterator it = std::lower_bound(blocks_arr.begin(), blocks_arr.end(), id, [](const Turret &t, int id) { return t.id < id; });
+	if (it == blocks_arr.end() || it->id != id) {
+		return nullptr;
+	}
+	return &*it;
+}
+
+bool MapBlocks::checkCollision(KamikazeSwarm *swarm, int k){
+	int kamX = swarm->getX(k);
+	int kamY = swarm->getY(k);
 	int i;
     for (i = 0; i < blocks_arr.size(); i++)
     {
         // If there's a collision, return true and delete the turret
-		if (checkCollide(kam->getX(), kam->getY(), kam->getWidth(), kam->getHeight(), blocks_arr[i].BLOCK_REL_X, blocks_arr[i].BLOCK_REL_Y, blocks_arr[i].BLOCK_WIDTH, blocks_arr[i].BLOCK_HEIGHT))
+		if (checkCollide(kamX, kamY, KamikazeSwarm::WIDTH, KamikazeSwarm::HEIGHT, blocks_arr[i].BLOCK_REL_X, blocks_arr[i].BLOCK_REL_Y, blocks_arr[i].BLOCK_WIDTH, blocks_arr[i].BLOCK_HEIGHT))
         {
 					explosion_arr.push_back(Explosion(blocks_arr[i].BLOCK_ABS_X + blocks_arr[i].BLOCK_WIDTH / 2, blocks_arr[i].BLOCK_ABS_Y + blocks_arr[i].BLOCK_HEIGHT / 2, 0, gRenderer));
 					blocks_arr.erase(blocks_arr.begin() + i);
@@ -524,7 +793,7 @@ bool MapBlocks::checkCollision(Kamikaze *kam){
     for (i = 0; i < stalagm_arr.size(); i++)
     {
         // If there's a collision, damage the enemy and delete the stalagmite
-        if (checkCollide(kam->getX(), kam->getY(), kam->getWidth(), kam->getHeight(), stalagm_arr[i].STALAG_REL_X, stalagm_arr[i].STALAG_REL_Y, stalagm_arr[i].STALAG_WIDTH, stalagm_arr[i].STALAG_HEIGHT))
+        if (checkCollide(kamX, kamY, KamikazeSwarm::WIDTH, KamikazeSwarm::HEIGHT, stalagm_arr[i].STALAG_REL_X, stalagm_arr[i].STALAG_REL_Y, stalagm_arr[i].STALAG_WIDTH, stalagm_arr[i].STALAG_HEIGHT))
         {
 						explosion_arr.push_back(Explosion(stalagm_arr[i].STALAG_ABS_X + stalagm_arr[i].STALAG_WIDTH / 2, stalagm_arr[i].STALAG_ABS_Y + stalagm_arr[i].STALAG_HEIGHT / 2, 1, gRenderer));
 						stalagm_arr.erase(stalagm_arr.begin() + i);
@@ -535,7 +804,7 @@ bool MapBlocks::checkCollision(Kamikaze *kam){
 		for (i = 0; i < stalagt_arr.size(); i++)
 		{
         // If there's a collision, damage the enemy and delete the stalactite
-        if (checkCollide(kam->getX(), kam->getY(), kam->getWidth(), kam->getHeight(), stalagt_arr[i].STALAG_REL_X, stalagt_arr[i].STALAG_REL_Y, stalagt_arr[i].STALAG_WIDTH, stalagt_arr[i].STALAG_HEIGHT))
+        if (checkCollide(kamX, kamY, KamikazeSwarm::WIDTH, KamikazeSwarm::HEIGHT, stalagt_arr[i].STALAG_REL_X, stalagt_arr[i].STALAG_REL_Y, stalagt_arr[i].STALAG_WIDTH, stalagt_arr[i].STALAG_HEIGHT))
         {
 						explosion_arr.push_back(Explosion(stalagt_arr[i].STALAG_ABS_X + stalagt_arr[i].STALAG_WIDTH / 2, stalagt_arr[i].STALAG_ABS_Y + stalagt_arr[i].STALAG_HEIGHT / 2, 1, gRenderer));
 						stalagt_arr.erase(stalagt_arr.begin() + i);
@@ -707,7 +976,7 @@ bool MapBlocks::checkCollision(Missile* m)
         if (checkCollide(m->getX(), m->getY(), m->getWidth(), m->getWidth(), stalagt_arr[i].STALAG_REL_X, stalagt_arr[i].STALAG_REL_Y, stalagt_arr[i].STALAG_WIDTH, stalagt_arr[i].STALAG_HEIGHT))
         {
             stalagt_arr[i].beenShot = 1;
-            stalagt_arr[i].last_move = SDL_GetTicks();
+            stalagt_arr[i].last_move = GameClock::getTicks();
             return true;
         }
     }
@@ -745,7 +1014,7 @@ int MapBlocks::checkCollision(Bullet *b)
         if (checkCollide(b->getX(), b->getY(), b->getWidth(), b->getHeight(), stalagt_arr[i].STALAG_REL_X, stalagt_arr[i].STALAG_REL_Y, stalagt_arr[i].STALAG_WIDTH, stalagt_arr[i].STALAG_HEIGHT))
         {
             stalagt_arr[i].beenShot = 1;
-            stalagt_arr[i].last_move = SDL_GetTicks();
+            stalagt_arr[i].last_move = GameClock::getTicks();
             return 3;
         }
     }
@@ -767,7 +1036,7 @@ int MapBlocks::checkCollision(Bullet *b)
 }
 
 
-void MapBlocks::render(int SCREEN_WIDTH, int SCREEN_HEIGHT, SDL_Renderer* gRenderer, bool caveIsEnabled)
+void MapBlocks::render(int SCREEN_WIDTH, int SCREEN_HEIGHT, RenderSnapshot* frame, bool caveIsEnabled)
 {
     int i;
 
@@ -798,10 +1067,10 @@ void MapBlocks::render(int SCREEN_WIDTH, int SCREEN_HEIGHT, SDL_Renderer* gRende
         {
             SDL_Rect fillRect = {blocks_arr[i].BLOCK_REL_X, blocks_arr[i].BLOCK_REL_Y, blocks_arr[i].BLOCK_WIDTH, blocks_arr[i].BLOCK_HEIGHT};
             if (blocks_arr[i].bottom == 1) {
-				SDL_RenderCopyEx(gRenderer, bottomTurretSprite, nullptr, &fillRect, 0.0, nullptr, SDL_FLIP_NONE);
+				frame->copy(bottomTurretSprite, &fillRect);
 			}
 			else {
-				SDL_RenderCopyEx(gRenderer, topTurretSprite, nullptr, &fillRect, 0.0, nullptr, SDL_FLIP_NONE);
+				frame->copy(topTurretSprite, &fillRect);
 			}
         }
     }
@@ -830,8 +1099,8 @@ void MapBlocks::render(int SCREEN_WIDTH, int SCREEN_HEIGHT, SDL_Renderer* gRende
         if(ceiling_arr[i].CEILING_REL_X < SCREEN_WIDTH && ceiling_arr[i].CEILING_REL_Y < SCREEN_HEIGHT)
         {
             SDL_Rect fillRect = {ceiling_arr[i].CEILING_REL_X, ceiling_arr[i].CEILING_REL_Y, WallBlock::block_side, WallBlock::block_side};
-            SDL_SetRenderDrawColor(gRenderer, 0x7F, 0x33, 0x00, 0xFF);
-            SDL_RenderFillRect(gRenderer, &fillRect);
+            frame->setDrawColor(0x7F, 0x33, 0x00, 0xFF);
+            frame->fillRect(fillRect);
         }
 	}
 
@@ -840,8 +1109,8 @@ void MapBlocks::render(int SCREEN_WIDTH, int SCREEN_HEIGHT, SDL_Renderer* gRende
         if(floor_arr[i].FLOOR_REL_X < SCREEN_WIDTH && floor_arr[i].FLOOR_REL_Y < SCREEN_HEIGHT)
         {
             SDL_Rect fillRect = {floor_arr[i].FLOOR_REL_X, floor_arr[i].FLOOR_REL_Y, WallBlock::block_side, WallBlock::block_side};
-            SDL_SetRenderDrawColor(gRenderer, 0x7F, 0x33, 0x00, 0xFF);
-            SDL_RenderFillRect(gRenderer, &fillRect);
+            frame->setDrawColor(0x7F, 0x33, 0x00, 0xFF);
+            frame->fillRect(fillRect);
         }
     }
 
@@ -851,7 +1120,7 @@ void MapBlocks::render(int SCREEN_WIDTH, int SCREEN_HEIGHT, SDL_Renderer* gRende
         if (health_arr[i].HEALTH_REL_X < SCREEN_WIDTH && health_arr[i].HEALTH_REL_Y < SCREEN_HEIGHT&& health_arr[i].enabled)
         {
             SDL_Rect fillRect = {health_arr[i].HEALTH_REL_X, health_arr[i].HEALTH_REL_Y, health_arr[i].HEALTH_WIDTH, health_arr[i].HEALTH_HEIGHT};
-            SDL_RenderCopyEx(gRenderer, healthSprite, nullptr, &fillRect, 0.0, nullptr, SDL_FLIP_NONE);
+            frame->copy(healthSprite, &fillRect);
         }
     }
 
@@ -861,7 +1130,7 @@ void MapBlocks::render(int SCREEN_WIDTH, int SCREEN_HEIGHT, SDL_Renderer* gRende
         if (infFire_arr[i].INF_FIRE_REL_X < SCREEN_WIDTH && infFire_arr[i].INF_FIRE_REL_Y < SCREEN_HEIGHT&& infFire_arr[i].enabled)
         {
             SDL_Rect fillRect = {infFire_arr[i].INF_FIRE_REL_X, infFire_arr[i].INF_FIRE_REL_Y, infFire_arr[i].INF_FIRE_WIDTH, infFire_arr[i].INF_FIRE_HEIGHT};
-            SDL_RenderCopyEx(gRenderer, infFireSprite, nullptr, &fillRect, 0.0, nullptr, SDL_FLIP_NONE);
+            frame->copy(infFireSprite, &fillRect);
         }
     }
 
@@ -871,7 +1140,7 @@ void MapBlocks::render(int SCREEN_WIDTH, int SCREEN_HEIGHT, SDL_Renderer* gRende
         if (invince_arr[i].INVINCE_REL_X < SCREEN_WIDTH && invince_arr[i].INVINCE_REL_Y < SCREEN_HEIGHT&& invince_arr[i].enabled)
         {
             SDL_Rect fillRect = {invince_arr[i].INVINCE_REL_X, invince_arr[i].INVINCE_REL_Y, invince_arr[i].INVINCE_WIDTH, invince_arr[i].INVINCE_HEIGHT};
-            SDL_RenderCopyEx(gRenderer, invinceSprite, nullptr, &fillRect, 0.0, nullptr, SDL_FLIP_NONE);
+            frame->copy(invinceSprite, &fillRect);
         }
     }
 
@@ -881,7 +1150,7 @@ void MapBlocks::render(int SCREEN_WIDTH, int SCREEN_HEIGHT, SDL_Renderer* gRende
         if (autofire_arr[i].AUTOFIRE_REL_X < SCREEN_WIDTH && autofire_arr[i].AUTOFIRE_REL_Y < SCREEN_HEIGHT&& autofire_arr[i].enabled)
         {
             SDL_Rect fillRect = {autofire_arr[i].AUTOFIRE_REL_X, autofire_arr[i].AUTOFIRE_REL_Y, autofire_arr[i].AUTOFIRE_WIDTH, autofire_arr[i].AUTOFIRE_HEIGHT};
-            SDL_RenderCopyEx(gRenderer, autofireSprite, nullptr, &fillRect, 0.0, nullptr, SDL_FLIP_NONE);
+            frame->copy(autofireSprite, &fillRect);
         }
     }
 
@@ -893,16 +1162,16 @@ void MapBlocks::render(int SCREEN_WIDTH, int SCREEN_HEIGHT, SDL_Renderer* gRende
         {
             SDL_Rect fillRect = {stalagm_arr[i].STALAG_REL_X, stalagm_arr[i].STALAG_REL_Y, stalagm_arr[i].STALAG_WIDTH, stalagm_arr[i].STALAG_HEIGHT};
             if (stalagm_arr[i].stalagShapeNum == 1) {
-				SDL_RenderCopyEx(gRenderer, stalagmiteSprite1, nullptr, &fillRect, 0.0, nullptr, SDL_FLIP_NONE);
+				frame->copy(stalagmiteSprite1, &fillRect);
 			}
 			else if (stalagm_arr[i].stalagShapeNum == 2) {
-				SDL_RenderCopyEx(gRenderer, stalagmiteSprite2, nullptr, &fillRect, 0.0, nullptr, SDL_FLIP_NONE);
+				frame->copy(stalagmiteSprite2, &fillRect);
 			}
 			else if (stalagm_arr[i].stalagShapeNum == 3) {
-				SDL_RenderCopyEx(gRenderer, stalagmiteSprite3, nullptr, &fillRect, 0.0, nullptr, SDL_FLIP_NONE);
+				frame->copy(stalagmiteSprite3, &fillRect);
 			}
 			else {
-				SDL_RenderCopyEx(gRenderer, stalagmiteSprite4, nullptr, &fillRect, 0.0, nullptr, SDL_FLIP_NONE);
+				frame->copy(stalagmiteSprite4, &fillRect);
 			}
         }
     }
@@ -914,16 +1183,16 @@ void MapBlocks::render(int SCREEN_WIDTH, int SCREEN_HEIGHT, SDL_Renderer* gRende
 
 			SDL_Rect fillRect = {stalagt_arr[i].STALAG_REL_X, stalagt_arr[i].STALAG_REL_Y, stalagt_arr[i].STALAG_WIDTH, stalagt_arr[i].STALAG_HEIGHT};
             if (stalagt_arr[i].stalagShapeNum == 1) {
-				SDL_RenderCopyEx(gRenderer, stalactiteSprite1, nullptr, &fillRect, 0.0, nullptr, SDL_FLIP_NONE);
+				frame->copy(stalactiteSprite1, &fillRect);
 			}
 			else if (stalagt_arr[i].stalagShapeNum == 2) {
-				SDL_RenderCopyEx(gRenderer, stalactiteSprite2, nullptr, &fillRect, 0.0, nullptr, SDL_FLIP_NONE);
+				frame->copy(stalactiteSprite2, &fillRect);
 			}
 			else if (stalagt_arr[i].stalagShapeNum == 3) {
-				SDL_RenderCopyEx(gRenderer, stalactiteSprite3, nullptr, &fillRect, 0.0, nullptr, SDL_FLIP_NONE);
+				frame->copy(stalactiteSprite3, &fillRect);
 			}
 			else {
-				SDL_RenderCopyEx(gRenderer, stalactiteSprite4, nullptr, &fillRect, 0.0, nullptr, SDL_FLIP_NONE);
+				frame->copy(stalactiteSprite4, &fillRect);
 			}
         }
 
@@ -936,12 +1205,7 @@ void MapBlocks::render(int SCREEN_WIDTH, int SCREEN_HEIGHT, SDL_Renderer* gRende
     }
 
 	for (i = 0; i < explosion_arr.size(); i++) {
-        if(explosion_arr[i].type == 0){
-		    SDL_RenderCopyEx(gRenderer, explosionSprite, nullptr, &explosion_arr[i].hitbox, 0.0, nullptr, SDL_FLIP_NONE);
-        }
-        else{
-            SDL_RenderCopyEx(gRenderer, dustCloudSprite, nullptr, &explosion_arr[i].hitbox, 0.0, nullptr, SDL_FLIP_NONE);
-        }
+		Animator::draw(frame, explosion_arr[i].animation, explosion_arr[i].hitbox);
     }
 }
 
@@ -950,14 +1214,14 @@ void MapBlocks::addExplosion(int x, int y, int w, int h, int type) {
 	explosion_arr.push_back(Explosion(x + w / 2, y + h / 2, type, gRenderer));
 }
 
-std::vector<Stalagmite> MapBlocks::getStalagmites() {
+const std::vector<Stalagmite>& MapBlocks::getStalagmites() {
 	return stalagm_arr;
 }
 
-std::vector<Stalagtite> MapBlocks::getStalagtites() {
+const std::vector<Stalagtite>& MapBlocks::getStalagtites() {
 	return stalagt_arr;
 }
 
-std::vector<Turret> MapBlocks::getTurrets() {
+const std::vector<Turret>& MapBlocks::getTurrets() {
 	return blocks_arr;
 }
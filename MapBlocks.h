@@ -5,9 +5,14 @@
 #include "Player.h"
 #include "Enemy.h"
 #include "CaveSystem.h"
-#include "Kamikaze.h"
+#include "KamikazeSwarm.h"
 #include <vector>
 #include "missile.h"
+#include "RenderSnapshot.h"
+#include "Animation.h"
+#include "PlacementSampler.h"
+#include "LevelFile.h"
+#include "TurretFireControl.h"
 
 class WallBlock
 {
@@ -43,7 +48,8 @@ public:
     bool enabled;
 
     HealthBlock();
-    HealthBlock(int LEVEL_WIDTH,int LEVEL_HEIGHT, SDL_Renderer *gRenderer, int cave_freq, int cave_width, int openAir, int openAirLength);
+    HealthBlock(ChunkRandom &random, int x, int LEVEL_HEIGHT, int openAir, int openAirLength);
+    HealthBlock(const LevelRecord &record);
 };
 
 class InfFireBlock
@@ -61,7 +67,8 @@ public:
     bool enabled;
 
     InfFireBlock();
-    InfFireBlock(int LEVEL_WIDTH,int LEVEL_HEIGHT, SDL_Renderer *gRenderer, int cave_freq, int cave_width, int openAir, int openAirLength);
+    InfFireBlock(ChunkRandom &random, int x, int LEVEL_HEIGHT, int openAir, int openAirLength);
+    InfFireBlock(const LevelRecord &record);
 };
 class AutoFireBlock
 {
@@ -78,7 +85,8 @@ public:
     bool enabled;
 
     AutoFireBlock();
-    AutoFireBlock(int LEVEL_WIDTH,int LEVEL_HEIGHT, SDL_Renderer *gRenderer, int cave_freq, int cave_width, int openAir, int openAirLength);
+    AutoFireBlock(ChunkRandom &random, int x, int LEVEL_HEIGHT, int openAir, int openAirLength);
+    AutoFireBlock(const LevelRecord &record);
 };
 
 class InvincBlock
@@ -96,7 +104,8 @@ public:
     bool enabled;
 
     InvincBlock();
-    InvincBlock(int LEVEL_WIDTH,int LEVEL_HEIGHT, SDL_Renderer *gRenderer, int cave_freq, int cave_width, int openAir, int openAirLength);
+    InvincBlock(ChunkRandom &random, int x, int LEVEL_HEIGHT, int openAir, int openAirLength);
+    InvincBlock(const LevelRecord &record);
 };
 
 
@@ -113,9 +122,11 @@ public:
     int STALAG_WIDTH;
 
     int hitboxWidth;
+    static const int MAX_WIDTH = 75;
 
     Stalagmite();
-    Stalagmite(int LEVEL_WIDTH,int LEVEL_HEIGHT, SDL_Renderer *gRenderer, int cave_freq, int cave_width, int openAir, int openAirLength);
+    Stalagmite(ChunkRandom &random, int x, int LEVEL_HEIGHT);
+    Stalagmite(const LevelRecord &record);
 
     int stalagShapeNum;
     int alreadyExploded;
@@ -134,9 +145,11 @@ public:
     int STALAG_WIDTH;
 
     int hitboxWidth;
+    static const int MAX_WIDTH = 75;
 
     Stalagtite();
-    Stalagtite(int LEVEL_WIDTH,int LEVEL_HEIGHT, SDL_Renderer *gRenderer, int cave_freq, int cave_width, int openAir, int openAirLength);
+    Stalagtite(ChunkRandom &random, int x, int LEVEL_HEIGHT);
+    Stalagtite(const LevelRecord &record);
 
     int stalagShapeNum;
 
@@ -154,6 +167,17 @@ public:
 	int time_since_move;
 	int last_move;
 	static const int SHOOT_FREQ = 3000;
+	static const int MISSILE_SPEED = 400;
+	static const int MISSILE_DAMAGE = 500;
+	static const int MISSILE_BLAST_RADIUS = 150;
+	// Heat seekers, fired on hard: how fast they can turn, in radians a second, and for how many seconds
+	static constexpr float HOMING_TURN_RATE = 1.2f;
+	static constexpr float HOMING_FUEL = 2.5f;
+
+	// Handed out by MapBlocks in the order turrets are made, so blocks_arr stays sorted by it
+	int id;
+	// Whether the turret is waiting its turn in the fire control queue
+	bool armed;
 
     // absolute coordinates of each Turret
     int BLOCK_ABS_X;
@@ -173,8 +197,10 @@ public:
 
     SDL_Renderer* gRenderer;
 
+    static const int TURRET_SIZE = 50;
+
     Turret();
-    Turret(int LEVEL_WIDTH, int LEVEL_HEIGHT, SDL_Renderer *gRenderer, int cave_freq, int cave_width, int openAir, int openAirLength, SDL_Texture* missileSprite1, SDL_Texture* missileSprite2);
+    Turret(int x, bool onFloor, int LEVEL_HEIGHT, SDL_Renderer *gRenderer, SDL_Texture* missileSprite1, SDL_Texture* missileSprite2);
 
 	int getRelX();
 	int getRelY();
@@ -188,7 +214,10 @@ public:
     SDL_Texture* missileSprite1;
     SDL_Texture* missileSprite2;
 
-	Missile* handleFiring(int posX, int posY);
+	bool isOnScreen();
+	// Where a missile leaves the barrel, facing whoever is at posY
+	void getMuzzle(int posY, int &x, int &y);
+	Missile* fire(int x, int y, double xVel, double yVel);
 };
 
 class Explosion
@@ -199,9 +228,11 @@ public:
 	static const int INITIAL_EXPLOSION_SIZE = 30;
 	static const int FINAL_EXPLOSION_SIZE = 100;
 	static const int EXPLOSION_SPEED = 100;
-	int explosion_time;
 	double current_size;
 
+	// The explosion or dust cloud clip, also used to time how big the explosion has grown
+	AnimationState animation;
+
 	// Absolute location of the explosion's center
 	int center_x;
 	int center_y;
@@ -243,12 +274,8 @@ public:
     static const int BLOCK_HEIGHT = 100;
     static const int BLOCK_WIDTH = 100;
 
-    static const int CEILING_N = 100000/72;
-
     SDL_Renderer *gRenderer;
 
-    SDL_Texture* explosionSprite;
-    SDL_Texture* dustCloudSprite;
 	SDL_Texture* topTurretSprite;
 	SDL_Texture* bottomTurretSprite;
 	SDL_Texture* stalactiteSprite1;
@@ -281,28 +308,95 @@ public:
     MapBlocks();
 	~MapBlocks();
 
-    MapBlocks(int LEVEL_WIDTH, int LEVEL_HEIGHT, SDL_Renderer *gr, int cave_freq, int cave_width, int openAir, int openAirLength, int diff);
+    // The counts above are per level length. In endless mode the level never ends and gets harder
+    // the further the camera goes.
+    // Everything comes from seed, or from level's records where it has them.
+    MapBlocks(int LEVEL_WIDTH, int LEVEL_HEIGHT, SDL_Renderer *gr, int cave_freq, int cave_width, int openAir, int openAirLength, int diff, Uint32 seed, bool endless = false, LevelFile *level = nullptr);
     bool checkCollide(int x, int y, int pWidth, int pHeight, int xTwo, int yTwo, int pTwoWidth, int pTwoHeight);
 
+    // Also generates the level ahead of the camera and drops what is behind it
     void moveBlocks(int camX, int camY);
 	void checkCollision(Player *p);
 	void checkCollision(Enemy *e);
-    bool checkCollision(Kamikaze *kam);
+    // Whether kamikaze k crashed into something, blowing that up
+    bool checkCollision(KamikazeSwarm *swarm, int k);
 	bool checkCollision(Missile* m);
     int checkCollision(Bullet *b);
 
-	std::vector<Missile*> handleFiring(std::vector<Missile*> missiles, int posX, int posY);
+	// Fires every turret whose turn has come, leading the player. driftX is how fast missiles drift
+	// sideways on top of their own velocity.
+	std::vector<Missile*> handleFiring(std::vector<Missile*> missiles, int posX, int posY, double velX, double velY, double driftX);
 
-	std::vector<Stalagmite> getStalagmites();
-	std::vector<Stalagtite> getStalagtites();
-	std::vector<Turret> getTurrets();
+	const std::vector<Stalagmite>& getStalagmites();
+	const std::vector<Stalagtite>& getStalagtites();
+	const std::vector<Turret>& getTurrets();
 
-    void render(int SCREEN_WIDTH, int SCREEN_HEIGHT, SDL_Renderer *gRenderer, bool isCaveEnabled);
+    void render(int SCREEN_WIDTH, int SCREEN_HEIGHT, RenderSnapshot *frame, bool isCaveEnabled);
+    // Generates the rest of the level and lists its hazards and powerups chunk by chunk, for saving.
+    // Returns the chunk width.
+    int listLevel(std::vector<Uint32> &chunkIndex, std::vector<LevelRecord> &records);
 	void addExplosion(int x, int y, int w, int h, int type);
 
 private:
     //Animation frequency
     static const int ANIMATION_FREQ = 100;
+
+    // Room kept clear either side of a hazard and of a powerup
+    static const int HAZARD_SPACING = 100;
+    static const int POWERUP_SPACING = 50;
+    // How far past the left edge of the screen things are kept
+    static const int DISCARD_MARGIN = 2 * WallBlock::block_side;
+    // Percent more turrets and stalags (and fewer powerups) per level length travelled in endless mode
+    static const int ENDLESS_HAZARD_GROWTH = 50;
+
+    // The level is generated a chunk at a time, each from its own seed, just before it scrolls on
+    // screen. Chunks are one cave period wide so every chunk has the same room outside of caves.
+    bool endless;
+    Uint32 levelSeed;
+    int levelWidth;
+    int levelHeight;
+    int caveFreq;
+    int caveWidth;
+    int openAir;
+    int openAirLength;
+    int chunkWidth;
+    int nextChunk;
+    int discardedChunk;
+    LevelFile *level;
+
+    struct ExplosionJob
+    {
+        MapBlocks *blocks;
+        int camX;
+        int camY;
+    };
+
+    struct Shot
+    {
+        Turret *turret;
+        int x;
+        int y;
+        double xVel;
+        double yVel;
+    };
+
+    TurretFireControl fireControl;
+    // Turrets fire heat seekers on hard
+    bool homingMissiles;
+    int nextTurretId;
+    // Kept between ticks so aiming a volley does not allocate
+    std::vector<Shot> shots;
+
+    // The turret with this id, or nullptr once it is gone
+    Turret* findTurret(int id);
+    static void growExplosion(int i, void* data);
+    void streamChunks(int camX);
+    void generateChunk(int chunk);
+    // Drops everything that ends left of x
+    void discardBefore(int x);
+    void addRecord(const LevelRecord &record);
+    // How many of something there are in a chunk, given how many there would be in a whole level
+    int chunkCount(ChunkRandom &random, int perLevel, int width, int percent);
 };
 
 #endif
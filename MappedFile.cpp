@@ -0,0 +1,107 @@
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile()
+{
+	data = nullptr;
+	dataSize = 0;
+#ifdef _WIN32
+	fileHandle = nullptr;
+	mappingHandle = nullptr;
+#endif
+}
+
+MappedFile::~MappedFile()
+{
+	close();
+}
+
+bool MappedFile::open(const char* path)
+{
+	close();
+
+#ifdef _WIN32
+	HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE) {
+		return false;
+	}
+	LARGE_INTEGER file_size;
+	if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0) {
+		CloseHandle(file);
+		return false;
+	}
+	HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (mapping == NULL) {
+		CloseHandle(file);
+		return false;
+	}
+	data = (const Uint8*) MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if (data == nullptr) {
+		CloseHandle(mapping);
+		CloseHandle(file);
+		return false;
+	}
+	fileHandle = file;
+	mappingHandle = mapping;
+	dataSize = (size_t) file_size.QuadPart;
+#else
+	int fd = ::open(path, O_RDONLY);
+	if (fd < 0) {
+		return false;
+	}
+	struct stat file_info;
+	if (fstat(fd, &file_info) != 0 || file_info.st_size == 0) {
+		::close(fd);
+		return false;
+	}
+	void* mapped = mmap(nullptr, file_info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	// The mapping keeps the file alive on its own
+	::close(fd);
+	if (mapped == MAP_FAILED) {
+		return false;
+	}
+	data = (const Uint8*) mapped;
+	dataSize = file_info.st_size;
+#endif
+	return true;
+}
+
+void MappedFile::close()
+{
+	if (data != nullptr) {
+#ifdef _WIN32
+		UnmapViewOfFile(data);
+		CloseHandle((HANDLE) mappingHandle);
+		CloseHandle((HANDLE) fileHandle);
+		fileHandle = nullptr;
+		mappingHandle = nullptr;
+#else
+		munmap((void*) data, dataSize);
+#endif
+	}
+	data = nullptr;
+	dataSize = 0;
+}
+
+bool MappedFile::isOpen()
+{
+	return data != nullptr;
+}
+
+const Uint8* MappedFile::getData()
+{
+	return data;
+}
+
+size_t MappedFile::getSize()
+{
+	return dataSize;
+}
@@ -0,0 +1,31 @@
+#ifndef MappedFile_H
+#define MappedFile_H
+
+#include <SDL.h>
+
+// A whole file mapped read-only into memory. Nothing is read up front; pages come from disk the
+// first time something touches them.
+class MappedFile
+{
+public:
+	MappedFile();
+	~MappedFile();
+
+	// Returns false (and stays closed) if the file is missing or empty
+	bool open(const char* path);
+	void close();
+	bool isOpen();
+
+	const Uint8* getData();
+	size_t getSize();
+
+private:
+	const Uint8* data;
+	size_t dataSize;
+#ifdef _WIN32
+	void* fileHandle;
+	void* mappingHandle;
+#endif
+};
+
+#endif
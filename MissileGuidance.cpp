@@ -0,0 +1,57 @@
+#include "MissileGuidance.h"
+#include <cmath>
+#include <algorithm>
+
+constexpr float MissileGuidance::NAVIGATION_CONSTANT;
+
+// Guided missiles are only ever a handful, so this is a plain loop over the arrays rather than SIMD
+void MissileGuidance::step(float* x, float* y, float* xVel, float* yVel, float* fuel, const float* turnRate, const float* seconds, int count, const Target &target)
+{
+	for (int i = 0; i < count; i++) {
+		float t = seconds[i];
+		float vx = xVel[i];
+		float vy = yVel[i];
+		float speed = std::sqrt(vx * vx + vy * vy);
+
+		// Line of sight to the target and the target's velocity relative to the missile as it drifts
+		float rx = target.x - x[i];
+		float ry = target.y - y[i];
+		float rvx = target.xVel - (vx + target.driftX);
+		float rvy = target.yVel - vy;
+		// The extra pixel keeps the sums finite right on top of the target
+		float range_squared = rx * rx + ry * ry + 1;
+		float los_rate = (rx * rvy - ry * rvx) / range_squared;
+		float closing = -(rx * rvx + ry * rvy) / std::sqrt(range_squared);
+
+		// Commanded turn, limited by how hard the missile can turn and whether it has fuel left
+		float limit = fuel[i] > 0 ? turnRate[i] : 0;
+		float turn = NAVIGATION_CONSTANT * closing * los_rate / (speed + 1);
+		float angle = std::max(-limit, std::min(limit, turn)) * t;
+
+		// Rotate the velocity by angle. The series is plenty for the small angles of a tick, and the
+		// speed is put back afterwards so any error can't make the missile speed up or slow down.
+		float angle_squared = angle * angle;
+		float c = 1 - angle_squared * (0.5f - angle_squared * (1.0f / 24));
+		float s = angle * (1 - angle_squared * (1.0f / 6));
+		float new_vx = vx * c - vy * s;
+		float new_vy = vx * s + vy * c;
+		float scale = speed / std::sqrt(new_vx * new_vx + new_vy * new_vy + 1e-12f);
+		xVel[i] = new_vx * scale;
+		yVel[i] = new_vy * scale;
+		fuel[i] -= t;
+
+		x[i] += (xVel[i] + target.driftX) * t;
+		y[i] += yVel[i] * t;
+	}
+}
+
+void GuidanceBatch::resize(int count)
+{
+	x.resize(count);
+	y.resize(count);
+	xVel.resize(count);
+	yVel.resize(count);
+	fuel.resize(count);
+	turnRate.resize(count);
+	seconds.resize(count);
+}
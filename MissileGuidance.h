@@ -0,0 +1,41 @@
+#ifndef MissileGuidance_H
+#define MissileGuidance_H
+
+#include <vector>
+
+// Steers homing missiles by proportional navigation: a missile turns NAVIGATION_CONSTANT times as fast
+// as its line of sight to the target is turning, which puts it on a collision course rather than
+// chasing the target's tail. Each missile can only turn so fast, and only steers while it has fuel
+// left; after that it flies on straight. Speed never changes.
+//
+// Every missile goes through the same sums whether it homes or not; one that doesn't just has no turn
+// rate. The turn is applied by rotating the velocity with a short series instead of trig, so each
+// missile costs the same handful of multiplies and two square roots.
+class MissileGuidance
+{
+public:
+	static constexpr float NAVIGATION_CONSTANT = 4;
+
+	// What the missiles home in on, and how fast everything drifts sideways on top of its own velocity
+	struct Target
+	{
+		float x;
+		float y;
+		float xVel;
+		float yVel;
+		float driftX;
+	};
+
+	// Steers and moves count missiles on by their own number of seconds. turnRate is in radians a second.
+	static void step(float* x, float* y, float* xVel, float* yVel, float* fuel, const float* turnRate, const float* seconds, int count, const Target &target);
+};
+
+// Arrays for stepping a batch of missiles at once, kept between ticks so a step does not allocate
+struct GuidanceBatch
+{
+	std::vector<float> x, y, xVel, yVel, fuel, turnRate, seconds;
+
+	void resize(int count);
+};
+
+#endif
@@ -0,0 +1,113 @@
+#include "PlacementSampler.h"
+
+ChunkRandom::ChunkRandom(Uint32 seed)
+{
+    // Spread the seed's bits around so neighbouring chunk seeds don't start out alike
+    state = seed * 2654435761u ^ 0x9E3779B9u;
+    if (state == 0) {
+        state = 1;
+    }
+}
+
+int ChunkRandom::next(int n)
+{
+    // xorshift32
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state % n;
+}
+
+PlacementSampler::PlacementSampler(int start, int end)
+{
+    if (start < end) {
+        intervals.push_back({start, end});
+    }
+}
+
+void PlacementSampler::exclude(int from, int to)
+{
+    if (from >= to) {
+        return;
+    }
+    std::vector<Interval> kept;
+    kept.reserve(intervals.size() + 1);
+    for (const Interval &interval : intervals) {
+        if (to <= interval.start || from >= interval.end) {
+            kept.push_back(interval);
+            continue;
+        }
+        // Keep whatever sticks out either side
+        if (interval.start < from) {
+            kept.push_back({interval.start, from});
+        }
+        if (to < interval.end) {
+            kept.push_back({to, interval.end});
+        }
+    }
+    intervals.swap(kept);
+}
+
+void PlacementSampler::excludeRepeating(int offset, int length, int period)
+{
+    if (intervals.empty() || period <= 0) {
+        return;
+    }
+    int start = intervals.front().start;
+    int end = intervals.back().end;
+
+    // First copy that could reach into the free intervals, rounding down for negative distances too
+    int distance = start - length - offset;
+    int k = distance / period;
+    if (distance < 0 && distance % period != 0) {
+        k--;
+    }
+    for (int from = offset + k * period; from < end; from += period) {
+        exclude(from, from + length);
+    }
+}
+
+int PlacementSampler::room(const Interval &interval, int width)
+{
+    int places = interval.end - interval.start - width + 1;
+    return places > 0 ? places : 0;
+}
+
+int PlacementSampler::sample(ChunkRandom &random, int width)
+{
+    if (width < 1) {
+        width = 1;
+    }
+    int total = 0;
+    for (const Interval &interval : intervals) {
+        total += room(interval, width);
+    }
+    if (total == 0) {
+        return -1;
+    }
+
+    // Every place is equally likely, however the free room is split up
+    int pick = random.next(total);
+    for (const Interval &interval : intervals) {
+        int places = room(interval, width);
+        if (pick < places) {
+            return interval.start + pick;
+        }
+        pick -= places;
+    }
+    return -1;
+}
+
+void PlacementSampler::claim(int x, int width, int spacing)
+{
+    exclude(x - spacing, x + width + spacing);
+}
+
+int PlacementSampler::getFreeLength()
+{
+    int length = 0;
+    for (const Interval &interval : intervals) {
+        length += interval.end - interval.start;
+    }
+    return length;
+}
@@ -0,0 +1,55 @@
+#ifndef PlacementSampler_H
+#define PlacementSampler_H
+
+#include <SDL.h>
+#include <vector>
+
+// Small random number generator for level chunks, so a chunk comes out the same from the same seed
+// no matter what else has called rand() in the meantime
+class ChunkRandom
+{
+public:
+    ChunkRandom(Uint32 seed);
+    // A number from 0 to n - 1
+    int next(int n);
+
+private:
+    Uint32 state;
+};
+
+// Picks x positions for level features. The parts of a span a feature may go in are kept as a list
+// of free intervals, so a pick is one random number and a walk over the list rather than retrying
+// until something fits, and runs out cleanly when there is no room left. Placed features can claim
+// room around themselves so later ones keep their distance.
+class PlacementSampler
+{
+public:
+    // Everything from start up to (not including) end starts out free
+    PlacementSampler(int start, int end);
+
+    // Takes [from, to) out of the free intervals
+    void exclude(int from, int to);
+    // Takes out [offset, offset + length) and every copy of it shifted by a multiple of period
+    void excludeRepeating(int offset, int length, int period);
+
+    // A random x where something width wide fits entirely in a free interval, or -1 if it fits nowhere
+    int sample(ChunkRandom &random, int width);
+    // Takes out the feature at x and spacing either side of it
+    void claim(int x, int width, int spacing);
+
+    // How much is still free
+    int getFreeLength();
+
+private:
+    struct Interval
+    {
+        int start;
+        int end;
+    };
+    std::vector<Interval> intervals;
+
+    // How many places something width wide can start at in the interval
+    static int room(const Interval &interval, int width);
+};
+
+#endif
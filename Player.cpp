@@ -3,39 +3,24 @@
 #include <SDL.h>
 #include <SDL_image.h>
 #include "Player.h"
-
-SDL_Texture* Player::loadImage(std::string fname, SDL_Renderer *gRenderer) {
-	SDL_Texture* newText = nullptr;
-
-	SDL_Surface* startSurf = IMG_Load(fname.c_str());
-	if (startSurf == nullptr) {
-		std::cout << "Unable to load image " << fname << "! SDL Error: " << SDL_GetError() << std::endl;
-		return nullptr;
-	}
-
-	newText = SDL_CreateTextureFromSurface(gRenderer, startSurf);
-	if (newText == nullptr) {
-		std::cout << "Unable to create texture from " << fname << "! SDL Error: " << SDL_GetError() << std::endl;
-	}
-
-	SDL_FreeSurface(startSurf);
-
-	return newText;
-}
+#include "AssetCache.h"
+#include "GameClock.h"
 
 Player::Player(int xPos, int yPos, int diff, SDL_Renderer *gRenderer)
 {
     x_pos = xPos;
     y_pos = yPos;
+    entityId = RenderSnapshot::newEntityId();
     x_vel = 0;
     y_vel = 0;
     x_accel = 0;
     y_accel = 0;
-	sprite1 = loadImage("sprites/PlayerPlane1.png", gRenderer);
-	sprite2 = loadImage("sprites/PlayerPlane3.png", gRenderer);
+	gAssets->acquireAnimation(ANIM_PLAYER);
+	gAssets->acquireAnimation(ANIM_PLAYER_HIT);
+	animation = Animator::play(ANIM_PLAYER);
     bg_X = 0;
     tiltAngle = 0;
-	last_move = SDL_GetTicks();
+	last_move = GameClock::getTicks();
     xp_decel = false;
     xn_decel = false;
     yp_decel = false;
@@ -44,9 +29,9 @@ Player::Player(int xPos, int yPos, int diff, SDL_Renderer *gRenderer)
 	bshot_heat = 0;
 	fshot_maxed = false;
 	bshot_maxed = false;
-	time_hit = SDL_GetTicks() - FLICKER_TIME;
-    time_since_f_shot=SDL_GetTicks();
-    time_since_b_shot=SDL_GetTicks();
+	time_hit = GameClock::getTicks() - FLICKER_TIME;
+    time_since_f_shot=GameClock::getTicks();
+    time_since_b_shot=GameClock::getTicks();
 	health = 100;
     difficulty = diff;
     infiniteShooting= false;
@@ -56,8 +41,8 @@ Player::Player(int xPos, int yPos, int diff, SDL_Renderer *gRenderer)
 
 Player::~Player()
 {
-	SDL_DestroyTexture(sprite1);
-	SDL_DestroyTexture(sprite2);
+	gAssets->releaseAnimation(ANIM_PLAYER);
+	gAssets->releaseAnimation(ANIM_PLAYER_HIT);
 }
 
 //Takes key presses and adjusts the player's velocity
@@ -148,18 +133,18 @@ void Player::move(int SCREEN_WIDTH, int SCREEN_HEIGHT, int LEVEL_HEIGHT, int cam
     else if (x_vel < -MAX_PLAYER_VEL)
         x_vel = -MAX_PLAYER_VEL;
 
-	time_since_move = SDL_GetTicks() - last_move;
-	if(infiniteShooting && SDL_GetTicks()-time_since_inf>INFINITE_TIME){
+	time_since_move = GameClock::getTicks() - last_move;
+	if(infiniteShooting && GameClock::getTicks()-time_since_inf>INFINITE_TIME){
         infiniteShooting=false;
     }
-    if(invincePower && SDL_GetTicks()-time_since_invincible>INVINCE_TIME){
+    if(invincePower && GameClock::getTicks()-time_since_invincible>INVINCE_TIME){
         invincePower=false;
     }
-    if(autoFire && SDL_GetTicks()-time_since_auto>AUTOFIRE_TIME){
+    if(autoFire && GameClock::getTicks()-time_since_auto>AUTOFIRE_TIME){
         autoFire=false;
     }
 	// Update heat of the front and back gun
-	if (fshot_maxed && SDL_GetTicks() - fshot_max_time > COOLDOWN_TIME) {
+	if (fshot_maxed && GameClock::getTicks() - fshot_max_time > COOLDOWN_TIME) {
 		if(fshot_heat <= 0){
             fshot_heat = 0;
             fshot_maxed = false;
@@ -172,7 +157,7 @@ void Player::move(int SCREEN_WIDTH, int SCREEN_HEIGHT, int LEVEL_HEIGHT, int cam
 		fshot_heat -= time_since_move * RECOVERY_RATE;
 		if (fshot_heat < 0) fshot_heat = 0;
 	}
-	if (bshot_maxed && SDL_GetTicks() - bshot_max_time > COOLDOWN_TIME) {
+	if (bshot_maxed && GameClock::getTicks() - bshot_max_time > COOLDOWN_TIME) {
 		if(bshot_heat <= 0){
             bshot_heat = 0;
             bshot_maxed = false;
@@ -237,25 +222,19 @@ void Player::move(int SCREEN_WIDTH, int SCREEN_HEIGHT, int LEVEL_HEIGHT, int cam
     {
         camY = LEVEL_HEIGHT - SCREEN_HEIGHT;
     }
-	last_move = SDL_GetTicks();
+	last_move = GameClock::getTicks();
 }
 
 //Shows the player on the screen relative to the camera
-void Player::render(SDL_Renderer *gRenderer, int SCREEN_WIDTH, int SCREEN_HEIGHT)
+void Player::render(RenderSnapshot *frame, int SCREEN_WIDTH, int SCREEN_HEIGHT)
 {
-	// Don't render the player if they're flickering after being hit
-	if ((SDL_GetTicks() - time_hit) <= FLICKER_TIME && ((SDL_GetTicks() - time_hit) / FLICKER_FREQ) % 2 == 0) {
-		return;
+	// Go back to flying once the flicker after being hit is over
+	if (animation.clip == ANIM_PLAYER_HIT && Animator::isFinished(animation)) {
+		animation = Animator::play(ANIM_PLAYER);
 	}
 
     SDL_Rect playerLocation = {(int) x_pos, (int) y_pos, PLAYER_WIDTH, PLAYER_HEIGHT};
-	// Alternates through the two sprites every ANIMATION_FREQ ticks
-    if ((SDL_GetTicks() / ANIMATION_FREQ) % 2 == 1) {
-		SDL_RenderCopyEx(gRenderer, sprite1, nullptr, &playerLocation, tiltAngle, nullptr, SDL_FLIP_NONE);
-	}
-	else {
-		SDL_RenderCopyEx(gRenderer, sprite2, nullptr, &playerLocation, tiltAngle, nullptr, SDL_FLIP_NONE);
-	}
+	Animator::draw(frame, animation, playerLocation, tiltAngle);
 }
 
 // Damages the player if they've been hit
@@ -268,10 +247,11 @@ void Player::hit(int damage) {
         else if(this->difficulty == 1){
             damage /= 2;
         }
-        if ((SDL_GetTicks() - time_hit) <= FLICKER_TIME) {
+        if ((GameClock::getTicks() - time_hit) <= FLICKER_TIME) {
 		    return;
 	    }
-	    time_hit = SDL_GetTicks();
+	    time_hit = GameClock::getTicks();
+	    animation = Animator::play(ANIM_PLAYER_HIT);
 	    health -= damage;
 	    if (health < 0) {
 	    	health = 0;
@@ -288,17 +268,17 @@ void Player::heal(int amount) {
 
 void Player::setInfiniteVal(bool val){
     infiniteShooting=val;
-    time_since_inf=SDL_GetTicks();
+    time_since_inf=GameClock::getTicks();
 }
 
 void Player::setInvinceVal(bool val){
     invincePower=val;
-    time_since_invincible=SDL_GetTicks();
+    time_since_invincible=GameClock::getTicks();
 }
 
 void Player::setAutoFire(bool val){
     autoFire=val;
-    time_since_auto=SDL_GetTicks();
+    time_since_auto=GameClock::getTicks();
 }
 
 void Player::resetHeatVals(){
@@ -330,8 +310,8 @@ bool Player::checkCollide(int x, int y, int pWidth, int pHeight, int xTwo, int y
 Bullet* Player::handleForwardFiring()
 {
     std::cout << "entered firing handler" << std::endl;
-    std::cout << "time since f shot = " << SDL_GetTicks()- time_since_f_shot << std::endl;
-	if (!fshot_maxed && (SDL_GetTicks()- time_since_f_shot) >= 100) {
+    std::cout << "time since f shot = " << GameClock::getTicks()- time_since_f_shot << std::endl;
+	if (!fshot_maxed && (GameClock::getTicks()- time_since_f_shot) >= 100) {
         std::cout << "Firing new bullet"<< std::endl;
 		Bullet* b = new Bullet(x_pos+PLAYER_WIDTH+5 -fabs(PLAYER_WIDTH/8*sin(tiltAngle)), y_pos+PLAYER_HEIGHT/2+PLAYER_HEIGHT*sin(tiltAngle), fabs(450*cos(tiltAngle)), tiltAngle >= 0 ? fabs(450*sin(tiltAngle)) : -fabs(450*sin(tiltAngle)));
         if(!infiniteShooting){
@@ -339,10 +319,10 @@ Bullet* Player::handleForwardFiring()
     		if (fshot_heat > MAX_SHOOT_HEAT) {
     			fshot_maxed = true;
     			fshot_heat = MAX_SHOOT_HEAT;
-    			fshot_max_time = SDL_GetTicks();
+    			fshot_max_time = GameClock::getTicks();
     		}
         }
-        time_since_f_shot = SDL_GetTicks();
+        time_since_f_shot = GameClock::getTicks();
 		return b;
 	}
 	return nullptr;
@@ -350,17 +330,17 @@ Bullet* Player::handleForwardFiring()
 
 Bullet* Player::handleBackwardFiring()
 {
-	if (!bshot_maxed && (SDL_GetTicks() - time_since_b_shot) >=100) {
+	if (!bshot_maxed && (GameClock::getTicks() - time_since_b_shot) >=100) {
 		Bullet* b = new Bullet(x_pos-10 +fabs(PLAYER_WIDTH/8*sin(tiltAngle)), y_pos+PLAYER_HEIGHT/2-PLAYER_HEIGHT*sin(tiltAngle), -fabs(450*cos(tiltAngle)), tiltAngle >= 0 ? -fabs(450*sin(tiltAngle)) : fabs(450*sin(tiltAngle)));
 		if(!infiniteShooting){
             bshot_heat += SHOOT_COST;
             if (bshot_heat > MAX_SHOOT_HEAT) {
                 bshot_maxed = true;
                 bshot_heat = MAX_SHOOT_HEAT;
-                bshot_max_time = SDL_GetTicks();
+                bshot_max_time = GameClock::getTicks();
             }
         }
-        time_since_b_shot = SDL_GetTicks();
+        time_since_b_shot = GameClock::getTicks();
 		return b;
 	}
 	return nullptr;
@@ -368,6 +348,7 @@ Bullet* Player::handleBackwardFiring()
 
 
 //Position and velocity accessors
+Uint32 Player::getEntityId() { return entityId; };
 int Player::getPosX() { return x_pos; };
 int Player::getPosY() { return y_pos; };
 void Player::setVelX(int vel_x) { x_vel = vel_x; };
@@ -6,6 +6,8 @@
 #include <SDL.h>
 #include <SDL_image.h>
 #include "bullet.h"
+#include "RenderSnapshot.h"
+#include "Animation.h"
 
 class Player
 {
@@ -29,9 +31,7 @@ public:
 	static const int INVINCE_TIME = 5000;
 	static const int AUTOFIRE_TIME = 4000;
 
-	// Animation frequency, the frequency with which the player flickers when hit, and the amount of time the player flickers after being hit
-	static const int ANIMATION_FREQ = 100;
-	static const int FLICKER_FREQ = 50;
+	// The amount of time the player flickers (and can't be hit again) after being hit
 	static const int FLICKER_TIME = 500;
 
 	// Move and shooting times, needed for framerate-independent movement and animation speeds
@@ -66,14 +66,10 @@ public:
     bool yp_decel;
     bool yn_decel;
 
-	// Sprites for the player
-	SDL_Texture* sprite1;
-	SDL_Texture* sprite2;
+	// Flying normally, or flickering after being hit
+	AnimationState animation;
 	int difficulty;
 
-	// Used to load sprites
-	SDL_Texture* loadImage(std::string fname, SDL_Renderer *gRenderer);
-
     //Initializes the variables
     Player(int xPos, int yPos, int diff, SDL_Renderer *gRenderer);
 	~Player();
@@ -85,7 +81,7 @@ public:
     void move(int SCREEN_WIDTH, int SCREEN_HEIGHT, int LEVEL_HEIGHT, int camY);
 
     //Shows the player on the screen relative to the camera
-    void render(SDL_Renderer *gRenderer, int SCREEN_WIDTH, int SCREEN_HEIGHT);
+    void render(RenderSnapshot *frame, int SCREEN_WIDTH, int SCREEN_HEIGHT);
 
 	// Damages the player when they've been hit
 	void hit(int damage);
@@ -116,6 +112,8 @@ public:
 	int getHealth();
 	int getFrontHeat();
 	int getBackHeat();
+	// Which anchor the render thread interpolates the player from
+	Uint32 getEntityId();
 	void setHealthMax();
 	void setInfiniteVal(bool);
 	void setInvinceVal (bool);
@@ -130,6 +128,8 @@ public:
 	void redoYMove();
 
 private:
+    Uint32 entityId;
+
     //The X and Y offsets of the player (ON SCREEN)
     double x_pos, y_pos;
 
@@ -0,0 +1,122 @@
+#include "RenderBackend.h"
+#include <SDL_image.h>
+#include <iostream>
+
+WindowBackend::WindowBackend()
+{
+	window = nullptr;
+	renderer = nullptr;
+}
+
+WindowBackend::~WindowBackend()
+{
+	if (renderer != nullptr) {
+		SDL_DestroyRenderer(renderer);
+	}
+	if (window != nullptr) {
+		SDL_DestroyWindow(window);
+	}
+}
+
+bool WindowBackend::open(const char* title, int w, int h, VSyncMode vsync)
+{
+	window = SDL_CreateWindow(title, SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, w, h, SDL_WINDOW_SHOWN | SDL_WINDOW_RESIZABLE);
+	if (window == nullptr) {
+		std::cout << "Window could not be created! SDL_Error: " << SDL_GetError() << std::endl;
+		return false;
+	}
+
+	renderer = SDL_CreateRenderer(window, -1, FramePacer::getRendererFlags(vsync));
+	if (renderer == nullptr) {
+		// Nothing could do what was asked for (usually vsync without a GPU), so settle for software
+		std::cout << "Unable to create renderer, falling back to software. SDL Error: " << SDL_GetError() << std::endl;
+		renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_SOFTWARE);
+	}
+	if (renderer == nullptr) {
+		std::cout << "Renderer could not be created! SDL_Error: " << SDL_GetError() << std::endl;
+		return false;
+	}
+	FramePacer::applyVSync(renderer, vsync);
+	// Mouse coordinates get mapped back to logical ones too, so the menus work at any window size
+	SDL_RenderSetLogicalSize(renderer, w, h);
+	return true;
+}
+
+SDL_Renderer* WindowBackend::getRenderer()
+{
+	return renderer;
+}
+
+SDL_Window* WindowBackend::getWindow()
+{
+	return window;
+}
+
+void WindowBackend::present()
+{
+	SDL_RenderPresent(renderer);
+}
+
+OffscreenBackend::OffscreenBackend(int w, int h)
+{
+	renderer = nullptr;
+	surface = SDL_CreateRGBSurfaceWithFormat(0, w, h, 32, SDL_PIXELFORMAT_ARGB8888);
+	if (surface == nullptr) {
+		std::cout << "Unable to create offscreen surface! SDL Error: " << SDL_GetError() << std::endl;
+		return;
+	}
+	renderer = SDL_CreateSoftwareRenderer(surface);
+	if (renderer == nullptr) {
+		std::cout << "Unable to create software renderer! SDL Error: " << SDL_GetError() << std::endl;
+	}
+}
+
+OffscreenBackend::~OffscreenBackend()
+{
+	if (renderer != nullptr) {
+		SDL_DestroyRenderer(renderer);
+	}
+	if (surface != nullptr) {
+		SDL_FreeSurface(surface);
+	}
+}
+
+SDL_Renderer* OffscreenBackend::getRenderer()
+{
+	return renderer;
+}
+
+void OffscreenBackend::present()
+{
+	// The software renderer draws straight into the surface; this only flushes any batched calls
+	SDL_RenderPresent(renderer);
+}
+
+SDL_Surface* OffscreenBackend::getSurface()
+{
+	return surface;
+}
+
+bool OffscreenBackend::savePNG(const std::string &path)
+{
+	if (IMG_SavePNG(surface, path.c_str()) != 0) {
+		std::cout << "Unable to save " << path << "! SDL Error: " << SDL_GetError() << std::endl;
+		return false;
+	}
+	return true;
+}
+
+Uint64 OffscreenBackend::hashPixels()
+{
+	Uint64 hash = 14695981039346656037ULL;
+	SDL_LockSurface(surface);
+	for (int y = 0; y < surface->h; y++) {
+		const Uint8* row = (const Uint8*) surface->pixels + y * surface->pitch;
+		for (int x = 0; x < surface->w * 4; x++) {
+			hash ^= row[x];
+			hash *= 1099511628211ULL;
+		}
+	}
+	SDL_UnlockSurface(surface);
+	return hash;
+}
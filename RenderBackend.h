@@ -0,0 +1,58 @@
+#ifndef RenderBackend_H
+#define RenderBackend_H
+
+#include <SDL.h>
+#include <string>
+#include "FramePacer.h"
+
+// Where frames end up. The game draws into a window; tests and benchmarks draw into an offscreen
+// surface with SDL's software renderer, which needs no display at all.
+class RenderBackend
+{
+public:
+	virtual ~RenderBackend() {}
+
+	virtual SDL_Renderer* getRenderer() = 0;
+	// Shows the finished frame
+	virtual void present() = 0;
+};
+
+class WindowBackend : public RenderBackend
+{
+public:
+	WindowBackend();
+	~WindowBackend();
+
+	// Creates a resizable window and an accelerated renderer for it, with w x h as the logical size
+	// everything is drawn in. Prints why and returns false on failure.
+	bool open(const char* title, int w, int h, VSyncMode vsync);
+
+	SDL_Renderer* getRenderer();
+	SDL_Window* getWindow();
+	void present();
+
+private:
+	SDL_Window* window;
+	SDL_Renderer* renderer;
+};
+
+class OffscreenBackend : public RenderBackend
+{
+public:
+	OffscreenBackend(int w, int h);
+	~OffscreenBackend();
+
+	SDL_Renderer* getRenderer();
+	void present();
+
+	SDL_Surface* getSurface();
+	bool savePNG(const std::string &path);
+	// FNV-1a over the visible pixels, so two runs can be compared without keeping images around
+	Uint64 hashPixels();
+
+private:
+	SDL_Surface* surface;
+	SDL_Renderer* renderer;
+};
+
+#endif
@@ -0,0 +1,271 @@
+#include "RenderSnapshot.h"
+#include "Text.h"
+#include <iostream>
+#include <cmath>
+#include <cstdlib>
+
+RenderSnapshot::RenderSnapshot()
+{
+	reset();
+}
+
+void RenderSnapshot::reset()
+{
+	commands.clear();
+	anchors.clear();
+	previousAnchors = nullptr;
+	publishedAt = 0;
+	tickLength = 0;
+	motionX = 0;
+	motionY = 0;
+	entityKey = 0;
+}
+
+DrawCommand& RenderSnapshot::add(DrawType type)
+{
+	commands.push_back(DrawCommand());
+	DrawCommand &command = commands.back();
+	command.type = type;
+	command.fullScreen = false;
+	command.texture = nullptr;
+	command.wholeTexture = true;
+	command.angle = 0.0;
+	command.font = nullptr;
+	command.motionX = motionX;
+	command.motionY = motionY;
+	return command;
+}
+
+void RenderSnapshot::clearScreen()
+{
+	add(DRAW_CLEAR);
+}
+
+void RenderSnapshot::setDrawColor(Uint8 r, Uint8 g, Uint8 b, Uint8 a)
+{
+	add(DRAW_COLOR).color = {r, g, b, a};
+}
+
+void RenderSnapshot::setBlendMode(SDL_BlendMode mode)
+{
+	add(DRAW_BLEND_MODE).blendMode = mode;
+}
+
+void RenderSnapshot::fillRect(const SDL_Rect &rect)
+{
+	add(DRAW_FILL_RECT).rect = rect;
+}
+
+void RenderSnapshot::drawRect(const SDL_Rect &rect)
+{
+	add(DRAW_RECT).rect = rect;
+}
+
+void RenderSnapshot::copy(SDL_Texture* texture, const SDL_Rect* dst, double angle)
+{
+	DrawCommand &command = add(DRAW_TEXTURE);
+	command.texture = texture;
+	command.angle = angle;
+	if (dst == nullptr) {
+		command.fullScreen = true;
+	}
+	else {
+		command.rect = *dst;
+	}
+}
+
+void RenderSnapshot::copy(SDL_Texture* texture, const SDL_Rect* src, const SDL_Rect* dst, double angle)
+{
+	copy(texture, dst, angle);
+	if (src != nullptr) {
+		DrawCommand &command = commands.back();
+		command.src = *src;
+		command.wholeTexture = false;
+	}
+}
+
+void RenderSnapshot::text(const std::string &message_text, const SDL_Color &color, TTF_Font* font, int x, int y)
+{
+	DrawCommand &command = add(DRAW_TEXT);
+	command.text = message_text;
+	command.color = color;
+	command.font = font;
+	command.rect = {x, y, 0, 0};
+}
+
+void RenderSnapshot::hud(const HudState &state, TTF_Font* font, int screenWidth, int screenHeight)
+{
+	DrawCommand &command = add(DRAW_HUD);
+	command.hud = state;
+	command.font = font;
+	command.rect = {0, 0, screenWidth, screenHeight};
+}
+
+void RenderSnapshot::setMotion(float dx, float dy)
+{
+	if (fabs(dx) > MAX_INTERPOLATED_MOTION || fabs(dy) > MAX_INTERPOLATED_MOTION) {
+		dx = 0;
+		dy = 0;
+	}
+	motionX = dx;
+	motionY = dy;
+}
+
+Uint32 RenderSnapshot::nextEntityId = 1;
+
+// Only the simulation spawns things, so this doesn't need to be atomic. 0 is never handed out.
+Uint32 RenderSnapshot::newEntityId()
+{
+	return nextEntityId++;
+}
+
+void RenderSnapshot::beginEntity(Uint32 id)
+{
+	entityKey = id;
+	entityStart = commands.size();
+}
+
+void RenderSnapshot::endEntity()
+{
+	// The first thing the entity drew with a position stands for all of it
+	for (int i = entityStart; i < commands.size(); i++) {
+		DrawCommand &command = commands[i];
+		if (command.type != DRAW_TEXTURE && command.type != DRAW_FILL_RECT && command.type != DRAW_RECT) {
+			continue;
+		}
+		SDL_Point anchor = {command.rect.x, command.rect.y};
+		anchors[entityKey] = anchor;
+
+		if (previousAnchors == nullptr) {
+			break;
+		}
+		std::map<Uint32, SDL_Point>::const_iterator previous = previousAnchors->find(entityKey);
+		if (previous == previousAnchors->end()) {
+			break;
+		}
+		int dx = anchor.x - previous->second.x;
+		int dy = anchor.y - previous->second.y;
+		if (abs(dx) > MAX_INTERPOLATED_MOTION || abs(dy) > MAX_INTERPOLATED_MOTION) {
+			break;
+		}
+		for (int j = entityStart; j < commands.size(); j++) {
+			commands[j].motionX += dx;
+			commands[j].motionY += dy;
+		}
+		break;
+	}
+	entityKey = 0;
+}
+
+double RenderSnapshot::getAlpha(Uint64 now) const
+{
+	if (tickLength == 0 || now >= publishedAt + tickLength) {
+		return 1.0;
+	}
+	return (double) (now - publishedAt) / tickLength;
+}
+
+SnapshotRenderer::SnapshotRenderer(SDL_Renderer* gRenderer, RotatedSpriteCache* rotations) : gRenderer{gRenderer}, rotations{rotations}
+{
+	hudLayer = nullptr;
+	frame = 0;
+}
+
+SnapshotRenderer::~SnapshotRenderer()
+{
+	delete hudLayer;
+	for (std::map<std::string, TextTexture>::iterator it = textCache.begin(); it != textCache.end(); ++it) {
+		SDL_DestroyTexture(it->second.texture);
+	}
+}
+
+void SnapshotRenderer::draw(const RenderSnapshot &snapshot, double alpha)
+{
+	frame++;
+	SDL_SetRenderDrawBlendMode(gRenderer, SDL_BLENDMODE_NONE);
+	// Where things are drawn is wound back by the part of this tick's motion that hasn't happened yet
+	float behind = (float) (1.0 - alpha);
+	for (int i = 0; i < snapshot.commands.size(); i++) {
+		const DrawCommand &command = snapshot.commands[i];
+		SDL_Rect rect = command.rect;
+		if (behind > 0) {
+			rect.x -= (int) floor(command.motionX * behind + 0.5f);
+			rect.y -= (int) floor(command.motionY * behind + 0.5f);
+		}
+		const SDL_Rect* dst = command.fullScreen ? nullptr : &rect;
+		const SDL_Rect* src = command.wholeTexture ? nullptr : &command.src;
+		switch (command.type) {
+			case DRAW_CLEAR:
+				SDL_RenderClear(gRenderer);
+				break;
+			case DRAW_COLOR:
+				SDL_SetRenderDrawColor(gRenderer, command.color.r, command.color.g, command.color.b, command.color.a);
+				break;
+			case DRAW_BLEND_MODE:
+				SDL_SetRenderDrawBlendMode(gRenderer, command.blendMode);
+				break;
+			case DRAW_FILL_RECT:
+				SDL_RenderFillRect(gRenderer, &rect);
+				break;
+			case DRAW_RECT:
+				SDL_RenderDrawRect(gRenderer, &rect);
+				break;
+			case DRAW_TEXTURE:
+				if (rotations != nullptr && !command.fullScreen && rotations->draw(command.texture, src, rect, command.angle)) {
+					break;
+				}
+				if (command.angle == 0.0) {
+					SDL_RenderCopy(gRenderer, command.texture, src, dst);
+				}
+				else {
+					SDL_RenderCopyEx(gRenderer, command.texture, src, dst, command.angle, nullptr, SDL_FLIP_NONE);
+				}
+				break;
+			case DRAW_TEXT: {
+				TextTexture* text = getText(command);
+				if (text != nullptr) {
+					SDL_Rect text_rect = {rect.x, rect.y, text->w, text->h};
+					SDL_RenderCopy(gRenderer, text->texture, nullptr, &text_rect);
+				}
+				break;
+			}
+			case DRAW_HUD:
+				if (hudLayer == nullptr) {
+					hudLayer = new HudLayer(gRenderer, command.font, command.rect.w, command.rect.h);
+				}
+				hudLayer->draw(command.hud);
+				break;
+		}
+	}
+
+	// Text that wasn't drawn this frame (an old score, say) won't be drawn again
+	for (std::map<std::string, TextTexture>::iterator it = textCache.begin(); it != textCache.end();) {
+		if (it->second.lastUsed != frame) {
+			SDL_DestroyTexture(it->second.texture);
+			textCache.erase(it++);
+		}
+		else {
+			++it;
+		}
+	}
+}
+
+SnapshotRenderer::TextTexture* SnapshotRenderer::getText(const DrawCommand &command)
+{
+	std::string key = command.text;
+	key.append((const char*) &command.font, sizeof(command.font));
+	key.append((const char*) &command.color, sizeof(command.color));
+
+	std::map<std::string, TextTexture>::iterator it = textCache.find(key);
+	if (it == textCache.end()) {
+		TextTexture text;
+		text.texture = Text::loadFont(gRenderer, command.text, command.color, command.font);
+		if (text.texture == nullptr) {
+			return nullptr;
+		}
+		SDL_QueryTexture(text.texture, nullptr, nullptr, &text.w, &text.h);
+		it = textCache.insert(std::make_pair(key, text)).first;
+	}
+	it->second.lastUsed = frame;
+	return &it->second;
+}
@@ -0,0 +1,137 @@
+#ifndef RenderSnapshot_H
+#define RenderSnapshot_H
+
+#include <SDL.h>
+#include <SDL_ttf.h>
+#include <string>
+#include <vector>
+#include <map>
+#include "RotatedSpriteCache.h"
+#include "HudLayer.h"
+
+enum DrawType
+{
+	DRAW_CLEAR,
+	DRAW_COLOR,
+	DRAW_BLEND_MODE,
+	DRAW_FILL_RECT,
+	DRAW_RECT,
+	DRAW_TEXTURE,
+	DRAW_TEXT,
+	DRAW_HUD
+};
+
+// One recorded renderer call. Only the fields its type needs are filled in.
+struct DrawCommand
+{
+	DrawType type;
+	SDL_Rect rect;
+	bool fullScreen;
+	SDL_Color color;
+	SDL_BlendMode blendMode;
+	SDL_Texture* texture;
+	// Part of the texture to draw, unless wholeTexture is set
+	SDL_Rect src;
+	bool wholeTexture;
+	double angle;
+	TTF_Font* font;
+	std::string text;
+	HudState hud;
+	// How far the command's rect moved since the previous tick, for drawing in between ticks
+	float motionX, motionY;
+};
+
+// Everything needed to draw one frame of the game, recorded by the simulation and drawn later by
+// whoever owns the renderer. The calls mirror the SDL ones they replace. Textures are only referenced,
+// so anything drawn has to stay alive until the snapshot has been drawn; the asset cache guarantees
+// that for sprites.
+//
+// Snapshots also carry how far everything moved during the tick, so the drawing side can place things
+// between this tick and the previous one when it presents more often than the simulation ticks.
+class RenderSnapshot
+{
+public:
+	// Anything that moves further than this in one tick (respawned, restarted) jumps instead
+	static const int MAX_INTERPOLATED_MOTION = 100;
+
+	std::vector<DrawCommand> commands;
+
+	// When the snapshot was published and how long the tick before it took, in performance counter
+	// units. A tick length of 0 turns interpolation off.
+	Uint64 publishedAt;
+	Uint64 tickLength;
+
+	// Where each entity was drawn this tick, and the previous tick's positions to compare against
+	std::map<Uint32, SDL_Point> anchors;
+	const std::map<Uint32, SDL_Point>* previousAnchors;
+
+	RenderSnapshot();
+
+	// Empties the snapshot so it can be recorded again without reallocating
+	void reset();
+
+	void clearScreen();
+	void setDrawColor(Uint8 r, Uint8 g, Uint8 b, Uint8 a);
+	void setBlendMode(SDL_BlendMode mode);
+	void fillRect(const SDL_Rect &rect);
+	void drawRect(const SDL_Rect &rect);
+	// dst == nullptr stretches the texture over the whole screen
+	void copy(SDL_Texture* texture, const SDL_Rect* dst, double angle = 0.0);
+	// Draws only src out of the texture, e.g. one frame of a sprite sheet
+	void copy(SDL_Texture* texture, const SDL_Rect* src, const SDL_Rect* dst, double angle = 0.0);
+	// Text is turned into a texture by the drawing side, which keeps it around while it doesn't change
+	void text(const std::string &message_text, const SDL_Color &color, TTF_Font* font, int x, int y);
+	// The HUD is drawn from its own layer, which only redraws the values that changed
+	void hud(const HudState &state, TTF_Font* font, int screenWidth, int screenHeight);
+
+	// Everything recorded from now on moved by dx, dy this tick, like the level scrolling past
+	void setMotion(float dx, float dy);
+	// Commands recorded between these belong to one moving object. Its motion is worked out from where
+	// its first rect was in the previous snapshot under the same id.
+	void beginEntity(Uint32 id);
+	void endEntity();
+	// A fresh id for beginEntity. Things take a new one each time they spawn, so one spawned where
+	// another just died (or at its address) doesn't look like it moved from there.
+	static Uint32 newEntityId();
+
+	// How far between the previous tick and this one a frame drawn at time now falls, from 0 to 1
+	double getAlpha(Uint64 now) const;
+
+private:
+	float motionX, motionY;
+	Uint32 entityKey;
+	int entityStart;
+	static Uint32 nextEntityId;
+
+	DrawCommand& add(DrawType type);
+};
+
+// Draws snapshots with a renderer. Owns the textures made for text commands and the HUD layer. Sprites that are in
+// the rotation cache (if there is one) are drawn from it instead of being rotated and scaled.
+class SnapshotRenderer
+{
+public:
+	SnapshotRenderer(SDL_Renderer* gRenderer, RotatedSpriteCache* rotations = nullptr);
+	~SnapshotRenderer();
+
+	// Draws everything alpha of the way from where it was the previous tick to where it is now
+	void draw(const RenderSnapshot &snapshot, double alpha = 1.0);
+
+private:
+	struct TextTexture
+	{
+		SDL_Texture* texture;
+		int w, h;
+		int lastUsed;
+	};
+
+	SDL_Renderer* gRenderer;
+	RotatedSpriteCache* rotations;
+	HudLayer* hudLayer;
+	std::map<std::string, TextTexture> textCache;
+	int frame;
+
+	TextTexture* getText(const DrawCommand &command);
+};
+
+#endif
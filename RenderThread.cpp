@@ -0,0 +1,154 @@
+#include "RenderThread.h"
+#include "ResolutionScaler.h"
+#include "Screen.h"
+#include <iostream>
+
+RenderThread::RenderThread()
+{
+	writeSlot = 0;
+	readSlot = 1;
+	SDL_AtomicSet(&sharedSlot, 2);
+	gRenderer = nullptr;
+	rotations = nullptr;
+	interpolate = true;
+	dynamicResolution = true;
+	lastPublish = 0;
+	thread = nullptr;
+	published = SDL_CreateSemaphore(0);
+	SDL_AtomicSet(&running, 0);
+	SDL_AtomicSet(&framesPresented, 0);
+}
+
+RenderThread::~RenderThread()
+{
+	stop();
+	SDL_DestroySemaphore(published);
+}
+
+void RenderThread::start(SDL_Renderer *gRenderer)
+{
+	if (thread != nullptr) {
+		return;
+	}
+	this->gRenderer = gRenderer;
+	SDL_AtomicSet(&running, 1);
+	thread = SDL_CreateThread(renderLoop, "Render", this);
+	if (thread == nullptr) {
+		std::cout << "Unable to create render thread! SDL Error: " << SDL_GetError() << std::endl;
+		SDL_AtomicSet(&running, 0);
+	}
+}
+
+void RenderThread::stop()
+{
+	if (thread == nullptr) {
+		return;
+	}
+	SDL_AtomicSet(&running, 0);
+	SDL_SemPost(published);
+	SDL_WaitThread(thread, nullptr);
+	thread = nullptr;
+}
+
+bool RenderThread::isRunning()
+{
+	return thread != nullptr;
+}
+
+RenderSnapshot* RenderThread::beginFrame()
+{
+	snapshots[writeSlot].reset();
+	snapshots[writeSlot].previousAnchors = &lastAnchors;
+	return &snapshots[writeSlot];
+}
+
+void RenderThread::publish()
+{
+	if (thread == nullptr) {
+		// Nobody to draw it; keep recording into the same slot
+		lastPublish = 0;
+		return;
+	}
+
+	RenderSnapshot &snapshot = snapshots[writeSlot];
+	Uint64 now = SDL_GetPerformanceCounter();
+	// After a pause or a stall, start again from the new positions rather than sliding into them
+	if (interpolate && lastPublish != 0 && now - lastPublish < SDL_GetPerformanceFrequency() / 10) {
+		snapshot.tickLength = now - lastPublish;
+	}
+	snapshot.publishedAt = now;
+	snapshot.previousAnchors = nullptr;
+	lastAnchors.swap(snapshot.anchors);
+	lastPublish = now;
+
+	// Swap the finished snapshot in and take back whichever slot was there, drawn or not
+	writeSlot = SDL_AtomicSet(&sharedSlot, writeSlot | FRESH) & ~FRESH;
+	SDL_SemPost(published);
+}
+
+int RenderThread::getFramesPresented()
+{
+	return SDL_AtomicGet(&framesPresented);
+}
+
+void RenderThread::setTargetFPS(int targetFPS)
+{
+	pacer.setTargetFPS(targetFPS);
+}
+
+void RenderThread::setSpriteCache(RotatedSpriteCache* rotations)
+{
+	this->rotations = rotations;
+}
+
+void RenderThread::setInterpolation(bool interpolate)
+{
+	this->interpolate = interpolate;
+}
+
+void RenderThread::setDynamicResolution(bool dynamicResolution)
+{
+	this->dynamicResolution = dynamicResolution;
+}
+
+int RenderThread::renderLoop(void* data)
+{
+	RenderThread* rt = (RenderThread*) data;
+	SnapshotRenderer drawer(rt->gRenderer, rt->rotations);
+	ResolutionScaler* scaler = nullptr;
+	if (rt->dynamicResolution) {
+		scaler = new ResolutionScaler(rt->gRenderer, SCREEN_WIDTH, SCREEN_HEIGHT, rt->pacer.getTargetFPS());
+	}
+	bool have_snapshot = false;
+	double alpha = 1.0;
+
+	while (SDL_AtomicGet(&rt->running)) {
+		// Until the last snapshot has been drawn all the way to its own tick, there's no need to wait
+		bool caught_up = !have_snapshot || alpha >= 1.0;
+		if (caught_up) {
+			SDL_SemWaitTimeout(rt->published, 100);
+		}
+		// Several publishes may have piled up while presenting; one draw covers them all
+		while (SDL_SemTryWait(rt->published) == 0) {}
+
+		if (SDL_AtomicGet(&rt->sharedSlot) & FRESH) {
+			rt->readSlot = SDL_AtomicSet(&rt->sharedSlot, rt->readSlot) & ~FRESH;
+			have_snapshot = true;
+		}
+		else if (caught_up) {
+			continue;
+		}
+
+		const RenderSnapshot &snapshot = rt->snapshots[rt->readSlot];
+		alpha = snapshot.getAlpha(SDL_GetPerformanceCounter());
+		if (scaler != nullptr) scaler->beginFrame();
+		drawer.draw(snapshot, alpha);
+		if (scaler != nullptr) scaler->endFrame();
+		SDL_RenderPresent(rt->gRenderer);
+		if (scaler != nullptr) scaler->framePresented();
+		SDL_AtomicAdd(&rt->framesPresented, 1);
+		rt->pacer.wait();
+	}
+	delete scaler;
+	return 0;
+}
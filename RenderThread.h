@@ -0,0 +1,74 @@
+#ifndef RenderThread_H
+#define RenderThread_H
+
+#include <SDL.h>
+#include "RenderSnapshot.h"
+#include "FramePacer.h"
+
+// Draws the game on its own thread so a slow SDL_RenderPresent or driver stall doesn't hold up
+// input and physics. The simulation records a RenderSnapshot each tick and publishes it; the render
+// thread always draws the newest one and skips any it fell behind on. When it presents faster than
+// the simulation ticks, it keeps drawing the newest snapshot with everything moved part of the way
+// from the previous tick, so motion stays smooth.
+//
+// Snapshots are handed over through a lock-free triple buffer: the simulation owns one slot, the
+// render thread owns another, and the third holds the newest published snapshot. Publishing and
+// picking up are a single atomic swap each, so neither side ever waits on the other.
+//
+// The renderer is lent to the thread between start() and stop(). Screens that draw directly (the
+// restart menu, the credits) stop the thread first and get the renderer back.
+class RenderThread
+{
+public:
+	RenderThread();
+	~RenderThread();
+
+	void start(SDL_Renderer *gRenderer);
+	// Blocks until the thread has finished its frame and let go of the renderer
+	void stop();
+	bool isRunning();
+
+	// The snapshot to record this tick into, already emptied
+	RenderSnapshot* beginFrame();
+	// Makes the snapshot from beginFrame() the one the render thread draws next
+	void publish();
+
+	// Frames actually presented, for the FPS counter
+	int getFramesPresented();
+
+	// Caps how often the thread presents, on top of any vsync. Set it before start().
+	void setTargetFPS(int targetFPS);
+	// Sprites to draw pre-rotated instead of with SDL_RenderCopyEx. Set it before start().
+	void setSpriteCache(RotatedSpriteCache* rotations);
+	// Draws between ticks (on by default). Set it before start().
+	void setInterpolation(bool interpolate);
+	// Lowers the internal resolution when frames run over budget (on by default). Set it before start().
+	void setDynamicResolution(bool dynamicResolution);
+
+private:
+	// Bit set in the shared slot index when it holds a snapshot the render thread hasn't drawn
+	static const int FRESH = 4;
+
+	RenderSnapshot snapshots[3];
+	int writeSlot;				// Only touched by the simulation
+	int readSlot;				// Only touched by the render thread
+	SDL_atomic_t sharedSlot;	// Slot index | FRESH
+
+	SDL_Renderer *gRenderer;
+	SDL_Thread *thread;
+	SDL_sem *published;
+	SDL_atomic_t running;
+	SDL_atomic_t framesPresented;
+	FramePacer pacer;
+	RotatedSpriteCache* rotations;
+	bool interpolate;
+	bool dynamicResolution;
+
+	// Only touched by the simulation: the last publish, and where entities were in it
+	Uint64 lastPublish;
+	std::map<Uint32, SDL_Point> lastAnchors;
+
+	static int renderLoop(void* data);
+};
+
+#endif
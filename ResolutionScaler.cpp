@@ -0,0 +1,102 @@
+#include "ResolutionScaler.h"
+#include "FramePacer.h"
+#include <iostream>
+
+ResolutionScaler::ResolutionScaler(SDL_Renderer *gRenderer, int logicalWidth, int logicalHeight, int targetFPS) : gRenderer{gRenderer}, logicalWidth{logicalWidth}, logicalHeight{logicalHeight}
+{
+	if (targetFPS <= 0) {
+		targetFPS = FramePacer::DEFAULT_TARGET_FPS;
+	}
+	budgetMS = 1000.0 / targetFPS;
+	scalePercent = 100;
+	scaled = false;
+	frameStart = 0;
+	sampleMS = 0;
+	samples = 0;
+	lastChange = SDL_GetTicks();
+	lastRaised = false;
+	probeMS = PROBE_MS;
+
+	target = SDL_CreateTexture(gRenderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET, logicalWidth, logicalHeight);
+	if (target == nullptr) {
+		std::cout << "Unable to create internal render target, resolution stays fixed! SDL Error: " << SDL_GetError() << std::endl;
+	}
+}
+
+ResolutionScaler::~ResolutionScaler()
+{
+	if (target != nullptr) {
+		SDL_DestroyTexture(target);
+	}
+}
+
+void ResolutionScaler::beginFrame()
+{
+	frameStart = SDL_GetPerformanceCounter();
+	scaled = target != nullptr && scalePercent < 100;
+	if (!scaled) {
+		return;
+	}
+	// Switching targets resets the scale, so set it afterwards
+	SDL_SetRenderTarget(gRenderer, target);
+	SDL_RenderSetScale(gRenderer, scalePercent / 100.0f, scalePercent / 100.0f);
+}
+
+void ResolutionScaler::endFrame()
+{
+	if (!scaled) {
+		return;
+	}
+	SDL_SetRenderTarget(gRenderer, nullptr);
+	SDL_Rect drawn = {0, 0, logicalWidth * scalePercent / 100, logicalHeight * scalePercent / 100};
+	SDL_RenderCopy(gRenderer, target, &drawn, nullptr);
+}
+
+void ResolutionScaler::framePresented()
+{
+	if (target == nullptr) {
+		return;
+	}
+	sampleMS += (SDL_GetPerformanceCounter() - frameStart) * 1000.0 / SDL_GetPerformanceFrequency();
+	if (++samples < SAMPLE_FRAMES) {
+		return;
+	}
+	double average = sampleMS / samples;
+	sampleMS = 0;
+	samples = 0;
+
+	// A little slack either way, so the scale doesn't flip back and forth on frames right at the budget
+	if (average > budgetMS * 1.1 && scalePercent > MIN_SCALE_PERCENT) {
+		// Going straight back down after going up means the probe failed; wait longer next time
+		if (lastRaised && probeMS < MAX_PROBE_MS) {
+			probeMS *= 2;
+		}
+		setScale(scalePercent - SCALE_STEP_PERCENT);
+		lastRaised = false;
+	}
+	else if (scalePercent < 100 && average < budgetMS * 0.75) {
+		probeMS = PROBE_MS;
+		setScale(scalePercent + SCALE_STEP_PERCENT);
+		lastRaised = true;
+	}
+	else if (scalePercent < 100 && SDL_GetTicks() - lastChange > probeMS) {
+		setScale(scalePercent + SCALE_STEP_PERCENT);
+		lastRaised = true;
+	}
+	else {
+		lastRaised = false;
+	}
+}
+
+int ResolutionScaler::getScalePercent()
+{
+	return scalePercent;
+}
+
+void ResolutionScaler::setScale(int percent)
+{
+	if (percent < MIN_SCALE_PERCENT) percent = MIN_SCALE_PERCENT;
+	if (percent > 100) percent = 100;
+	scalePercent = percent;
+	lastChange = SDL_GetTicks();
+}
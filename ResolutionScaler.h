@@ -0,0 +1,55 @@
+#ifndef ResolutionScaler_H
+#define ResolutionScaler_H
+
+#include <SDL.h>
+
+// Lowers the resolution the game is drawn at while frames take longer than the frame budget, and
+// raises it again once there is room. A lowered frame is drawn at a smaller scale into the top left
+// of an internal target and then stretched over the screen, so drawing code keeps working in logical
+// coordinates. At full scale frames go straight to the screen.
+//
+// Frame times include presenting, which with vsync on always fills the budget, so the scale is also
+// nudged back up every so often and kept there only if frames stay within budget.
+// Only used from the render thread.
+class ResolutionScaler
+{
+public:
+	static const int MIN_SCALE_PERCENT = 50;
+	static const int SCALE_STEP_PERCENT = 10;
+	// Frames averaged before deciding
+	static const int SAMPLE_FRAMES = 20;
+	// How long a lowered scale is kept before trying the next one up. Doubles each time trying fails.
+	static const int PROBE_MS = 3000;
+	static const int MAX_PROBE_MS = 60000;
+
+	ResolutionScaler(SDL_Renderer *gRenderer, int logicalWidth, int logicalHeight, int targetFPS);
+	~ResolutionScaler();
+
+	// Points drawing at the internal target if the scale is lowered
+	void beginFrame();
+	// Stretches a lowered frame over the screen. Call before presenting.
+	void endFrame();
+	// Call once the frame has been presented
+	void framePresented();
+
+	int getScalePercent();
+
+private:
+	SDL_Renderer *gRenderer;
+	SDL_Texture *target;
+	int logicalWidth, logicalHeight;
+	double budgetMS;
+	int scalePercent;
+	bool scaled;
+
+	Uint64 frameStart;
+	double sampleMS;
+	int samples;
+	Uint32 lastChange;
+	bool lastRaised;
+	int probeMS;
+
+	void setScale(int percent);
+};
+
+#endif
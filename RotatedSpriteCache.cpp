@@ -0,0 +1,136 @@
+#include "RotatedSpriteCache.h"
+#include <iostream>
+#include <cmath>
+
+bool RotatedSpriteCache::SpriteKey::operator<(const SpriteKey &other) const
+{
+	if (texture != other.texture) return texture < other.texture;
+	if (srcX != other.srcX) return srcX < other.srcX;
+	if (srcY != other.srcY) return srcY < other.srcY;
+	if (w != other.w) return w < other.w;
+	return h < other.h;
+}
+
+RotatedSpriteCache::RotatedSpriteCache(SDL_Renderer *gRenderer) : gRenderer{gRenderer}
+{
+	memoryUsage = 0;
+}
+
+RotatedSpriteCache::~RotatedSpriteCache()
+{
+	for (std::map<SpriteKey, RotationSet>::iterator it = sprites.begin(); it != sprites.end(); ++it) {
+		for (int i = 0; i < it->second.angles.size(); i++) {
+			if (it->second.angles[i].texture != nullptr) {
+				SDL_DestroyTexture(it->second.angles[i].texture);
+			}
+		}
+	}
+}
+
+bool RotatedSpriteCache::isSoftware(SDL_Renderer *gRenderer)
+{
+	SDL_RendererInfo info;
+	if (SDL_GetRendererInfo(gRenderer, &info) != 0) {
+		return false;
+	}
+	return (info.flags & SDL_RENDERER_SOFTWARE) != 0;
+}
+
+RotatedSpriteCache::SpriteKey RotatedSpriteCache::makeKey(SDL_Texture* texture, const SDL_Rect* src, int w, int h)
+{
+	SpriteKey key = {texture, 0, 0, w, h};
+	if (src != nullptr) {
+		key.srcX = src->x;
+		key.srcY = src->y;
+	}
+	return key;
+}
+
+void RotatedSpriteCache::prerender(SDL_Texture* texture, const SDL_Rect* src, int w, int h, int minAngle, int maxAngle)
+{
+	if (texture == nullptr) {
+		return;
+	}
+	SpriteKey key = makeKey(texture, src, w, h);
+	if (sprites.count(key)) {
+		return;
+	}
+
+	RotationSet set;
+	set.minAngle = minAngle;
+	set.wraps = maxAngle - minAngle >= 360;
+	if (set.wraps) {
+		maxAngle = minAngle + 360 - ANGLE_STEP;
+	}
+
+	SDL_Texture* old_target = SDL_GetRenderTarget(gRenderer);
+	for (int angle = minAngle; angle <= maxAngle; angle += ANGLE_STEP) {
+		set.angles.push_back(renderRotation(texture, src, w, h, angle));
+	}
+	SDL_SetRenderTarget(gRenderer, old_target);
+
+	sprites[key] = set;
+}
+
+RotatedSpriteCache::RotatedSprite RotatedSpriteCache::renderRotation(SDL_Texture* texture, const SDL_Rect* src, int w, int h, double angle)
+{
+	// Big enough to hold the rotated sprite, plus a pixel each side for the filtered edge
+	double radians = angle * M_PI / 180.0;
+	RotatedSprite rotated;
+	rotated.w = (int) ceil(fabs(w * cos(radians)) + fabs(h * sin(radians))) + 2;
+	rotated.h = (int) ceil(fabs(w * sin(radians)) + fabs(h * cos(radians))) + 2;
+	rotated.texture = SDL_CreateTexture(gRenderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET, rotated.w, rotated.h);
+	if (rotated.texture == nullptr) {
+		std::cout << "Unable to create rotated sprite! SDL Error: " << SDL_GetError() << std::endl;
+		return rotated;
+	}
+	SDL_SetTextureBlendMode(rotated.texture, SDL_BLENDMODE_BLEND);
+
+	SDL_SetRenderTarget(gRenderer, rotated.texture);
+	SDL_SetRenderDrawBlendMode(gRenderer, SDL_BLENDMODE_NONE);
+	SDL_SetRenderDrawColor(gRenderer, 0x00, 0x00, 0x00, 0x00);
+	SDL_RenderClear(gRenderer);
+	// Copy the sprite's alpha as is rather than blending it onto the transparent target, which would
+	// darken the soft edges when the copy is blended again at draw time
+	SDL_BlendMode blend_mode;
+	SDL_GetTextureBlendMode(texture, &blend_mode);
+	SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_NONE);
+	SDL_Rect centered = {(rotated.w - w) / 2, (rotated.h - h) / 2, w, h};
+	SDL_RenderCopyEx(gRenderer, texture, src, &centered, angle, nullptr, SDL_FLIP_NONE);
+	SDL_SetTextureBlendMode(texture, blend_mode);
+
+	memoryUsage += (size_t) rotated.w * rotated.h * 4;
+	return rotated;
+}
+
+bool RotatedSpriteCache::draw(SDL_Texture* texture, const SDL_Rect* src, const SDL_Rect &dst, double angle)
+{
+	SpriteKey key = makeKey(texture, src, dst.w, dst.h);
+	std::map<SpriteKey, RotationSet>::iterator it = sprites.find(key);
+	if (it == sprites.end()) {
+		return false;
+	}
+	RotationSet &set = it->second;
+
+	int index = (int) floor((angle - set.minAngle) / ANGLE_STEP + 0.5);
+	int count = set.angles.size();
+	if (set.wraps) {
+		index = ((index % count) + count) % count;
+	}
+	else if (index < 0 || index >= count) {
+		return false;
+	}
+
+	RotatedSprite &rotated = set.angles[index];
+	if (rotated.texture == nullptr) {
+		return false;
+	}
+	SDL_Rect centered = {dst.x + (dst.w - rotated.w) / 2, dst.y + (dst.h - rotated.h) / 2, rotated.w, rotated.h};
+	SDL_RenderCopy(gRenderer, rotated.texture, nullptr, &centered);
+	return true;
+}
+
+size_t RotatedSpriteCache::getMemoryUsage()
+{
+	return memoryUsage;
+}
@@ -0,0 +1,64 @@
+#ifndef RotatedSpriteCache_H
+#define RotatedSpriteCache_H
+
+#include <SDL.h>
+#include <map>
+#include <vector>
+
+// Without a GPU, SDL's software renderer rotates and scales every SDL_RenderCopyEx on the CPU, every
+// frame. This cache draws each rotatable sprite once per ANGLE_STEP degrees at the exact size it is
+// shown at, so the hot path becomes a plain unscaled blit of the closest pre-rotated copy.
+class RotatedSpriteCache
+{
+public:
+	static const int ANGLE_STEP = 3;
+
+	RotatedSpriteCache(SDL_Renderer *gRenderer);
+	~RotatedSpriteCache();
+
+	// True when the renderer draws on the CPU, which is the only case the cache is worth its memory
+	static bool isSoftware(SDL_Renderer *gRenderer);
+
+	// Renders src out of texture (all of it if src is nullptr) at w x h for every step from minAngle to
+	// maxAngle (degrees, inclusive). A range of 360 degrees or more wraps around. Must be called by
+	// whoever holds the renderer.
+	void prerender(SDL_Texture* texture, const SDL_Rect* src, int w, int h, int minAngle, int maxAngle);
+
+	// Draws the cached copy closest to angle, centred on dst. Returns false (drawing nothing) if the
+	// sprite wasn't prerendered at that size and angle.
+	bool draw(SDL_Texture* texture, const SDL_Rect* src, const SDL_Rect &dst, double angle);
+
+	size_t getMemoryUsage();
+
+private:
+	struct SpriteKey
+	{
+		SDL_Texture* texture;
+		// Top left of the sprite in the texture, for sprite sheets
+		int srcX, srcY;
+		int w, h;
+		bool operator<(const SpriteKey &other) const;
+	};
+
+	struct RotatedSprite
+	{
+		SDL_Texture* texture;
+		int w, h;
+	};
+
+	struct RotationSet
+	{
+		int minAngle;
+		bool wraps;
+		std::vector<RotatedSprite> angles;
+	};
+
+	SDL_Renderer *gRenderer;
+	std::map<SpriteKey, RotationSet> sprites;
+	size_t memoryUsage;
+
+	RotatedSprite renderRotation(SDL_Texture* texture, const SDL_Rect* src, int w, int h, double angle);
+	static SpriteKey makeKey(SDL_Texture* texture, const SDL_Rect* src, int w, int h);
+};
+
+#endif
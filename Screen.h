@@ -0,0 +1,11 @@
+#ifndef Screen_H
+#define Screen_H
+
+// The game's logical resolution. Everything is laid out, simulated and recorded in these coordinates;
+// the renderer scales them to the window, and to a smaller internal resolution when frames run long.
+constexpr int SCREEN_WIDTH = 1280;
+constexpr int SCREEN_HEIGHT = 720;
+// How long the menus sleep waiting for input once there is nothing left to animate
+constexpr int MENU_IDLE_TIMEOUT = 500;
+
+#endif
@@ -30,7 +30,7 @@ void StartScreen::handleEvent(SDL_Event&e)
 
 void StartScreen::render(SDL_Renderer *gRenderer)
 {
-	SDL_Rect bgRect = {0,0, 1280, 720};
+	SDL_Rect bgRect = {0,0, SCREEN_WIDTH, SCREEN_HEIGHT};
 	SDL_RenderCopy(gRenderer, gBackground, nullptr, &bgRect);
 
 	SDL_Rect fillRectButton = {START_BUTTON_X, START_BUTTON_Y, START_BUTTON_WIDTH, START_BUTTON_HEIGHT};
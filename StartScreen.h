@@ -3,6 +3,7 @@
 
 #include <SDL.h>
 #include "Player.h"
+#include "Screen.h"
 
 class StartScreen
 {
@@ -10,8 +11,8 @@ public:
     StartScreen(SDL_Texture *start, SDL_Texture *btn);
     static const int START_BUTTON_WIDTH = 250;
     static const int START_BUTTON_HEIGHT = 80;
-    static const int START_BUTTON_X = 1280 - 400;
-    static const int START_BUTTON_Y = 720 - 150;
+    static const int START_BUTTON_X = SCREEN_WIDTH - 400;
+    static const int START_BUTTON_Y = SCREEN_HEIGHT - 150;
     
     bool notStarted = true;
 
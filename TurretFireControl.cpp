@@ -0,0 +1,65 @@
+#include "TurretFireControl.h"
+#include <cmath>
+
+void TurretFireControl::arm(int id, Uint32 readyAt)
+{
+	due.push(Entry(readyAt, id));
+}
+
+bool TurretFireControl::nextDue(Uint32 now, int &id)
+{
+	if (due.empty() || due.top().first > now) {
+		return false;
+	}
+	id = due.top().second;
+	due.pop();
+	return true;
+}
+
+void TurretFireControl::clear()
+{
+	due = std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry> >();
+}
+
+void TurretFireControl::aim(double rx, double ry, double wx, double wy, double speed, double &xVel, double &yVel)
+{
+	// The shot meets the target at the first time t > 0 where |r + w t| = speed t:
+	// (w.w - speed^2) t^2 + 2 (r.w) t + r.r = 0
+	double a = wx * wx + wy * wy - speed * speed;
+	double b = rx * wx + ry * wy;
+	double c = rx * rx + ry * ry;
+	double t = -1;
+	if (std::fabs(a) < 1e-9) {
+		// As fast as the shot; only catchable if it is coming this way
+		if (b < 0) {
+			t = -c / (2 * b);
+		}
+	}
+	else {
+		double discriminant = b * b - a * c;
+		if (discriminant >= 0) {
+			double root = std::sqrt(discriminant);
+			double early = (-b - root) / a;
+			double late = (-b + root) / a;
+			if (early > late) {
+				std::swap(early, late);
+			}
+			t = early > 0 ? early : late;
+		}
+	}
+
+	if (t > 0) {
+		// r / t + w is speed long by construction, so there is nothing to normalise
+		xVel = rx / t + wx;
+		yVel = ry / t + wy;
+		return;
+	}
+	double distance = std::sqrt(c);
+	if (distance == 0) {
+		xVel = -speed;
+		yVel = 0;
+		return;
+	}
+	xVel = rx * speed / distance;
+	yVel = ry * speed / distance;
+}
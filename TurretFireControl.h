@@ -0,0 +1,35 @@
+#ifndef TurretFireControl_H
+#define TurretFireControl_H
+
+#include <SDL.h>
+#include <queue>
+#include <vector>
+#include <functional>
+
+// Keeps the turrets that are on screen in a queue ordered by when each may fire next, so a tick only
+// looks at the turrets that are due rather than every turret in the level. Turrets are known by id and
+// join the queue when they come on screen; one that has left it or been blown up is dropped when it
+// comes up.
+//
+// Shots lead the target: aim() works out where a missile at a fixed speed meets a target moving in a
+// straight line, so the turret fires at where the player is going rather than where they are.
+class TurretFireControl
+{
+public:
+	// Starts timing a turret that may fire from readyAt on
+	void arm(int id, Uint32 readyAt);
+	// Takes the next turret due to fire by now. Returns false once none are.
+	bool nextDue(Uint32 now, int &id);
+	void clear();
+
+	// The velocity, speed long, that sends a shot from the origin to meet a target at rx, ry moving at
+	// wx, wy. Velocities are relative to however the shot drifts. If the target outruns the shot, the
+	// shot goes straight at it instead.
+	static void aim(double rx, double ry, double wx, double wy, double speed, double &xVel, double &yVel);
+
+private:
+	typedef std::pair<Uint32, int> Entry;
+	std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry> > due;
+};
+
+#endif
@@ -0,0 +1,156 @@
+// Packs every asset in the manifest into one archive the game can memory map (see AssetArchive.h).
+// Run through `make pack`. Game sprites are decoded to RGBA32 here so the game only has to upload
+// them; the credit slides stay PNG since decoded 1280x720 slides would make the archive ten times
+// bigger for something shown once. Any asset that is missing or won't decode fails the pack, apart from
+// music tracks with a fallback.
+#include <SDL.h>
+#include <SDL_image.h>
+#include <iostream>
+#include <fstream>
+#include <iterator>
+#include <vector>
+#include <string>
+#include <cstring>
+#include "AssetCache.h"
+#include "AssetArchive.h"
+
+struct PackedAsset
+{
+	ArchiveEntry entry;
+	std::vector<char> bytes;
+};
+
+bool readFile(const char* path, std::vector<char>& bytes)
+{
+	std::ifstream file(path, std::ios::binary);
+	if (!file.is_open()) {
+		return false;
+	}
+	bytes.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+	return true;
+}
+
+bool packFile(const char* path, Uint32 type, std::vector<PackedAsset>& assets)
+{
+	PackedAsset asset;
+	memset(&asset.entry, 0, sizeof(asset.entry));
+	if (strlen(path) >= sizeof(asset.entry.path)) {
+		std::cout << "Path too long for the archive index: " << path << std::endl;
+		return false;
+	}
+	strcpy(asset.entry.path, path);
+	asset.entry.type = type;
+
+	if (!readFile(path, asset.bytes)) {
+		std::cout << "Missing asset: " << path << std::endl;
+		return false;
+	}
+
+	if (type == ENTRY_RGBA) {
+		SDL_Surface* loaded = IMG_Load_RW(SDL_RWFromConstMem(asset.bytes.data(), asset.bytes.size()), 1);
+		if (loaded == nullptr) {
+			std::cout << "Unable to decode " << path << "! SDL Error: " << SDL_GetError() << std::endl;
+			return false;
+		}
+		SDL_Surface* rgba = SDL_ConvertSurfaceFormat(loaded, SDL_PIXELFORMAT_RGBA32, 0);
+		SDL_FreeSurface(loaded);
+		if (rgba == nullptr) {
+			std::cout << "Unable to convert " << path << " to RGBA! SDL Error: " << SDL_GetError() << std::endl;
+			return false;
+		}
+		asset.entry.width = rgba->w;
+		asset.entry.height = rgba->h;
+		asset.entry.pitch = rgba->w * 4;
+		asset.bytes.resize((size_t) asset.entry.pitch * rgba->h);
+		for (int y = 0; y < rgba->h; y++) {
+			memcpy(&asset.bytes[(size_t) y * asset.entry.pitch], (Uint8*) rgba->pixels + y * rgba->pitch, asset.entry.pitch);
+		}
+		SDL_FreeSurface(rgba);
+	}
+	else if (type == ENTRY_ENCODED) {
+		// Still make sure it decodes, so a broken slide fails now rather than during the credits
+		SDL_Surface* loaded = IMG_Load_RW(SDL_RWFromConstMem(asset.bytes.data(), asset.bytes.size()), 1);
+		if (loaded == nullptr) {
+			std::cout << "Unable to decode " << path << "! SDL Error: " << SDL_GetError() << std::endl;
+			return false;
+		}
+		SDL_FreeSurface(loaded);
+	}
+
+	asset.entry.size = asset.bytes.size();
+	assets.push_back(asset);
+	return true;
+}
+
+int main(int argc, char* args[])
+{
+	const char* out_path = argc > 1 ? args[1] : AssetArchive::DEFAULT_PATH;
+
+	if (!(IMG_Init(IMG_INIT_PNG) & IMG_INIT_PNG)) {
+		std::cout << "Unable to init SDL_image! SDL Error: " << IMG_GetError() << std::endl;
+		return 1;
+	}
+
+	// Check everything before writing anything, and report every problem rather than the first one
+	std::vector<PackedAsset> assets;
+	bool ok = true;
+	for (int i = 0; i < ASSET_COUNT; i++) {
+		Uint32 type = AssetCache::MANIFEST[i].preload ? ENTRY_RGBA : ENTRY_ENCODED;
+		ok = packFile(AssetCache::MANIFEST[i].path, type, assets) && ok;
+	}
+	for (int i = 0; i < MUSIC_COUNT; i++) {
+		const MusicManifestEntry &track = AssetCache::MUSIC_MANIFEST[i];
+		std::ifstream probe(track.path, std::ios::binary);
+		if (track.fallback != track.id && !probe.is_open()) {
+			std::cout << "Leaving out " << track.path << ", the game will play " << AssetCache::MUSIC_MANIFEST[track.fallback].path << " instead" << std::endl;
+			continue;
+		}
+		ok = packFile(track.path, ENTRY_RAW, assets) && ok;
+	}
+	ok = packFile(AssetCache::FONT_PATH, ENTRY_RAW, assets) && ok;
+	IMG_Quit();
+
+	if (!ok) {
+		std::cout << "Not writing " << out_path << " until the assets above are fixed" << std::endl;
+		return 1;
+	}
+
+	ArchiveHeader header;
+	memcpy(header.magic, AssetArchive::MAGIC, 4);
+	header.version = AssetArchive::VERSION;
+	header.entryCount = assets.size();
+	header.reserved = 0;
+
+	// Lay the data out after the index, 16 byte aligned so the pixels can be read with wide loads
+	Uint64 offset = sizeof(ArchiveHeader) + assets.size() * sizeof(ArchiveEntry);
+	for (int i = 0; i < assets.size(); i++) {
+		offset = (offset + 15) & ~(Uint64) 15;
+		assets[i].entry.offset = offset;
+		offset += assets[i].entry.size;
+	}
+
+	std::ofstream out(out_path, std::ios::binary | std::ios::trunc);
+	if (!out.is_open()) {
+		std::cout << "Unable to open " << out_path << " for writing" << std::endl;
+		return 1;
+	}
+	out.write((const char*) &header, sizeof(header));
+	for (int i = 0; i < assets.size(); i++) {
+		out.write((const char*) &assets[i].entry, sizeof(ArchiveEntry));
+	}
+	const char padding[16] = {0};
+	Uint64 written = sizeof(ArchiveHeader) + assets.size() * sizeof(ArchiveEntry);
+	for (int i = 0; i < assets.size(); i++) {
+		out.write(padding, assets[i].entry.offset - written);
+		out.write(assets[i].bytes.data(), assets[i].bytes.size());
+		written = assets[i].entry.offset + assets[i].entry.size;
+	}
+	out.close();
+	if (!out) {
+		std::cout << "Failed writing " << out_path << std::endl;
+		return 1;
+	}
+
+	std::cout << "Packed " << assets.size() << " assets into " << out_path << " (" << written / 1024 << " KB)" << std::endl;
+	return 0;
+}
@@ -1,102 +1,99 @@
 #include "bullet.h"
 #include "time.h"
+#include "GameClock.h"
 
-// Increase value to have bullets drop slower
-// Decrease to have bullets drop faster
-const int adjuster = 10;
+constexpr float Bullet::LIFT;
 
-Bullet::Bullet(int x, int y, int vel) :xPos{(double)x}, yPos{(double)y}, width{BULLET_SIZE}, height{BULLET_SIZE}{
+Bullet::Bullet(int x, int y, int vel) :xPos{(float)x}, yPos{(float)y}, width{BULLET_SIZE}, height{BULLET_SIZE}{
 	bullet_sprite = {(int)xPos,(int)yPos,width, height};
 	hitbox = bullet_sprite;
-	velocity_magnitude = vel;
 	xVel = vel;
-	pitch = 0;
-	air_time = 0;
-	last_move = SDL_GetTicks();
+	yVel = -LIFT;
+	xAccel = Ballistics::dragFor(xVel);
+	last_move = GameClock::getTicks();
+	entityId = RenderSnapshot::newEntityId();
 };
 
-Bullet::Bullet(int x, int y, int xvel, int yvel) :xPos{(double)x}, yPos{(double)y}, width{BULLET_SIZE}, height{BULLET_SIZE}{
+Bullet::Bullet(int x, int y, float xvel, float yvel) :xPos{(float)x}, yPos{(float)y}, width{BULLET_SIZE}, height{BULLET_SIZE}{
 	bullet_sprite = {(int)xPos,(int)yPos,width, height};
 	hitbox = bullet_sprite;
-	velocity_magnitude = sqrt(xvel * xvel + yvel * yvel);
 	xVel = xvel;
-	yVel = yvel;
-	// Compute pitch
-	pitch = atan((double) yvel / xvel);
-	if (xvel < 0)
-		pitch = pitch + 3.1415926535;
-	
-	air_time = 0;
-	last_move = SDL_GetTicks();
-    	srand(time(NULL));
+	yVel = yvel - LIFT;
+	xAccel = Ballistics::dragFor(xVel);
+	last_move = GameClock::getTicks();
+	entityId = RenderSnapshot::newEntityId();
 };
 
 Bullet::~Bullet(){
 	//gotta figure this one out
 }
 
-void Bullet::renderBullet(SDL_Renderer* gRenderer){
-	SDL_SetRenderDrawColor(gRenderer, 0xFF, 0xFF, 0xFF, 0xFF);
-	SDL_RenderFillRect(gRenderer, &bullet_sprite);
+void Bullet::renderBullet(RenderSnapshot* frame){
+	frame->setDrawColor(0xFF, 0xFF, 0xFF, 0xFF);
+	frame->fillRect(bullet_sprite);
 }
 
 bool Bullet::ricochetFloor(){
-	if(((rand() % 100) + (yVel/20)) > 80){ // about 20-40% chance of destruction, higher Velocity = less likely to ricochet
+	if(((rand() % 100) + (int) (yVel/20)) > 80){ // about 20-40% chance of destruction, higher Velocity = less likely to ricochet
 		return true; // destroyed
 	}
 	yPos = FLOOR_BOTTOM - 3;
-	yVel /= -1.5;
+	yVel /= -1.5f;
 	
 	return false; // ricocheted
 }
 
 bool Bullet::ricochetRoof(){
-	if(((rand() % 100) + (yVel/20)) > 80){ // about 20-40% chance of destruction, higher Velocity = less likely to ricochet
+	if(((rand() % 100) + (int) (yVel/20)) > 80){ // about 20-40% chance of destruction, higher Velocity = less likely to ricochet
 		return true; // destroyed
 	}
 	yPos = ROOF_TOP + 3;
-	yVel /= -1.5;
+	yVel /= -1.5f;
 	
 	return false; // ricocheted
 }
 
 void Bullet::move(){
-	time_since_move = SDL_GetTicks() - last_move;
-
-	xVel = adjusted_x_velocity();
-	yVel = adjusted_y_velocity();
-
-	xPos += ((double) time_since_move * xVel) / 1000;
-	yPos += ((double) time_since_move * yVel) / 1000;
-	air_time += time_since_move;
-
-	bullet_sprite ={(int)xPos,(int)yPos,width,height};
-	hitbox = bullet_sprite;
-	last_move = SDL_GetTicks();
+	time_since_move = GameClock::getTicks() - last_move;
+	float seconds = time_since_move / 1000.0f;
+	Ballistics::step(&xPos, &yPos, &xVel, &yVel, &xAccel, &seconds, 1);
+	updateHitbox();
+	last_move = GameClock::getTicks();
 }
 
-int Bullet::adjusted_x_velocity()
-{
-	// Decrease x velocity to simulate air resistance,
-	// but half as slowly as the decrease in y velocity
-	int adjustment = air_time * (1/2 / adjuster);
-	int x_velocity = velocity_magnitude * cos(pitch);
-
-	// Prevent projectile from changing direction in the x-direction
-	int adjusted_x_velocity = x_velocity - adjustment;
-	if ((adjusted_x_velocity <= 0 && x_velocity >= 0) || (adjusted_x_velocity >= 0 && x_velocity <= 0))
-	{
-		adjusted_x_velocity = 0;
+void Bullet::moveAll(const std::vector<Bullet*> &bullets, BallisticBatch &batch){
+	int now = GameClock::getTicks();
+	int count = bullets.size();
+	batch.resize(count);
+	for (int i = 0; i < count; i++) {
+		Bullet* b = bullets[i];
+		batch.x[i] = b->xPos;
+		batch.y[i] = b->yPos;
+		batch.xVel[i] = b->xVel;
+		batch.yVel[i] = b->yVel;
+		batch.xAccel[i] = b->xAccel;
+		batch.seconds[i] = (now - b->last_move) / 1000.0f;
+	}
+	Ballistics::step(batch.x.data(), batch.y.data(), batch.xVel.data(), batch.yVel.data(), batch.xAccel.data(), batch.seconds.data(), count);
+	for (int i = 0; i < count; i++) {
+		Bullet* b = bullets[i];
+		b->time_since_move = now - b->last_move;
+		b->xPos = batch.x[i];
+		b->yPos = batch.y[i];
+		b->xVel = batch.xVel[i];
+		b->yVel = batch.yVel[i];
+		b->updateHitbox();
+		b->last_move = now;
 	}
+}
 
-	return adjusted_x_velocity;
+void Bullet::updateHitbox(){
+	bullet_sprite ={(int)xPos,(int)yPos,width,height};
+	hitbox = bullet_sprite;
 }
 
-int Bullet::adjusted_y_velocity()
-{
-	// Decreases the y velocity by the air time to simulate bullet drop
-	int y_velocity = velocity_magnitude * sin(pitch) - 15;
-	return y_velocity + (air_time / adjuster);
+Uint32 Bullet::getEntityId(){
+	return entityId;
 }
 
 int Bullet::getX(){
@@ -4,26 +4,32 @@
 #include <SDL.h>
 #include <iostream>
 #include <cmath>
+#include "RenderSnapshot.h"
+#include "Screen.h"
+#include "Ballistics.h"
+#include <vector>
 
 class Bullet
 {
 public:
 
 	static const int BULLET_SIZE = 5;
-	static const int FLOOR_BOTTOM = 720-79;
+	static const int FLOOR_BOTTOM = SCREEN_HEIGHT-79;
     static const int ROOF_TOP = 73;
 
     Bullet(int x, int y, int vel);
-	Bullet(int x, int y, int xvel, int yvel);
+	Bullet(int x, int y, float xvel, float yvel);
     ~Bullet();
 
-    void renderBullet(SDL_Renderer* gRenderer);
+    void renderBullet(RenderSnapshot* frame);
 
     bool ricochetFloor();
 
     bool ricochetRoof();
 
     void move();
+    // Moves every bullet at once, using batch for the arrays. Same as calling move() on each.
+    static void moveAll(const std::vector<Bullet*> &bullets, BallisticBatch &batch);
 
     int getX();
 
@@ -37,26 +43,29 @@ public:
 
     int getYVel();
 
-    int adjusted_x_velocity();
-
-    int adjusted_y_velocity();
-
     SDL_Rect* getHitbox();
 
+    // Which anchor the render thread interpolates this bullet from
+    Uint32 getEntityId();
+
 private:
+    Uint32 entityId;
+
     //define's size of bullet
     const int width;
     const int height;
 
+    // Bullets leave the barrel kicking up slightly, in px/s
+    static constexpr float LIFT = 15;
+
     // x and y position of bullet
-    double xPos;
-    double yPos;
+    float xPos;
+    float yPos;
 
-    // velocity of bullet
-    int velocity_magnitude;
-    int xVel;
-    int yVel;
-	int yVel0;
+    // velocity of bullet, and the drag slowing it sideways
+    float xVel;
+    float yVel;
+    float xAccel;
 
     SDL_Rect bullet_sprite;
     SDL_Rect hitbox;
@@ -65,13 +74,7 @@ private:
     int time_since_move;
     int last_move;
 
-    // Pitch of the bullet in radians
-    double pitch;
-
-    // Time the projectile has been in the air
-    // Used to calculate air resistance and bullet drop
-    double air_time;
-
+    void updateHitbox();
 };
 
 #endif
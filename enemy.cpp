@@ -3,41 +3,30 @@
 #include <iostream>
 #include <string>
 #include <vector>
+#include <algorithm>
+#include <cmath>
 #include <SDL.h>
 #include <SDL_image.h>
 #include <stdlib.h>
 #include "Enemy.h"
+#include "AssetCache.h"
+#include "GameClock.h"
+#include "Screen.h"
 
 
-SDL_Texture* Enemy::loadImage(std::string fname, SDL_Renderer *gRenderer) {
-	SDL_Texture* newText = nullptr;
-
-	SDL_Surface* startSurf = IMG_Load(fname.c_str());
-	if (startSurf == nullptr) {
-		std::cout << "Unable to load image " << fname << "! SDL Error: " << SDL_GetError() << std::endl;
-		return nullptr;
-	}
-
-	newText = SDL_CreateTextureFromSurface(gRenderer, startSurf);
-	if (newText == nullptr) {
-		std::cout << "Unable to create texture from " << fname << "! SDL Error: " << SDL_GetError() << std::endl;
-	}
-
-	SDL_FreeSurface(startSurf);
-
-	return newText;
-}
-
     Enemy::Enemy(int x, int y, int w, int h, int xvel, int yvel, int diff, SDL_Renderer *gRenderer) :xPos{(double) x}, yPos{(double) y},width{w},height{h},maxXVelo{xvel},maxYVelo{yvel}{
 	  	enemy_sprite = {(int) xPos, (int) yPos, width, height};
 		enemy_hitbox = enemy_sprite;
-		sprite1 = loadImage("sprites/EnemyPlane1.png", gRenderer);
-		sprite2 = loadImage("sprites/EnemyPlane3.png", gRenderer);
+		entityId = RenderSnapshot::newEntityId();
+		gAssets->acquireAnimation(ANIM_ENEMY);
+		gAssets->acquireAnimation(ANIM_ENEMY_HIT);
+		animation = Animator::play(ANIM_ENEMY);
 		tiltAngle = 0;
-	  	last_move = SDL_GetTicks();
-		time_hit = SDL_GetTicks() - FLICKER_TIME;
-		last_shot = SDL_GetTicks() - FIRING_FREQ;
+	  	last_move = GameClock::getTicks();
+		time_hit = GameClock::getTicks() - FLICKER_TIME;
+		last_shot = GameClock::getTicks() - FIRING_FREQ;
 		is_destroyed = false;
+		time_destroyed = 0;
 		if(diff == 3){
 			health = 20;
 		}
@@ -49,45 +38,60 @@ SDL_Texture* Enemy::loadImage(std::string fname, SDL_Renderer *gRenderer) {
 		}
 
 		prev_direction = 0;
+		thought_x_square = -1;
+		thought_y_square = -1;
+		rng = 1;
     }
 
 	Enemy::~Enemy() {
-		SDL_DestroyTexture(sprite1);
-		SDL_DestroyTexture(sprite2);
+		gAssets->releaseAnimation(ANIM_ENEMY);
+		gAssets->releaseAnimation(ANIM_ENEMY_HIT);
 	}
 
-    void Enemy::renderEnemy(SDL_Renderer* gRenderer){
-			if ((SDL_GetTicks() - time_hit) <= FLICKER_TIME && ((SDL_GetTicks() - time_hit) / FLICKER_FREQ) % 2 == 0) {
-				return;
+    void Enemy::renderEnemy(RenderSnapshot* frame){
+			if (animation.clip == ANIM_ENEMY_HIT && Animator::isFinished(animation)) {
+				animation = Animator::play(ANIM_ENEMY);
 			}
 
 			if (!is_destroyed){
-				if ((SDL_GetTicks() / ANIMATION_FREQ) % 2 == 1) {
-      		SDL_RenderCopyEx(gRenderer, sprite1, nullptr, &enemy_sprite, tiltAngle, nullptr, SDL_FLIP_NONE);
-      	}else {
-        	SDL_RenderCopyEx(gRenderer, sprite2, nullptr, &enemy_sprite, tiltAngle, nullptr, SDL_FLIP_NONE);
-      	}
+				Animator::draw(frame, animation, enemy_sprite, tiltAngle);
       	enemy_hitbox=enemy_sprite;
 			}
+    }
 
-			if ((SDL_GetTicks() - time_destroyed) >= SPAWN_FREQ && is_destroyed){
-				health = 20;
-				is_destroyed = false;
-			}
+    void Enemy::think(const EnemyPerception &seen)
+    {
+		calculateBulletRisk(seen);
+		prev_direction = chooseDirection();
+		thought_x_square = current_x_square;
+		thought_y_square = current_y_square;
     }
 
-    void Enemy::move(int playerX, int playerY, std::vector<int> bulletX, std::vector<int> bulletY, std::vector<int> bulletVelX, std::vector<int> bulletVelY, std::vector<int> stalagmX, std::vector<int> stalagmH, std::vector<int> stalagtX, std::vector<int> stalagtH, std::vector<int> turretX, std::vector<int> turretH, std::vector<int> turretBottom, int kamiX, int kamiY, int cave_y)
+    bool Enemy::needsThink()
     {
-		// If there is no cave, use the risk scores
+		int x_square = std::min(NUM_HORIZONTAL_SQUARES - 1, std::max(0, (int) ((xPos - width/2 - MIN_X) / SQUARE_WIDTH)));
+		int y_square = std::min(NUM_VERTICAL_SQUARES - 1, std::max(0, (int) ((yPos - height/2 - MIN_Y) / SQUARE_WIDTH)));
+		return x_square != thought_x_square || y_square != thought_y_square;
+    }
+
+    bool Enemy::isThreatened(const EnemyPerception &seen)
+    {
+		// In the player's line of fire, or just hit
+		bool in_line = std::abs(yPos + height / 2 - seen.playerY) < THREAT_LANE;
+		return in_line || (int) (seen.ticks - time_hit) <= FLICKER_TIME;
+    }
+
+    void Enemy::move(const EnemyPerception &seen, int cave_y, int cave_slack)
+    {
+		time_since_move = seen.ticks - last_move;
+		// If there is no cave, fly the direction last chosen from the risk scores
 		if (cave_y == -1)
 		{
-			time_since_move = SDL_GetTicks() - last_move;
 			xVelo = 0;
 			yVelo = 0;
 
 			// tiltAngle = 0;
-			calculateRiskscores(playerX, playerY, bulletX, bulletY, bulletVelX, bulletVelY, kamiX, kamiY, stalagmX, stalagmH, stalagtX, stalagtH, turretX, turretH, turretBottom);
-			int direction = chooseDirection();
+			int direction = prev_direction;
 
 			// Move right if that's the optimal direction
 			if(direction == 3 || direction == 4 || direction == 5 || (direction == 0 && ((xPos - width/2 - MIN_X % SQUARE_WIDTH) < SQUARE_WIDTH / 4))){
@@ -110,16 +114,16 @@ SDL_Texture* Enemy::loadImage(std::string fname, SDL_Renderer *gRenderer) {
 
 			xPos += (double) (xVelo * time_since_move) / 1000;
 			yPos += (double) (yVelo * time_since_move) / 1000;
-			prev_direction = direction;
 		}
-		// Otherwise, just follow the cave
+		// Otherwise, just follow the cave, keeping within the room there is around its safest height
 		else
 		{
-			if (cave_y > yPos + height / 2 + 5) yPos += (double) (maxYVelo * time_since_move) / 1000;
-			else if (cave_y < yPos + height / 2 - 5) yPos -= (double) (maxYVelo * time_since_move) / 1000;
+			int band = std::max(5, cave_slack);
+			if (cave_y > yPos + height / 2 + band) yPos += (double) (maxYVelo * time_since_move) / 1000;
+			else if (cave_y < yPos + height / 2 - band) yPos -= (double) (maxYVelo * time_since_move) / 1000;
 		}
 		enemy_sprite = {(int)xPos,(int)yPos,width,height};
-		last_move = SDL_GetTicks();
+		last_move = seen.ticks;
     }
 
 	/*
@@ -131,8 +135,8 @@ SDL_Texture* Enemy::loadImage(std::string fname, SDL_Renderer *gRenderer) {
 	Ties are broken randomly to make the enemy's movement more chaotic.
 	*/
 	int Enemy::chooseDirection() {
-		current_x_square = (xPos - width/2 - MIN_X) / SQUARE_WIDTH;
-		current_y_square = (yPos - height/2 - MIN_Y) / SQUARE_WIDTH;
+		current_x_square = std::min(NUM_HORIZONTAL_SQUARES - 1, std::max(0, (int) ((xPos - width/2 - MIN_X) / SQUARE_WIDTH)));
+		current_y_square = std::min(NUM_VERTICAL_SQUARES - 1, std::max(0, (int) ((yPos - height/2 - MIN_Y) / SQUARE_WIDTH)));
 		double minRisk = riskScores[current_x_square][current_y_square];
 		std::vector<int> leastRisky;
 		leastRisky.push_back(0);
@@ -200,7 +204,7 @@ SDL_Texture* Enemy::loadImage(std::string fname, SDL_Renderer *gRenderer) {
 				leastRisky.push_back(8);
 			}
 		}
-		if (current_x_square > 0) {
+		if (current_x_square < NUM_HORIZONTAL_SQUARES - 1) {
 			if (minRisk >= riskScores[current_x_square+1][current_y_square]) {
 				if (minRisk > riskScores[current_x_square+1][current_y_square]) {
 					leastRisky.clear();
@@ -209,16 +213,22 @@ SDL_Texture* Enemy::loadImage(std::string fname, SDL_Renderer *gRenderer) {
 				leastRisky.push_back(4);
 			}
 		}
-		// If the current movement direction is still in the least risky list, go in that direction
-		for (int i = 0; i < leastRisky.size(); i++) {
-			if (leastRisky[i] == prev_direction) return prev_direction;
+		// Keep going the current way unless another is clearly safer, so close risks don't make the enemy dither
+		static const int DIRECTION_X[] = {0, -1, 0, 1, 1, 1, 0, -1, -1};
+		static const int DIRECTION_Y[] = {0, -1, -1, -1, 0, 1, 1, 1, 0};
+		int prev_x = current_x_square + DIRECTION_X[prev_direction];
+		int prev_y = current_y_square + DIRECTION_Y[prev_direction];
+		if (prev_x >= 0 && prev_x < NUM_HORIZONTAL_SQUARES && prev_y >= 0 && prev_y < NUM_VERTICAL_SQUARES
+			&& riskScores[prev_x][prev_y] <= minRisk + DIRECTION_HYSTERESIS) {
+			return prev_direction;
 		}
 		// Otherwise pick a new direction at random from the list of safe directions
-		int choice = rand() % leastRisky.size();
+		int choice = nextRandom() % leastRisky.size();
 		return leastRisky[choice];
 	}
 
-	void Enemy::calculateRiskscores(int playerX, int playerY, std::vector<int> bulletX, std::vector<int> bulletY, std::vector<int> bulletVelX, std::vector<int> bulletVelY, int kamiX, int kamiY, std::vector<int> stalagmX, std::vector<int> stalagmH, std::vector<int> stalagtX, std::vector<int> stalagtH, std::vector<int> turretX, std::vector<int> turretH, std::vector<int> turretBottom) {
+	void Enemy::calculateRiskscores(EnemyPerception &seen, const std::vector<int> &stalagmX, const std::vector<int> &stalagmH, const std::vector<int> &stalagtX, const std::vector<int> &stalagtH, const std::vector<int> &turretX, const std::vector<int> &turretH, const std::vector<int> &turretBottom) {
+		double (&riskScores)[NUM_HORIZONTAL_SQUARES][NUM_VERTICAL_SQUARES] = seen.riskScores;
 		for (int i = 0; i < NUM_HORIZONTAL_SQUARES; i++) {
 			for (int j = 0; j < NUM_VERTICAL_SQUARES; j++) {
 				riskScores[i][j] = 0;
@@ -226,23 +236,6 @@ SDL_Texture* Enemy::loadImage(std::string fname, SDL_Renderer *gRenderer) {
 		}
 		int xBlock;
 		int yBlock;
-		// Factor bullets into the risk score
-		for (int i = 0; i < bulletX.size(); i++) {
-			xBlock = (bulletX[i] - MIN_X) / SQUARE_WIDTH;
-			yBlock = (bulletY[i] - MIN_Y) / SQUARE_WIDTH;
-			if (bulletVelX[i] * (xPos - bulletX[i]) > 0 || bulletVelY[i] * (yPos - bulletY[i]) > 0) {
-				if (yBlock >= 0 && yBlock < NUM_VERTICAL_SQUARES) {
-					for (int j = 0; j < NUM_HORIZONTAL_SQUARES; j++) {
-						riskScores[j][yBlock] += 60;
-					}
-				}
-				if (xBlock >= 0 && xBlock < NUM_HORIZONTAL_SQUARES) {
-					for (int j = 0; j < NUM_VERTICAL_SQUARES; j++) {
-						riskScores[xBlock][j] += 60;
-					}
-				}
-			}
-		}
 
 		// Factor stalactites, stalagmites, and turrets into the risk score
 		// Basically, any block where there is/soon will be a stalactite or turret is dangerous
@@ -263,7 +256,7 @@ SDL_Texture* Enemy::loadImage(std::string fname, SDL_Renderer *gRenderer) {
 		for (int i = 0; i < stalagtX.size(); i++) {
 			firstX = std::max(0, (stalagtX[i] - 50) / SQUARE_WIDTH);
 			lastX = std::min(numHorizSquares - 1, (stalagtX[i] + 150) / SQUARE_WIDTH);
-			lastY = (720 - stalagtH[i] - MIN_Y) / SQUARE_WIDTH;
+			lastY = (SCREEN_HEIGHT - stalagtH[i] - MIN_Y) / SQUARE_WIDTH;
 			for (int j = firstX; j <= lastX; j++) {
 				for (int k = NUM_VERTICAL_SQUARES - 1; k >= lastY; k--) {
 					riskScores[j][k] += 50;
@@ -282,7 +275,7 @@ SDL_Texture* Enemy::loadImage(std::string fname, SDL_Renderer *gRenderer) {
 				}
 			}
 			else {
-				lastY = (720 - turretH[i] - MIN_Y) / SQUARE_WIDTH;
+				lastY = (SCREEN_HEIGHT - turretH[i] - MIN_Y) / SQUARE_WIDTH;
 				for (int j = firstX; j <= lastX; j++) {
 					for (int k = NUM_VERTICAL_SQUARES - 1; k >= lastY; k--) {
 						riskScores[j][k] += 50;
@@ -292,33 +285,18 @@ SDL_Texture* Enemy::loadImage(std::string fname, SDL_Renderer *gRenderer) {
 		}
 
 		// Factor kamikazes into the risk score
-		// std::cout << "kamis:" << kamiX.size() << std::endl;
-		// for (int i = 0; i < kamiX.size(); i++) {
-		// 	xBlock = (kamiX[i] - MIN_X) / SQUARE_WIDTH;
-		// 	yBlock = (kamiY[i] - MIN_Y) / SQUARE_WIDTH;
-		// 	if (yBlock >= 0 && yBlock < NUM_VERTICAL_SQUARES) {
-		// 		for (int j = 0; j < NUM_HORIZONTAL_SQUARES; j++) {
-		// 			riskScores[j][yBlock] += 10;
-		// 		}
-		// 	}
-		// 	if (xBlock >= 0 && xBlock < NUM_HORIZONTAL_SQUARES) {
-		// 		for (int j = 0; j < NUM_VERTICAL_SQUARES; j++) {
-		// 			riskScores[xBlock][j] += 10;
-		// 		}
-		// 	}
-		// }
-
-		//New kamikaze risk score calculations
-		xBlock = (kamiX - MIN_X)/SQUARE_WIDTH;
-		yBlock = (kamiY - MIN_Y)/SQUARE_WIDTH;
-		if (yBlock >= 0 && yBlock < NUM_VERTICAL_SQUARES) {
-			for (int j = 0; j < NUM_HORIZONTAL_SQUARES; j++) {
-				riskScores[j][yBlock] += 10;
+		for (int i = 0; i < seen.kamiX.size(); i++) {
+			xBlock = (seen.kamiX[i] - MIN_X) / SQUARE_WIDTH;
+			yBlock = (seen.kamiY[i] - MIN_Y) / SQUARE_WIDTH;
+			if (yBlock >= 0 && yBlock < NUM_VERTICAL_SQUARES) {
+				for (int j = 0; j < NUM_HORIZONTAL_SQUARES; j++) {
+					riskScores[j][yBlock] += 10;
+				}
 			}
-		}
-		if (xBlock >= 0 && xBlock < NUM_HORIZONTAL_SQUARES) {
-			for (int j = 0; j < NUM_VERTICAL_SQUARES; j++) {
-				riskScores[xBlock][j] += 10;
+			if (xBlock >= 0 && xBlock < NUM_HORIZONTAL_SQUARES) {
+				for (int j = 0; j < NUM_VERTICAL_SQUARES; j++) {
+					riskScores[xBlock][j] += 10;
+				}
 			}
 		}
 
@@ -331,8 +309,8 @@ SDL_Texture* Enemy::loadImage(std::string fname, SDL_Renderer *gRenderer) {
 		}
 
 		// Factor player into the risk score
-		xBlock = (playerX - MIN_X) / SQUARE_WIDTH;
-		yBlock = (playerY - MIN_Y) / SQUARE_WIDTH;
+		xBlock = (seen.playerX - MIN_X) / SQUARE_WIDTH;
+		yBlock = (seen.playerY - MIN_Y) / SQUARE_WIDTH;
 		if (yBlock >= 0 && yBlock < NUM_VERTICAL_SQUARES) {
 			for (int j = 0; j < NUM_HORIZONTAL_SQUARES; j++) {
 				riskScores[j][yBlock] -= 30;
@@ -345,6 +323,33 @@ SDL_Texture* Enemy::loadImage(std::string fname, SDL_Renderer *gRenderer) {
 		}
 	}
 
+	void Enemy::calculateBulletRisk(const EnemyPerception &seen) {
+		for (int i = 0; i < NUM_HORIZONTAL_SQUARES; i++) {
+			for (int j = 0; j < NUM_VERTICAL_SQUARES; j++) {
+				riskScores[i][j] = seen.riskScores[i][j];
+			}
+		}
+		int xBlock;
+		int yBlock;
+		// Factor bullets into the risk score
+		for (int i = 0; i < seen.bulletX.size(); i++) {
+			xBlock = (seen.bulletX[i] - MIN_X) / SQUARE_WIDTH;
+			yBlock = (seen.bulletY[i] - MIN_Y) / SQUARE_WIDTH;
+			if (seen.bulletVelX[i] * (xPos - seen.bulletX[i]) > 0 || seen.bulletVelY[i] * (yPos - seen.bulletY[i]) > 0) {
+				if (yBlock >= 0 && yBlock < NUM_VERTICAL_SQUARES) {
+					for (int j = 0; j < NUM_HORIZONTAL_SQUARES; j++) {
+						riskScores[j][yBlock] += 60;
+					}
+				}
+				if (xBlock >= 0 && xBlock < NUM_HORIZONTAL_SQUARES) {
+					for (int j = 0; j < NUM_VERTICAL_SQUARES; j++) {
+						riskScores[xBlock][j] += 60;
+					}
+				}
+			}
+		}
+	}
+
 	bool Enemy::checkCollision(int objX, int objY, int objW, int objH) {
 		if (is_destroyed) return false;
 		return checkCollide(objX, objY, objW, objH, xPos, yPos, width, height);
@@ -359,21 +364,50 @@ SDL_Texture* Enemy::loadImage(std::string fname, SDL_Renderer *gRenderer) {
 	    return true;
 	}
 
+	void Enemy::spawn(int x, int y, int h, Uint32 seed) {
+		xPos = x;
+		yPos = y;
+		enemy_sprite = {x, y, width, height};
+		entityId = RenderSnapshot::newEntityId();
+		health = h;
+		is_destroyed = false;
+		prev_direction = 0;
+		thought_x_square = -1;
+		thought_y_square = -1;
+		// Xorshift gets stuck on zero
+		rng = seed != 0 ? seed : 1;
+		last_move = GameClock::getTicks();
+		last_shot = GameClock::getTicks() - FIRING_FREQ;
+	}
+
+	bool Enemy::isDestroyed() {
+		return is_destroyed;
+	}
+
+	int Enemy::getTimeDestroyed() {
+		return time_destroyed;
+	}
+
 	void Enemy::hit(int d){
 		// If the player has just been hit, they should be invunerable, so don't damage them
-		if ((SDL_GetTicks() - time_hit) <= FLICKER_TIME) {
+		if ((GameClock::getTicks() - time_hit) <= FLICKER_TIME) {
 			return;
 		}
 
-		time_hit = SDL_GetTicks();
+		time_hit = GameClock::getTicks();
+		animation = Animator::play(ANIM_ENEMY_HIT);
 		health -= d;
 		if (health <= 0) {
 			health = 0;
-			time_destroyed = SDL_GetTicks();
+			time_destroyed = GameClock::getTicks();
 			is_destroyed = true;
 		}
 	}
 
+    Uint32 Enemy::getEntityId(){
+      return entityId;
+    }
+
     int Enemy::getX(){
       return (int) xPos;
     }
@@ -427,10 +461,10 @@ SDL_Texture* Enemy::loadImage(std::string fname, SDL_Renderer *gRenderer) {
     Bullet* Enemy::handleFiring()
     {
 		if (!is_destroyed){
-			time_since_shoot = SDL_GetTicks() - last_shot;
+			time_since_shoot = GameClock::getTicks() - last_shot;
 			if (time_since_shoot > FIRING_FREQ) {
 				Bullet* b = new Bullet(xPos+width+5,yPos+height/2,450);
-				last_shot = SDL_GetTicks();
+				last_shot = GameClock::getTicks();
 				return b;
 			}
 		}
@@ -440,3 +474,10 @@ SDL_Texture* Enemy::loadImage(std::string fname, SDL_Renderer *gRenderer) {
 		int Enemy::getHealth(){
 			return health;
 		}
+
+	int Enemy::nextRandom() {
+		rng ^= rng << 13;
+		rng ^= rng >> 17;
+		rng ^= rng << 5;
+		return rng & 0x7FFFFFFF;
+	}
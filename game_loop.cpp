@@ -2,6 +2,7 @@
 #include <iostream>
 #include <fstream>
 #include <vector>
+#include <algorithm>
 #include <string>
 #include <SDL.h>
 #include <time.h>
@@ -10,37 +11,88 @@
 #include <SDL_mixer.h>
 #include "MapBlocks.h"
 #include "Player.h"
-#include "Enemy.h"
+#include "EnemySquadron.h"
 #include "bullet.h"
 #include "GameOver.h"
 #include "StartScreen.h"
 #include "DifficultySelectionScreen.h"
 #include "CaveSystem.h"
+#include "CaveGenerator.h"
+#include "LevelFile.h"
 #include "Text.h"
-#include "Kamikaze.h"
+#include "KamikazeSwarm.h"
+#include "AssetCache.h"
+#include "Animation.h"
+#include "RenderThread.h"
+#include "FramePacer.h"
+#include "GameClock.h"
+#include "RotatedSpriteCache.h"
+#include "RenderBackend.h"
+#include "Screen.h"
+#include "JobSystem.h"
 
-constexpr int SCREEN_WIDTH = 1280;
-constexpr int SCREEN_HEIGHT = 720;
 constexpr int LEVEL_WIDTH = 100000;
 constexpr int LEVEL_HEIGHT = 2000;
 constexpr int SCROLL_SPEED = 420;
 constexpr int BG_SCROLL_SPEED = 200;
-constexpr int FLOOR_BOTTOM = 720-79;
+constexpr int FLOOR_BOTTOM = SCREEN_HEIGHT-79;
 constexpr int ROOF_TOP = 73;
+// The simulation runs on its own, so cap it rather than letting it spin. The render thread draws
+// in between ticks, so this can be lowered (--tick-rate) without motion getting choppy.
+constexpr int SIM_TICKS_PER_SECOND = 240;
 
 // Function declarations
+void parseOptions(int argc, char* args[]);
+void createLevel(int difficulty);
 bool init();
-SDL_Texture* loadImage(std::string fname);
+int runHeadless();
 void close();
 
 // Globals
 SDL_Window* gWindow = nullptr;
 SDL_Renderer* gRenderer = nullptr;
+RenderBackend* backend = nullptr;
+RenderThread* render_thread = nullptr;
+RotatedSpriteCache* sprite_cache = nullptr;
+
+// Frame pacing, set from the command line: --fps <n> (0 for uncapped) and --vsync off|on|adaptive
+int target_fps = FramePacer::DEFAULT_TARGET_FPS;
+VSyncMode vsync_mode = VSYNC_ON;
+// --tick-rate <n> simulation ticks per second, --no-interpolation to draw only what each tick left
+int sim_tick_rate = SIM_TICKS_PER_SECOND;
+bool interpolation = true;
+// --no-dynamic-resolution keeps drawing at full resolution even when frames run long
+bool dynamic_resolution = true;
+
+// --noise-caves carves caves out of noise, with branches and chambers, instead of one winding tunnel
+CaveStyle cave_style = CAVE_TUNNEL;
+
+// --endless keeps generating the level instead of stopping at LEVEL_WIDTH, getting harder as it goes
+bool endless_mode = false;
+
+// --level <file> plays a saved level, its difficulty and all. --save-level <file> saves each new
+// level in full, --save-seed <file> just what it was generated from.
+std::string level_path;
+std::string save_level_path;
+std::string save_seed_path;
+LevelFile* level_file = nullptr;
+
+// --headless plays a fixed number of simulation ticks (--ticks) from a seed (--seed) with no window,
+// then prints a hash of the last frame and can save it (--out) or time drawing it (--bench <runs>)
+bool headless = false;
+unsigned int headless_seed = 1;
+int headless_ticks = 600;
+int headless_difficulty = 1;
+std::string headless_out;
+int bench_runs = 0;
 
 // X and y positions of the camera, and background loading position
 double camX = 0;
 double camY = LEVEL_HEIGHT - SCREEN_HEIGHT;
 double bg_x = 0;
+// Where they were the tick before, to draw in between
+double prev_camX = camX;
+double prev_bg_x = bg_x;
 
 Player * player;
 MapBlocks *blocks;
@@ -48,16 +100,23 @@ GameOver *game_over;
 StartScreen *start_screen;
 DifficultySelectionScreen *diff_sel_screen;
 CaveSystem *cave_system;
+// Makes the next cave in the background. Caves come from the level's cave seed so a late one is still the same cave.
+CaveGenerator *cave_generator = nullptr;
+// What the level being played was made from
+LevelParams level_params;
 std::vector<Bullet*> bullets;
 std::vector<Missile*> missiles;
-Enemy* en;
-Kamikaze* kam;
+EnemySquadron* squadron;
+KamikazeSwarm* kamikazes;
 bool caveCounterHelp = false;
-bool prev_kam = false;
 
 // Background image
 SDL_Texture* gBackground;
 
+// HUD font and the high score shown next to the score
+TTF_Font* font_16 = nullptr;
+int high_score = 0;
+
 // Music stuff
 Mix_Music *trash_beat = NULL;
 Mix_Music* main_track = NULL;
@@ -70,12 +129,73 @@ int time_destroyed;
 
 // Scrolling-related times so that scroll speed is independent of framerate
 int time_since_horiz_scroll;
-int last_horiz_scroll = SDL_GetTicks();
+int last_horiz_scroll = GameClock::getTicks();
 
 //framerate timer
 Uint32 fps_last_time = SDL_GetTicks();
 Uint32 fps_cur_time = 0;
-int framecount;
+int fps_last_frames = 0;
+
+void parseOptions(int argc, char* args[]) {
+	for (int i = 1; i < argc; i++) {
+		std::string option = args[i];
+		if (option == "--fps" && i + 1 < argc) {
+			target_fps = atoi(args[++i]);
+		}
+		else if (option == "--vsync" && i + 1 < argc) {
+			std::string mode = args[++i];
+			if (mode == "off") vsync_mode = VSYNC_OFF;
+			else if (mode == "adaptive") vsync_mode = VSYNC_ADAPTIVE;
+			else vsync_mode = VSYNC_ON;
+		}
+		else if (option == "--tick-rate" && i + 1 < argc) {
+			sim_tick_rate = atoi(args[++i]);
+			if (sim_tick_rate < 1) sim_tick_rate = SIM_TICKS_PER_SECOND;
+		}
+		else if (option == "--no-interpolation") {
+			interpolation = false;
+		}
+		else if (option == "--no-dynamic-resolution") {
+			dynamic_resolution = false;
+		}
+		else if (option == "--noise-caves") {
+			cave_style = CAVE_NOISE;
+		}
+		else if (option == "--endless") {
+			endless_mode = true;
+		}
+		else if (option == "--level" && i + 1 < argc) {
+			level_path = args[++i];
+		}
+		else if (option == "--save-level" && i + 1 < argc) {
+			save_level_path = args[++i];
+		}
+		else if (option == "--save-seed" && i + 1 < argc) {
+			save_seed_path = args[++i];
+		}
+		else if (option == "--headless") {
+			headless = true;
+		}
+		else if (option == "--seed" && i + 1 < argc) {
+			headless_seed = strtoul(args[++i], nullptr, 10);
+		}
+		else if (option == "--ticks" && i + 1 < argc) {
+			headless_ticks = atoi(args[++i]);
+		}
+		else if (option == "--difficulty" && i + 1 < argc) {
+			headless_difficulty = atoi(args[++i]);
+		}
+		else if (option == "--out" && i + 1 < argc) {
+			headless_out = args[++i];
+		}
+		else if (option == "--bench" && i + 1 < argc) {
+			bench_runs = atoi(args[++i]);
+		}
+		else {
+			std::cout << "Unknown option " << option << std::endl;
+		}
+	}
+}
 
 bool init() {
 	if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_AUDIO) < 0) {
@@ -92,18 +212,14 @@ bool init() {
 		return false;
 	}
 
-	gWindow = SDL_CreateWindow("TeamAGame", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, SCREEN_WIDTH, SCREEN_HEIGHT, SDL_WINDOW_SHOWN);
-	if (gWindow == nullptr) {
-		std::cout << "Window could not be created! SDL_Error: " << SDL_GetError() << std::endl;
-		return  false;
-	}
-
 	// Adding VSync to avoid absurd framerates
-	gRenderer = SDL_CreateRenderer(gWindow, -1, SDL_RENDERER_ACCELERATED);
-	if (gRenderer == nullptr) {
-		std::cout << "Renderer could not be created! SDL_Error: " << SDL_GetError() << std::endl;
-		return  false;
+	WindowBackend* window = new WindowBackend();
+	backend = window;
+	if (!window->open("TeamAGame", SCREEN_WIDTH, SCREEN_HEIGHT, vsync_mode)) {
+		return false;
 	}
+	gWindow = window->getWindow();
+	gRenderer = window->getRenderer();
 
 	//Initialize SDL_mixer
 	if( Mix_OpenAudio( 44100, MIX_DEFAULT_FORMAT, 2, 2048 ) < 0 )
@@ -117,126 +233,124 @@ bool init() {
 	return true;
 }
 
-SDL_Texture* loadImage(std::string fname) {
-	SDL_Texture* newText = nullptr;
+void close() {
+	// Get the renderer back before anything it draws is destroyed
+	delete render_thread;
+	render_thread = nullptr;
+	delete cave_generator;
+	cave_generator = nullptr;
+	delete level_file;
+	level_file = nullptr;
+	delete sprite_cache;
+	sprite_cache = nullptr;
+
+	// Textures have to go before the renderer that owns them. The cache also frees the music.
+	delete gAssets;
+	gAssets = nullptr;
+	delete gJobs;
+	gJobs = nullptr;
+
+	delete backend;
+	backend = nullptr;
 
-	SDL_Surface* startSurf = IMG_Load(fname.c_str());
-	if (startSurf == nullptr) {
-		std::cout << "Unable to load image " << fname << "! SDL Error: " << SDL_GetError() << std::endl;
-		return nullptr;
-	}
+	gWindow = nullptr;
+	gRenderer = nullptr;
+	TTF_Quit();
 
-	newText = SDL_CreateTextureFromSurface(gRenderer, startSurf);
-	if (newText == nullptr) {
-		std::cout << "Unable to create texture from " << fname << "! SDL Error: " << SDL_GetError() << std::endl;
-	}
+	// Quit SDL subsystems
+	SDL_Quit();
+	exit(0);
+}
 
-	SDL_FreeSurface(startSurf);
+// Sleeps until there is input for a menu. While the loader is busy it only waits a frame, so the
+// loading bar keeps moving. Returns false if nothing arrived.
+bool waitForMenuEvent(SDL_Event &e, FramePacer &pacer) {
+	int timeout = MENU_IDLE_TIMEOUT;
+	if (!gAssets->isAsyncLoadDone() && pacer.getFrameMS() > 0) {
+		timeout = pacer.getFrameMS();
+	}
+	return SDL_WaitEventTimeout(&e, timeout);
+}
 
-	return newText;
+// Uploads whatever the loader finished. Returns true if the loading bar moved.
+bool pumpLoader() {
+	if (gAssets->isAsyncLoadDone()) return false;
+	float progress = gAssets->getLoadProgress();
+	gAssets->pumpUploads();
+	return gAssets->getLoadProgress() != progress || gAssets->isAsyncLoadDone();
 }
 
-Mix_Music* loadMusic(std::string fname) {
-	Mix_Music* newMusic = Mix_LoadMUS(fname.c_str());
+// Draws a thin bar along the bottom of the menus while the background loader is still working
+void renderLoadingBar() {
+	if (gAssets->isAsyncLoadDone()) return;
+	SDL_Rect load_rect = {0, SCREEN_HEIGHT - 6, (int) (SCREEN_WIDTH * gAssets->getLoadProgress()), 6};
+	SDL_SetRenderDrawColor(gRenderer, 0xFF, 0xFF, 0xFF, 0xFF);
+	SDL_RenderFillRect(gRenderer, &load_rect);
+	SDL_SetRenderDrawColor(gRenderer, 0x00, 0x00, 0x00, 0xFF);
+}
 
-	if( newMusic == NULL )
-    {
-        printf( "Failed to load beat music! SDL_mixer Error: %s\n", Mix_GetError() );
-        return nullptr;
-    }
-	return newMusic;
+// Prerenders every frame of a clip out of its sheet
+void prerenderClip(AnimationID id, int w, int h, int minAngle, int maxAngle) {
+	const AnimationClip* clip = gAssets->getAnimation(id);
+	if (clip == nullptr) return;
+	for (const SDL_Rect &src : clip->frames) {
+		if (src.w > 0) {
+			sprite_cache->prerender(clip->sheet, &src, w, h, minAngle, maxAngle);
+		}
+	}
 }
 
-void close() {
-	SDL_DestroyRenderer(gRenderer);
-	SDL_DestroyWindow(gWindow);
-	SDL_DestroyTexture(gBackground);
+// With the software renderer, rotate the planes and missiles once up front instead of every frame
+void prerenderRotations() {
+	if (!RotatedSpriteCache::isSoftware(gRenderer)) return;
+
+	sprite_cache = new RotatedSpriteCache(gRenderer);
+	// The player tilts by 180 * sin(accel / 12) with accel capped at 3, so about 45 degrees either way
+	prerenderClip(ANIM_PLAYER, Player::PLAYER_WIDTH, Player::PLAYER_HEIGHT, -45, 45);
+	prerenderClip(ANIM_PLAYER_HIT, Player::PLAYER_WIDTH, Player::PLAYER_HEIGHT, -45, 45);
+	// The enemy doesn't tilt, but drawing it at its on-screen size still saves scaling it
+	prerenderClip(ANIM_ENEMY, squadron->get(0).getWidth(), squadron->get(0).getHeight(), 0, 0);
+	prerenderClip(ANIM_ENEMY_HIT, squadron->get(0).getWidth(), squadron->get(0).getHeight(), 0, 0);
+	prerenderClip(ANIM_KAMIKAZE, KamikazeSwarm::WIDTH, KamikazeSwarm::HEIGHT, -15, 15);
+	// Missiles can point anywhere
+	sprite_cache->prerender(gAssets->get(ASSET_MISSILE_1), nullptr, Missile::MISSILE_SIZE, Missile::MISSILE_SIZE / 4, -180, 180);
+	sprite_cache->prerender(gAssets->get(ASSET_MISSILE_2), nullptr, Missile::MISSILE_SIZE, Missile::MISSILE_SIZE / 4, -180, 180);
+	std::cout << "Pre-rotated sprites: " << sprite_cache->getMemoryUsage() / 1024 << " KB" << std::endl;
+}
 
-	Mix_FreeMusic(trash_beat);
-	Mix_FreeMusic(main_track);
-	Mix_FreeMusic(start_track);
+// Stops the game while the window is in the background, until it gets focus back or is closed
+void pauseUntilFocused() {
+	GameClock::pause();
+	Mix_PauseMusic();
 
-	gWindow = nullptr;
-	gRenderer = nullptr;
-	TTF_Quit();
+	SDL_Event e;
+	while (SDL_WaitEvent(&e)) {
+		if (e.type == SDL_QUIT) {
+			// Let the game loop see it and save the high score
+			SDL_PushEvent(&e);
+			break;
+		}
+		if (e.type == SDL_WINDOWEVENT && e.window.event == SDL_WINDOWEVENT_FOCUS_GAINED) {
+			break;
+		}
+		// Keys let go while the window was away still have to stop the player
+		if (e.type == SDL_KEYUP) {
+			player->handleEvent(e);
+		}
+	}
 
-	// Quit SDL subsystems
-	SDL_Quit();
-	exit(0);
+	Mix_ResumeMusic();
+	GameClock::resume();
 }
 
-// Function that prepares for enemy movement. Put in a separate method to avoid cluttering the main loop
-void moveEnemy(Enemy * en, Kamikaze* kam) {
-	int playerX = player->getPosX() + player->PLAYER_WIDTH/2;
-	int playerY = player->getPosY() + player->PLAYER_HEIGHT/2;
-	std::vector<int> bulletX;
-	std::vector<int> bulletY;
-	std::vector<int> bulletVelX;
-	std::vector<int> bulletVelY;
-	std::vector<int> stalagmX;
-	std::vector<int> stalagmH;
-	std::vector<int> stalagtX;
-	std::vector<int> stalagtH;
-	std::vector<int> turretX;
-	std::vector<int> turretBottom;
-	std::vector<int> turretH;
-	for (int i = 0; i < bullets.size(); i++) {
-		bulletX.push_back(bullets[i]->getX());
-		bulletY.push_back(bullets[i]->getY());
-		bulletVelX.push_back(bullets[i]->getXVel());
-		bulletVelY.push_back(bullets[i]->getYVel());
-	}
-	// For now, just have the AI treat missiles as bullets
-	for (int i = 0; i < missiles.size(); i++) {
-		bulletX.push_back(missiles[i]->getX());
-		bulletY.push_back(missiles[i]->getY());
-		bulletVelX.push_back(missiles[i]->getXVel());
-		bulletVelY.push_back(missiles[i]->getYVel());
-	}
-	std::vector<Stalagmite> stalagmites = blocks->getStalagmites();
-	std::vector<Stalagtite> stalagtites = blocks->getStalagtites();
-	std::vector<Turret> turrets = blocks->getTurrets();
-	for (int i = 0; i < stalagmites.size(); i++) {
-		if (stalagmites[i].STALAG_ABS_X - camX > 0 && stalagmites[i].STALAG_ABS_X - camX < SCREEN_WIDTH) {
-			stalagmX.push_back(stalagmites[i].STALAG_ABS_X - camX);
-			stalagmH.push_back(stalagmites[i].STALAG_HEIGHT + WallBlock::block_side);
-		}
-	}
-	for (int i = 0; i < stalagtites.size(); i++) {
-		if (stalagtites[i].STALAG_ABS_X - camX > 0 && stalagtites[i].STALAG_ABS_X - camX < SCREEN_WIDTH) {
-			stalagtX.push_back(stalagtites[i].STALAG_ABS_X - camX);
-			stalagtH.push_back(stalagtites[i].STALAG_HEIGHT + WallBlock::block_side);
-		}
-	}
-	for (int i = 0; i < turrets.size(); i++) {
-		if (turrets[i].BLOCK_ABS_X - camX > 0 && turrets[i].BLOCK_ABS_X - camX < SCREEN_WIDTH) {
-			turretX.push_back(turrets[i].BLOCK_ABS_X - camX);
-			turretBottom.push_back(turrets[i].bottom);
-			turretH.push_back(turrets[i].BLOCK_HEIGHT + WallBlock::block_side);
-		}
-	}
-
-	int kamiX = kam->getX();
-	int kamiY = kam->getY();
-	PathSequence * path = cave_system->getPathSequence();
-
-	int cave_y = -1;				// y coordinate of the center of the cave. -1 if there is no relevant cave
-	int abs_enemy_x = en->getX() + en->getWidth() / 2 + camX;
-	// Absolute start and end coordinates of the cave
-	int startX = cave_system->getStartX();
-	int endX = cave_system->getEndX();
-	int index = -1;
-	if (abs_enemy_x > startX && abs_enemy_x < endX)
-	{
-		index = (abs_enemy_x - startX) / CaveBlock::CAVE_BLOCK_WIDTH;
-		cave_y = path->y[index] * CaveBlock::CAVE_BLOCK_HEIGHT;
+// Damages an enemy, blowing it up if that finishes it off
+void hitEnemy(Enemy &en, int damage) {
+	if (en.isDestroyed()) {
+		return;
 	}
-	else if (abs_enemy_x < startX && abs_enemy_x + 400 > startX)
-	{
-		index = 0;
-		cave_y = path->y[0] * CaveBlock::CAVE_BLOCK_HEIGHT;
-	}
-	en->move(playerX, playerY, bulletX, bulletY, bulletVelX, bulletVelY, stalagmX, stalagmH, stalagtX, stalagtH, turretX, turretH, turretBottom, kamiX, kamiY, cave_y);
+	en.hit(damage);
+	if (en.isDestroyed())
+		blocks->addExplosion(en.getX() + camX, en.getY() + camY, en.getWidth(), en.getHeight(),0);
 }
 
 int getScore(){ return (int) (camX / 100); }
@@ -270,12 +384,44 @@ int readHighScore(int difficutly)
 	}
 }
 
-void check_missile_collisions(double x_scroll)
+// What each bullet overlaps, found on the job system before the bullets are resolved one by one.
+// Hitting things only ever takes them out of the way, so a bullet found to hit nothing still hits nothing.
+struct BulletContact
+{
+	bool player;
+	int kamikaze;
+	int enemy;
+	bool cave;
+};
+std::vector<BulletContact> bullet_contacts;
+BallisticBatch bullet_batch;
+GuidanceBatch missile_batch;
+
+// Job system stages. Each only writes its own bullets or missiles, or its own contact.
+// Bullets and missiles are a job each: stepping them all in one batch costs less than handing them out.
+void moveBullets(int, void*) {
+	Bullet::moveAll(bullets, bullet_batch);
+}
+
+// data is the missiles' target, taken before the player could be moved by anything else this tick
+void moveMissiles(int, void* data) {
+	Missile::moveAll(missiles, missile_batch, *(MissileGuidance::Target*) data);
+}
+
+void findBulletContact(int i, void* data) {
+	Bullet* b = bullets[i];
+	BulletContact &contact = bullet_contacts[i];
+	contact.player = player->checkCollisionBullet(b->getX(), b->getY(), b->getWidth(), b->getHeight());
+	contact.kamikaze = kamikazes->findHit(b->getX(), b->getY(), b->getWidth(), b->getHeight(), true);
+	contact.enemy = squadron->findHit(b->getX(), b->getY(), b->getWidth(), b->getHeight());
+	contact.cave = cave_system->isEnabled && cave_system->checkCollision(b);
+}
+
+// The missiles have already been moved this tick
+void check_missile_collisions()
 {
 	for (int i = 0; i < missiles.size(); i++)
 	{
-		missiles[i]->move(x_scroll);
-
 		bool destroyed = false;
 
 		// Check if the missile is out of the screen boundaries
@@ -293,6 +439,8 @@ void check_missile_collisions(double x_scroll)
 		}
 		else if (cave_system->isEnabled && cave_system->checkCollision(missiles[i]))
 		{
+			// The blast radius is how far the damage reaches; the rock only gives way nearer the middle
+			cave_system->blast(missiles[i]->getX() + missiles[i]->getWidth() / 2, missiles[i]->getY() + missiles[i]->getHeight() / 2, missiles[i]->get_blast_radius() / 2);
 			destroyed = true;
 		}
 		else
@@ -315,12 +463,16 @@ void check_missile_collisions(double x_scroll)
 				}
 			}
 			double player_distance = missiles[i]->calculate_distance(player->getPosX(), player->getPosY());
-			double enemy_distance = missiles[i]->calculate_distance(en->getX(), en->getY());
 
 			int missile_hitbox = missiles[i]->get_blast_radius() / 3;
+			bool enemy_hit = false;
+			for (int j = 0; j < squadron->size() && !enemy_hit; j++) {
+				Enemy &en = squadron->get(j);
+				enemy_hit = !en.isDestroyed() && missiles[i]->calculate_distance(en.getX(), en.getY()) <= missile_hitbox;
+			}
 
 			// Explode the warhead if the missile hits the enemy or player
-			if (player_distance <= missile_hitbox || enemy_distance <= missile_hitbox)
+			if (player_distance <= missile_hitbox || enemy_hit)
 			{
 				// Deal damage to the player and/or enemy depending on their distance and blast radius
 
@@ -330,10 +482,14 @@ void check_missile_collisions(double x_scroll)
 					player->hit(damage);
 				}
 
-				if (enemy_distance <= missiles[i]->get_blast_radius())
+				for (int j = 0; j < squadron->size(); j++)
 				{
-					double damage = missiles[i]->calculate_damage(en->getX(), en->getY());
-					en->hit(damage);
+					Enemy &en = squadron->get(j);
+					if (missiles[i]->calculate_distance(en.getX(), en.getY()) <= missiles[i]->get_blast_radius())
+					{
+						double damage = missiles[i]->calculate_damage(en.getX(), en.getY());
+						hitEnemy(en, damage);
+					}
 				}
 
 				destroyed = true;
@@ -351,78 +507,495 @@ void check_missile_collisions(double x_scroll)
 	}
 }
 
-int main() {
+// Sets up the level, the player and the enemies for a new game
+void createWorld(int difficulty) {
+	Animator::setTime(GameClock::getTicks());
+	font_16 = gAssets->openFont(AssetCache::FONT_PATH, 16);
+
+	if (!level_path.empty() && level_file == nullptr) {
+		level_file = new LevelFile();
+		if (!level_file->open(level_path.c_str())) {
+			std::cout << "Generating a new level instead" << std::endl;
+			delete level_file;
+			level_file = nullptr;
+		}
+	}
+
+	cave_system = new CaveSystem();
+	cave_generator = new CaveGenerator();
+	cave_generator->setLevel(level_file);
+	createLevel(difficulty);
+
+	//Start the player on the left side of the screen
+	player = new Player(SCREEN_WIDTH/4 - Player::PLAYER_WIDTH/2, SCREEN_HEIGHT/2 - Player::PLAYER_HEIGHT/2, difficulty, gRenderer);
+
+	squadron = new EnemySquadron(difficulty, gRenderer);
+	kamikazes = new KamikazeSwarm(difficulty);
+}
+
+// Sets up the walls, hazards, powerups and caves of a new level, from the saved level if there is one
+void createLevel(int difficulty) {
+	if (level_file != nullptr) {
+		level_params = level_file->getParams();
+	}
+	else {
+		level_params.generatorVersion = LevelFile::GENERATOR_VERSION;
+		level_params.width = LEVEL_WIDTH;
+		level_params.height = LEVEL_HEIGHT;
+		level_params.caveFreq = CaveSystem::CAVE_SYSTEM_FREQ;
+		level_params.caveWidth = CaveBlock::CAVE_SYSTEM_PIXEL_WIDTH;
+		//random open air area
+		level_params.openAir = rand() % ((LEVEL_WIDTH-50)/72) + 50;
+		level_params.openAirLength = (rand() % 200) + 100;
+		// Taken from rand() so a game started from the same seed gets the same level
+		level_params.caveSeed = rand();
+		level_params.levelSeed = rand();
+		level_params.difficulty = difficulty;
+		level_params.caveStyle = cave_style;
+	}
+
+	cave_generator->request(level_params.caveFreq, level_params.difficulty, level_params.caveSeed, (CaveStyle) level_params.caveStyle);
+	blocks = new MapBlocks(level_params.width, level_params.height, gRenderer, level_params.caveFreq, level_params.caveWidth, level_params.openAir, level_params.openAirLength, level_params.difficulty, level_params.levelSeed, endless_mode, level_file);
+
+	if (!save_level_path.empty() && LevelFile::write(save_level_path.c_str(), level_params)) {
+		std::cout << "Saved level " << save_level_path << std::endl;
+	}
+	if (!save_seed_path.empty() && LevelFile::writeSeed(save_seed_path.c_str(), level_params)) {
+		std::cout << "Saved level seed " << save_seed_path << std::endl;
+	}
+}
+
+// One fixed step of the game: scrolling, firing, movement and collisions. Input is handled before this.
+void updateWorld(int difficulty) {
+	Bullet* newBullet;
+
+	// Every animation advances by the same time this tick
+	Animator::setTime(GameClock::getTicks());
+
+	// Scroll to the side, unless the end of the level has been reached
+	prev_camX = camX;
+	prev_bg_x = bg_x;
+	time_since_horiz_scroll = GameClock::getTicks() - last_horiz_scroll;
+	camX += (double) (SCROLL_SPEED * time_since_horiz_scroll) / 1000;
+	bg_x += (double) (BG_SCROLL_SPEED * time_since_horiz_scroll) / 1000;
+	if (!endless_mode && camX > level_params.width - SCREEN_WIDTH) {
+		camX = level_params.width - SCREEN_WIDTH;
+	}
+	last_horiz_scroll = GameClock::getTicks();
+
+	if(player->getAutoFire()){
+		newBullet = player->handleForwardFiring();
+		if (newBullet != nullptr) {
+			bullets.push_back(newBullet);
+		}
+		newBullet = player->handleBackwardFiring();
+		if (newBullet != nullptr) {
+			bullets.push_back(newBullet);
+		}
+	}
+	// Move player
+	player->move(SCREEN_WIDTH, SCREEN_HEIGHT, LEVEL_HEIGHT, camY);
+
+	//move the enemies
+	squadron->update(player, kamikazes, bullets, missiles, blocks, cave_system, camX);
+	squadron->handleFiring(bullets);
+
+	missiles = blocks->handleFiring(missiles, player->getPosX(), player->getPosY(), player->getVelX(), player->getVelY(), -BG_SCROLL_SPEED);
+
+	// No new kamikazes come in while there is a cave, but the ones already flying carry on into it
+	if (!cave_system->isEnabled && kamikazes->isHeld())
+		kamikazes->release();
+	else if (cave_system->isEnabled && !kamikazes->isHeld())
+		kamikazes->hold();
+	kamikazes->move(player->getPosX(), player->getPosY());
+
+	// Move the bullets and missiles on the job system while the level moves here. Nothing in between
+	// touches them until the bullet contacts, which wait on the bullets having moved.
+	JobSystem::Counter bullets_moved;
+	JobSystem::Counter missiles_moved;
+	MissileGuidance::Target missile_target = {(float) player->getPosX(), (float) player->getPosY(), (float) player->getVelX(), (float) player->getVelY(), -BG_SCROLL_SPEED};
+	gJobs->parallelFor(1, moveBullets, nullptr, &bullets_moved);
+	gJobs->parallelFor(1, moveMissiles, &missile_target, &missiles_moved);
+
+	//Move Blocks and check collisions
+	blocks->moveBlocks(camX, camY);
+	blocks->checkCollision(player);
+	squadron->checkCollision(blocks);
+
+	for (int i = 0; i < kamikazes->size(); i++) {
+		if (blocks->checkCollision(kamikazes, i))
+			kamikazes->destroy(i, KamikazeSwarm::RETURN_DELAY);
+	}
+
+	JobSystem::Counter contacts_found;
+	bullet_contacts.resize(bullets.size());
+	gJobs->parallelFor(bullets.size(), findBulletContact, nullptr, &contacts_found, 0, &bullets_moved);
+	gJobs->wait(&contacts_found);
+	// With no bullets there were no contacts to hold back, so nothing else waited for the move
+	gJobs->wait(&bullets_moved);
+
+	for (int i = bullets.size() - 1; i >= 0; i--) {
+		// If the bullet leaves the screen or hits something, it is destroyed
+		bool destroyed = false;
+		const BulletContact &contact = bullet_contacts[i];
+		// Bullets resolved before this one may have shot down what it was found to hit
+		int kam_hit = contact.kamikaze < 0 ? -1 : kamikazes->findHit(bullets[i]->getX(), bullets[i]->getY(), bullets[i]->getWidth(), bullets[i]->getHeight(), true);
+		int enemy_hit = contact.enemy < 0 ? -1 : squadron->findHit(bullets[i]->getX(), bullets[i]->getY(), bullets[i]->getWidth(), bullets[i]->getHeight());
+		int bulletHit = blocks->checkCollision(bullets[i]);
+		if(bulletHit == 2) {
+			destroyed = bullets[i]->ricochetFloor(); // rng chance to ricochet or get destroyed
+		}
+		else if(bulletHit == 1) {
+			destroyed = bullets[i]->ricochetRoof(); // rng chance to ricochet or get destroyed
+		}
+		else if (bulletHit == 3) {
+			destroyed = true;
+		}
+		else if (contact.player) {
+			destroyed = true;
+			player->hit(5);
+		}
+		else if (kam_hit >= 0) {
+			destroyed = true;
+			kamikazes->destroy(kam_hit, KamikazeSwarm::RETURN_DELAY);
+		}else if (enemy_hit >= 0){
+			destroyed = true;
+			hitEnemy(squadron->get(enemy_hit), 5);
+		}
+		else if (contact.cave) {
+			destroyed = true;
+		}
+		if (destroyed) {
+			bullets[i]->~Bullet();
+			delete bullets[i];
+			bullets.erase(bullets.begin() + i);
+		}
+	}
+
+	gJobs->wait(&missiles_moved);
+	check_missile_collisions();
+
+	// Check collisions between the enemies and player
+	for (int i = 0; i < squadron->size(); i++) {
+		if (squadron->get(i).checkCollision(player->getPosX(), player->getPosY(), player->getWidth(), player->getHeight())) {
+			player->hit(10);
+			hitEnemy(squadron->get(i), 10);
+		}
+	}
+
+	if((int) camX % CaveSystem::CAVE_SYSTEM_FREQ < ((int) (camX - (double) (SCROLL_SPEED * time_since_horiz_scroll) / 1000)) % CaveSystem::CAVE_SYSTEM_FREQ)
+	{
+		// The cave thread has usually finished this one already; get it started on the one after
+		int offsetX = ((int) camX / CaveSystem::CAVE_SYSTEM_FREQ) * CaveSystem::CAVE_SYSTEM_FREQ;
+		cave_system = cave_generator->take(offsetX, level_params.difficulty, level_params.caveSeed, (CaveStyle) level_params.caveStyle);
+		cave_generator->request(offsetX + CaveSystem::CAVE_SYSTEM_FREQ, level_params.difficulty, level_params.caveSeed, (CaveStyle) level_params.caveStyle);
+	}
+
+	if(cave_system->isEnabled)
+	{
+		cave_system->moveCaveBlocks(camX, camY);
+		cave_system->checkCollision(player);
+		// Kamikazes that fly into the cave go off there and take some of it with them
+		for (int i = 0; i < kamikazes->size(); i++) {
+			if (kamikazes->getX(i) < SCREEN_WIDTH && cave_system->hitsWall(kamikazes->getX(i), kamikazes->getY(i), KamikazeSwarm::WIDTH, KamikazeSwarm::HEIGHT)) {
+				cave_system->blast(kamikazes->getX(i) + KamikazeSwarm::WIDTH / 2, kamikazes->getY(i) + KamikazeSwarm::HEIGHT / 2, KamikazeSwarm::BLAST_RADIUS);
+				kamikazes->destroy(i, KamikazeSwarm::RETURN_DELAY);
+			}
+		}
+	}
+
+	for (int i = 0; i < kamikazes->size(); i++) {
+		// If the player hits a kamikaze, blow it up, damage the player, and send it back to wait its turn
+		if (player->checkCollisionKami(kamikazes->getX(i), kamikazes->getY(i), KamikazeSwarm::WIDTH, KamikazeSwarm::HEIGHT)) {
+			player->hit(10);
+			kamikazes->destroy(i, KamikazeSwarm::RETURN_DELAY);
+			continue;
+		}
+		int kam_victim = squadron->findHit(kamikazes->getX(i), kamikazes->getY(i), KamikazeSwarm::WIDTH, KamikazeSwarm::HEIGHT);
+		if (kam_victim >= 0){
+			hitEnemy(squadron->get(kam_victim), 10);
+			kamikazes->destroy(i, KamikazeSwarm::RETURN_DELAY);
+		}
+	}
+	for (const SDL_Rect &boom : kamikazes->takeExplosions()) {
+		blocks->addExplosion(boom.x + camX, boom.y + camY, boom.w, boom.h, 0);
+	}
+
+	if(player->getHealth() < 1 && !playerDestroyed){
+		playerDestroyed = true;
+		time_destroyed = GameClock::getTicks();
+		blocks->addExplosion(player->getPosX() + camX, player->getPosY() + camY, player->getWidth(), player->getHeight(),0);
+		Mix_HaltMusic();
+	}
+	if (playerDestroyed && GameClock::getTicks() > time_destroyed + 1000) {
+		game_over->isGameOver = true;
+	}
+}
+
+// Records the level and everything in it, without the HUD
+void recordWorld(RenderSnapshot* frame) {
+	// Clear the screen
+	frame->setDrawColor(0x00, 0x00, 0x00, 0xFF);
+	frame->clearScreen();
+
+	// Finally removed background drawing from the Player class
+	frame->setMotion((int) prev_bg_x - (int) bg_x, 0);
+	SDL_Rect bgRect = {-((int)bg_x % SCREEN_WIDTH), 0, SCREEN_WIDTH, SCREEN_HEIGHT};
+	// Drawn in between ticks, the background sits a little to the right of this, so cover the left edge
+	if (bgRect.x > -RenderSnapshot::MAX_INTERPOLATED_MOTION) {
+		bgRect.x -= SCREEN_WIDTH;
+		frame->copy(gBackground, &bgRect);
+		bgRect.x += SCREEN_WIDTH;
+	}
+	frame->copy(gBackground, &bgRect);
+	bgRect.x += SCREEN_WIDTH;
+	frame->copy(gBackground, &bgRect);
+	frame->setMotion(0, 0);
+
+	// Draw the player
+	if (!playerDestroyed) {
+		frame->beginEntity(player->getEntityId());
+		player->render(frame, SCREEN_WIDTH, SCREEN_HEIGHT);
+		frame->endEntity();
+	}
+	// Draw the enemies
+	squadron->render(frame);
+
+	kamikazes->render(frame);
+
+	// The level only moves with the camera
+	frame->setMotion((int) prev_camX - (int) camX, 0);
+	blocks->render(SCREEN_WIDTH, SCREEN_HEIGHT, frame, cave_system->isEnabled);
+	if (cave_system->isEnabled)
+		cave_system->render(SCREEN_WIDTH, SCREEN_HEIGHT, frame);
+	frame->setMotion(0, 0);
+
+	//draw the bullets
+	for (int i = 0; i < bullets.size(); i++) {
+		frame->beginEntity(bullets[i]->getEntityId());
+		bullets[i]->renderBullet(frame);
+		frame->endEntity();
+	}
+
+	// Render the missiles
+	for (auto& missile : missiles)
+	{
+		frame->beginEntity(missile->getEntityId());
+		missile->renderMissile(frame);
+		frame->endEntity();
+	}
+}
+
+// Records the score, health and heat bars over the level
+void recordHUD(RenderSnapshot* frame, int fps) {
+	HudState hud;
+	hud.health = player->getHealth();
+	hud.invincible = player->invincePower;
+	hud.frontHeat = player->getFrontHeat();
+	hud.frontMaxed = player->fshot_maxed;
+	hud.backHeat = player->getBackHeat();
+	hud.backMaxed = player->bshot_maxed;
+	hud.score = getScore();
+	hud.highScore = high_score;
+	hud.fps = fps;
+	frame->hud(hud, font_16, SCREEN_WIDTH, SCREEN_HEIGHT);
+}
+
+double msSince(Uint64 start) {
+	return (SDL_GetPerformanceCounter() - start) * 1000.0 / SDL_GetPerformanceFrequency();
+}
+
+// Records and draws one part of the frame bench_runs times and prints the average of each
+void benchmarkStage(const char* name, void (*record)(RenderSnapshot*)) {
+	RenderSnapshot snapshot;
+	SnapshotRenderer drawer(gRenderer, sprite_cache);
+	double record_ms = 0;
+	double draw_ms = 0;
+	for (int i = 0; i < bench_runs; i++) {
+		Uint64 start = SDL_GetPerformanceCounter();
+		snapshot.reset();
+		record(&snapshot);
+		record_ms += msSince(start);
+
+		start = SDL_GetPerformanceCounter();
+		drawer.draw(snapshot);
+		backend->present();
+		draw_ms += msSince(start);
+	}
+	std::cout << name << ": record " << record_ms / bench_runs << " ms, draw " << draw_ms / bench_runs << " ms" << std::endl;
+}
+
+// Plays the game offscreen with the software renderer and a clock that only moves a fixed step per
+// tick, so the same options always produce the same frame
+int runHeadless() {
+	if (SDL_Init(0) < 0) {
+		std::cout << "SDL could not initialize! SDL_Error: " << SDL_GetError() << std::endl;
+		return 1;
+	}
+	if(TTF_Init()==-1){
+		std::cout<<"TTF could not initialize";
+		return 1;
+	}
+
+	OffscreenBackend* offscreen = new OffscreenBackend(SCREEN_WIDTH, SCREEN_HEIGHT);
+	backend = offscreen;
+	gRenderer = offscreen->getRenderer();
+	if (gRenderer == nullptr) {
+		close();
+		return 1;
+	}
+
+	srand(headless_seed);
+	GameClock::useManualTime(10000);
+	last_horiz_scroll = GameClock::getTicks();
+
+	gAssets = new AssetCache(gRenderer);
+	gAssets->preload();
+	gJobs = new JobSystem();
+	gBackground = gAssets->acquire(ASSET_BACKGROUND);
+	game_over = new GameOver(gAssets->acquire(ASSET_CRED_BUTTON), gAssets->acquire(ASSET_RESTART_BUTTON));
+	// The high score file differs between machines, so leave it out of the picture
+	high_score = 0;
+	createWorld(headless_difficulty);
+	prerenderRotations();
+
+	Uint64 start = SDL_GetPerformanceCounter();
+	for (int i = 0; i < headless_ticks; i++) {
+		GameClock::advance(1000 / sim_tick_rate);
+		updateWorld(headless_difficulty);
+	}
+	std::cout << "Simulated " << headless_ticks << " ticks in " << msSince(start) << " ms" << std::endl;
+
+	RenderSnapshot frame;
+	SnapshotRenderer drawer(gRenderer, sprite_cache);
+	recordWorld(&frame);
+	recordHUD(&frame, 0);
+	if (game_over->isGameOver) {
+		game_over->render(&frame);
+	}
+	drawer.draw(frame);
+	backend->present();
+
+	std::cout << "Frame hash: " << std::hex << offscreen->hashPixels() << std::dec << std::endl;
+	if (!headless_out.empty() && offscreen->savePNG(headless_out)) {
+		std::cout << "Saved " << headless_out << std::endl;
+	}
+
+	if (bench_runs > 0) {
+		benchmarkStage("Frame", [](RenderSnapshot* f) { recordWorld(f); recordHUD(f, 0); });
+		benchmarkStage("Map blocks", [](RenderSnapshot* f) { blocks->render(SCREEN_WIDTH, SCREEN_HEIGHT, f, cave_system->isEnabled); });
+		if (cave_system->isEnabled) {
+			benchmarkStage("Cave", [](RenderSnapshot* f) { cave_system->render(SCREEN_WIDTH, SCREEN_HEIGHT, f); });
+		}
+		benchmarkStage("HUD", [](RenderSnapshot* f) { recordHUD(f, 0); });
+	}
+
+	close();
+	return 0;
+}
+
+int main(int argc, char* args[]) {
+	parseOptions(argc, args);
+	if (headless) {
+		return runHeadless();
+	}
 	if (!init()) {
 		std::cout <<  "Failed to initialize!" << std::endl;
 		close();
 		return 1;
 	}
 
-	trash_beat = loadMusic("sounds/lebron_trash_beat.wav");
-	main_track = loadMusic("sounds/track_2.wav");
-	start_track = loadMusic("sounds/game_track.wav");
-	gBackground = loadImage("sprites/cave.png");
+	// Only what the start screen needs is loaded up front. Everything else is decoded on worker threads
+	// while the menus are up, and restarting the game reuses the same textures.
+	gAssets = new AssetCache(gRenderer);
+	gJobs = new JobSystem();
+	start_screen= new StartScreen(gAssets->acquire(ASSET_START_SCREEN), gAssets->acquire(ASSET_START_BUTTON));
+	start_track = gAssets->getMusic(MUSIC_START_TRACK);
+	gAssets->beginAsyncLoad();
 
 	srand(time(NULL));
 
-	//random open air area
-	int openAir = rand() % ((LEVEL_WIDTH-50)/72) + 50;
-    int openAirLength = (rand() % 200) + 100;
-
-	cave_system = new CaveSystem();
-	start_screen= new StartScreen(loadImage("sprites/StartScreen.png"),loadImage("sprites/start_button.png"));
-	diff_sel_screen = new DifficultySelectionScreen(loadImage("sprites/DiffScreen.png"), loadImage("sprites/easy_button.png"), loadImage("sprites/med_button.png"), loadImage("sprites/hard_button.png"));
-	game_over = new GameOver(loadImage("sprites/cred_button.png"), loadImage("sprites/restart_button.png"));
-
 	Bullet* newBullet;
-	std::string fps;//for onscreen fps
-	std::string score; // for onscreen score
-	std::string high_score_string;
+	int fps = -1;//for onscreen fps
 
 
 	SDL_Rect bgRect = {0, 0, SCREEN_WIDTH, SCREEN_HEIGHT};
 	SDL_Event e;
 	bool gameon = true;
 
+	// The menus only redraw when something happened: input, or the loading bar moving
+	FramePacer menu_pacer(target_fps);
+	bool redraw = true;
+
 	Mix_PlayMusic(start_track, -1);
 	current_track = 2;
 	while(start_screen->notStarted){
-		while(SDL_PollEvent(&e)) {
-			if(e.type==SDL_QUIT){
-				start_screen->notStarted=false;
-				gameon=false;
-			}
-			start_screen->handleEvent(e);
+		if (waitForMenuEvent(e, menu_pacer)) {
+			do {
+				if(e.type==SDL_QUIT){
+					start_screen->notStarted=false;
+					gameon=false;
+				}
+				start_screen->handleEvent(e);
+			} while(SDL_PollEvent(&e));
+			redraw = true;
+		}
+		if (pumpLoader()) redraw = true;
+		if (redraw) {
+			start_screen->render(gRenderer);
+			renderLoadingBar();
+			SDL_RenderPresent(gRenderer);
+			redraw = false;
+			menu_pacer.wait();
 		}
-		start_screen->render(gRenderer);
-		SDL_RenderPresent(gRenderer);
 	}
 
+	diff_sel_screen = new DifficultySelectionScreen(gAssets->acquire(ASSET_DIFF_SCREEN), gAssets->acquire(ASSET_EASY_BUTTON), gAssets->acquire(ASSET_MED_BUTTON), gAssets->acquire(ASSET_HARD_BUTTON));
+	game_over = new GameOver(gAssets->acquire(ASSET_CRED_BUTTON), gAssets->acquire(ASSET_RESTART_BUTTON));
+
 	int difficulty = 0;
+	redraw = true;
 	while(difficulty == 0){
-		while(SDL_PollEvent(&e)) {
-			if(e.type==SDL_QUIT){
-				difficulty=4;
-				gameon=false;
-			}
-			difficulty = diff_sel_screen->handleEvent(e);
+		if (waitForMenuEvent(e, menu_pacer)) {
+			do {
+				if(e.type==SDL_QUIT){
+					difficulty=4;
+					gameon=false;
+				}
+				difficulty = diff_sel_screen->handleEvent(e);
+			} while(difficulty == 0 && SDL_PollEvent(&e));
+			redraw = true;
+		}
+		if (pumpLoader()) redraw = true;
+		if (redraw) {
+			diff_sel_screen->render(gRenderer);
+			renderLoadingBar();
+			SDL_RenderPresent(gRenderer);
+			redraw = false;
+			menu_pacer.wait();
 		}
-		diff_sel_screen->render(gRenderer);
-		SDL_RenderPresent(gRenderer);
 	}
 
-	int high_score = readHighScore(difficulty); // For onscreen high score
-
-	static TTF_Font *font_20 = TTF_OpenFont("sprites/comic.ttf", 20);
-	static TTF_Font *font_16 = TTF_OpenFont("sprites/comic.ttf", 16);
-	blocks = new MapBlocks(LEVEL_WIDTH, LEVEL_HEIGHT, gRenderer, CaveSystem::CAVE_SYSTEM_FREQ, CaveBlock::CAVE_SYSTEM_PIXEL_WIDTH, openAir, openAirLength, difficulty);
-
-	//Start the player on the left side of the screen
-	player = new Player(SCREEN_WIDTH/4 - Player::PLAYER_WIDTH/2, SCREEN_HEIGHT/2 - Player::PLAYER_HEIGHT/2, difficulty, gRenderer);
-
-	//start enemy on left side behind player
-	en = new Enemy(100, SCREEN_HEIGHT/2, 125, 53, 200, 200, difficulty, gRenderer);
-	kam = new Kamikaze(SCREEN_WIDTH+125, SCREEN_HEIGHT/2, 125, 53, 1000, gRenderer);
+	// Normally everything finished loading while the menus were up, making this a no-op
+	gAssets->finishAsyncLoad();
+	gAssets->reportMemory();
+	trash_beat = gAssets->getMusic(MUSIC_TRASH_BEAT);
+	main_track = gAssets->getMusic(MUSIC_MAIN_TRACK);
+	gBackground = gAssets->acquire(ASSET_BACKGROUND);
+
+	high_score = readHighScore(difficulty);
+	createWorld(difficulty);
+
+	// From here on the loop only records what to draw; the render thread does the drawing
+	prerenderRotations();
+	render_thread = new RenderThread();
+	render_thread->setTargetFPS(target_fps);
+	render_thread->setSpriteCache(sprite_cache);
+	render_thread->setInterpolation(interpolation);
+	render_thread->setDynamicResolution(dynamic_resolution);
+	render_thread->start(gRenderer);
+	// Ticks are interpolated between by the render thread, so they don't need spin-exact timing
+	FramePacer sim_pacer(sim_tick_rate, false);
 
 	while(gameon) {
 
@@ -430,16 +1003,12 @@ int main() {
 			current_track = 0;
 			Mix_PlayMusic(main_track, -1);
 		}
-		// Scroll to the side, unless the end of the level has been reached
-		time_since_horiz_scroll = SDL_GetTicks() - last_horiz_scroll;
-		camX += (double) (SCROLL_SPEED * time_since_horiz_scroll) / 1000;
-		bg_x += (double) (BG_SCROLL_SPEED * time_since_horiz_scroll) / 1000;
-		if (camX > LEVEL_WIDTH - SCREEN_WIDTH) {
-			camX = LEVEL_WIDTH - SCREEN_WIDTH;
-		}
-		last_horiz_scroll = SDL_GetTicks();
 
 		while(SDL_PollEvent(&e)) {
+			if (e.type == SDL_WINDOWEVENT && e.window.event == SDL_WINDOWEVENT_FOCUS_LOST) {
+				pauseUntilFocused();
+				continue;
+			}
 			if (e.type == SDL_QUIT) {
 
 				int current_highscore = readHighScore(difficulty);
@@ -472,308 +1041,53 @@ int main() {
 			}
 			if(game_over->isGameOver)
 			{
+				// Restart and credits draw their own screens, so take the renderer back for clicks
+				if (e.type == SDL_MOUSEBUTTONUP) {
+					render_thread->stop();
+				}
 				int over = game_over->handleEvent(e, gRenderer);
 				if(over){
 					gameon = false;
-					close();
+					break;
 				}
 				// If the game is restarted, reset some things
 				if (!game_over->isGameOver) {
-					delete en;
-					en = new Enemy(100, SCREEN_HEIGHT/2, 125, 53, 200, 200, game_over->diff, gRenderer);
+					Animator::setTime(GameClock::getTicks());
+					delete squadron;
+					squadron = new EnemySquadron(game_over->diff, gRenderer);
+					delete kamikazes;
+					kamikazes = new KamikazeSwarm(game_over->diff);
 					delete player;
 					player = new Player(SCREEN_WIDTH/4 - Player::PLAYER_WIDTH/2, SCREEN_HEIGHT/2 - Player::PLAYER_HEIGHT/2, game_over->diff, gRenderer);
 					delete blocks;
-					//random open air area
-					int openAir = rand() % ((LEVEL_WIDTH-50)/72) + 50;
-					int openAirLength = (rand() % 200) + 100;
-					blocks = new MapBlocks(LEVEL_WIDTH, LEVEL_HEIGHT, gRenderer, CaveSystem::CAVE_SYSTEM_FREQ, CaveBlock::CAVE_SYSTEM_PIXEL_WIDTH, openAir, openAirLength, game_over->diff);
+					createLevel(game_over->diff);
 					playerDestroyed = false;
 					camX = 0;
 					camY = LEVEL_HEIGHT - SCREEN_HEIGHT;
 				}
+				render_thread->start(gRenderer);
 			}
 		}
-		if(player->getAutoFire()){
-			newBullet = player->handleForwardFiring();
-			if (newBullet != nullptr) {
-				bullets.push_back(newBullet);
-			}
-			newBullet = player->handleBackwardFiring();
-			if (newBullet != nullptr) {
-				bullets.push_back(newBullet);
-			}
+		// Quitting skips the rest of the tick; everything is cleaned up once, after the loop
+		if (!gameon) {
+			break;
 		}
-		// If the kamikaze is offscreen, create a new one
-		if (kam->getX() < -kam->getWidth()) {
-			kam->setX(SCREEN_WIDTH+125);
-			kam->setY(SCREEN_HEIGHT/2);
-			if (difficulty == 3)
-				kam->setArrivalTime(100);
-			else if (difficulty == 2){
-				kam->setArrivalTime(300);
-			}else{
-				kam->setArrivalTime(500);
-			}
+		updateWorld(difficulty);
 
-		}
+		RenderSnapshot* frame = render_thread->beginFrame();
+		recordWorld(frame);
 
-		// Move player
-		player->move(SCREEN_WIDTH, SCREEN_HEIGHT, LEVEL_HEIGHT, camY);
-
-		//move enemy
-		moveEnemy(en, kam);
-		newBullet = en->handleFiring();
-		if (newBullet != nullptr) {
-			bullets.push_back(newBullet);
-		}
-
-		missiles = blocks->handleFiring(missiles, player->getPosX(), player->getPosY());
-
-		if (!cave_system->isEnabled){
-			if(!prev_kam)
-				kam->move(player, SCREEN_WIDTH);
-			else{
-				prev_kam = false;
-				kam->setX(SCREEN_WIDTH+125);
-				kam->setY(SCREEN_HEIGHT/2);
-				kam->setArrivalTime(50);
-			}
-			prev_kam = false;
-		}else{
-			if (!prev_kam){
-				blocks->addExplosion(kam->getX() + camX, kam->getY() + camY, kam->getWidth(), kam->getHeight(),0);
-				prev_kam = true;
-			}
-			kam->setX(SCREEN_WIDTH+125);
-		}
-
-		//move the bullets
-		for (int i = 0; i < bullets.size(); i++) {
-			bullets[i]->move();
-		}
-
-		//Move Blocks and check collisions
-		blocks->moveBlocks(camX, camY);
-		blocks->checkCollision(player);
-		blocks->checkCollision(en);
-
-		if (blocks->checkCollision(kam)){
-			blocks->addExplosion(kam->getX() + camX, kam->getY() + camY, kam->getWidth(), kam->getHeight(),0);
-			kam->setX(SCREEN_WIDTH+125);
-			kam->setY(SCREEN_HEIGHT/2);
-			kam->setArrivalTime(1000);
-		}
-
-		//kam->checkCollision(player, gRenderer);
-		for (int i = bullets.size() - 1; i >= 0; i--) {
-			// If the bullet leaves the screen or hits something, it is destroyed
-			bool destroyed = false;
-			int bulletHit = blocks->checkCollision(bullets[i]);
-			if(bulletHit == 2) {
-				destroyed = bullets[i]->ricochetFloor(); // rng chance to ricochet or get destroyed
-			}
-			else if(bulletHit == 1) {
-				destroyed = bullets[i]->ricochetRoof(); // rng chance to ricochet or get destroyed
-			}
-			else if (bulletHit == 3) {
-				destroyed = true;
-			}
-			else if (player->checkCollisionBullet(bullets[i]->getX(), bullets[i]->getY(), bullets[i]->getWidth(), bullets[i]->getHeight())) {
-				destroyed = true;
-				player->hit(5);
-			}
-			else if (kam->checkCollisionBullet(bullets[i]->getX(), bullets[i]->getY(), bullets[i]->getWidth(), bullets[i]->getHeight()) && kam->blast()) {
-				destroyed = true;
-				blocks->addExplosion(kam->getX() + camX, kam->getY() + camY, kam->getWidth(), kam->getHeight(),0);
-				// delete kam;
-				// kam = new Kamikaze(SCREEN_WIDTH+125, SCREEN_HEIGHT/2, 125, 53, 5000, gRenderer);
-				kam->setX(SCREEN_WIDTH+125);
-				kam->setY(SCREEN_HEIGHT/2);
-				kam->setArrivalTime(1000);
-			}else if (en->checkCollision(bullets[i]->getX(), bullets[i]->getY(), bullets[i]->getWidth(), bullets[i]->getHeight())){
-				destroyed = true;
-				en->hit(5);
-				if (en->getHealth() == 0)
-					blocks->addExplosion(en->getX() + camX, en->getY() + camY, en->getWidth(), en->getHeight(),0);
-			}
-			else if (cave_system->isEnabled && cave_system->checkCollision(bullets[i])) {
-				destroyed = true;
-			}
-			if (destroyed) {
-				bullets[i]->~Bullet();
-				delete bullets[i];
-				bullets.erase(bullets.begin() + i);
-			}
-		}
-
-		check_missile_collisions((double) (BG_SCROLL_SPEED * time_since_horiz_scroll) / 1000);
-
-		// Check collisions between enemy and player
-		if (en->checkCollision(player->getPosX(), player->getPosY(), player->getWidth(), player->getHeight())) {
-			player->hit(10);
-			en->hit(10);
-			if (en->getHealth() == 0)
-				blocks->addExplosion(en->getX() + camX, en->getY() + camY, en->getWidth(), en->getHeight(),0);
-		}
-
-		if((int) camX % CaveSystem::CAVE_SYSTEM_FREQ < ((int) (camX - (double) (SCROLL_SPEED * time_since_horiz_scroll) / 1000)) % CaveSystem::CAVE_SYSTEM_FREQ)
-		{
-			// std::cout << "Creating Cave System" << std::endl;
-			cave_system = new CaveSystem(camX, camY, SCREEN_WIDTH, difficulty);
-		}
-
-		if(cave_system->isEnabled)
-		{
-			cave_system->moveCaveBlocks(camX, camY);
-			cave_system->checkCollision(player);
-		}
-
-		// If the player hits the kamikaze, blow up the kamikaze, damage the player, and make a new kamikaze
-		if (player->checkCollisionKami(kam->getX(), kam->getY(), kam->getWidth(), kam->getHeight())) {
-			blocks->addExplosion(kam->getX() + camX, kam->getY() + camY, kam->getWidth(), kam->getHeight(),0);
-			player->hit(10);
-			// delete kam;
-			// kam = new Kamikaze(SCREEN_WIDTH+125, SCREEN_HEIGHT/2, 125, 53, 5000, gRenderer);
-			kam->setX(SCREEN_WIDTH+125);
-			kam->setY(SCREEN_HEIGHT/2);
-			kam->setArrivalTime(1000);
-		}
-
-		if (en->checkCollision(kam->getX(), kam->getY(), kam->getWidth(), kam->getHeight())){
-			blocks->addExplosion(kam->getX() + camX, kam->getY()+camY, kam->getWidth(), kam->getHeight(),0);
-			en->hit(10);
-			// delete kam;
-			// kam = new Kamikaze(SCREEN_WIDTH+125, SCREEN_HEIGHT/2, 125, 53, 5000, gRenderer);
-			kam->setX(SCREEN_WIDTH+125);
-			kam->setY(SCREEN_HEIGHT/2);
-			kam->setArrivalTime(1000);
-		}
-
-		// Clear the screen
-		SDL_RenderClear(gRenderer);
-
-		// Finally removed background drawing from the Player class
-		SDL_Rect bgRect = {-((int)bg_x % SCREEN_WIDTH), 0, SCREEN_WIDTH, SCREEN_HEIGHT};
-		SDL_RenderCopy(gRenderer, gBackground, nullptr, &bgRect);
-		bgRect.x += SCREEN_WIDTH;
-		SDL_RenderCopy(gRenderer, gBackground, nullptr, &bgRect);
-
-		// Draw the player
-		if (!playerDestroyed) player->render(gRenderer, SCREEN_WIDTH, SCREEN_HEIGHT);
-		// Draw the enemy
-		en->renderEnemy(gRenderer);
-
-		kam->renderKam(SCREEN_WIDTH, gRenderer);
-
-		blocks->render(SCREEN_WIDTH, SCREEN_HEIGHT, gRenderer, cave_system->isEnabled);
-		if (cave_system->isEnabled)
-			cave_system->render(SCREEN_WIDTH, SCREEN_HEIGHT, gRenderer);
-
-		//draw the bullets
-		for (int i = 0; i < bullets.size(); i++) {
-			bullets[i]->renderBullet(gRenderer);
-		}
-
-		// Render the missiles
-		for (auto& missile : missiles)
-		{
-			missile->renderMissile(gRenderer);
-		}
-
-		framecount++;
+		// Count the frames the render thread presented, not simulation ticks
 		fps_cur_time=SDL_GetTicks();
 		if (fps_cur_time - fps_last_time > 1000) {
-			fps= std::to_string((int) (framecount / ((fps_cur_time - fps_last_time) / 1000.0)));
-			fps +=" fps";
+			int framecount = render_thread->getFramesPresented() - fps_last_frames;
+			fps = (int) (framecount / ((fps_cur_time - fps_last_time) / 1000.0));
 			// reset
 			fps_last_time = fps_cur_time;
-			framecount = 0;
-		}
-		Text fps_text(gRenderer, fps, {255, 255, 255, 255}, font_16);
-		fps_text.render(gRenderer,20,20);
-
-		score = "Score: ";
-		score.append(std::to_string(getScore()));
-		Text score_text(gRenderer, score, {255, 255, 255, 255}, font_16);
-		score_text.render(gRenderer, SCREEN_WIDTH - 130, 7);
-
-		high_score_string = "High Score: ";
-		high_score_string.append(std::to_string(high_score));
-		Text high_score_text(gRenderer, high_score_string, {255, 255, 255, 255}, font_16);
-		high_score_text.render(gRenderer, SCREEN_WIDTH - 130, 32);
-
-		std::string health_string = "Health ";
-		std::string back_gun = "Back Gun";
-		std::string front_gun = "Front Gun";
-		Text healthText(gRenderer, health_string, {255, 255, 255, 255}, font_16);
-		healthText.render(gRenderer, 140, SCREEN_HEIGHT - 52);
-		Text backText(gRenderer, back_gun, {255, 255, 255, 255}, font_16);
-		backText.render(gRenderer, 670, SCREEN_HEIGHT - 52);
-		Text frontText(gRenderer, front_gun, {255, 255, 255, 255}, font_16);
-		frontText.render(gRenderer, 960, SCREEN_HEIGHT - 52);
-
-
-
-		int health = player->getHealth();
-		SDL_Rect outline = {199, SCREEN_HEIGHT - 56, 202, 32};
-		SDL_SetRenderDrawColor(gRenderer, 0x00, 0x00, 0x00, 0xFF);
-		SDL_RenderDrawRect(gRenderer, &outline);
-		if(player->invincePower){
-			SDL_SetRenderDrawColor(gRenderer, 0xD4, 0xAF, 0x37, 0xFF);
-		}
-		else{
-			if (health > 75) {
-				SDL_SetRenderDrawColor(gRenderer, 0x00, 0x00, 0xFF, 0xFF);
-			}
-			else if (health >= 50) {
-				SDL_SetRenderDrawColor(gRenderer, 0x00, 0xFF, 0x00, 0xFF);
-			}
-			else if (health >= 20) {
-				SDL_SetRenderDrawColor(gRenderer, 0xFF, 0xFF, 0x00, 0xFF);
-			}
-			else {
-				SDL_SetRenderDrawColor(gRenderer, 0xFF, 0x00, 0x00, 0xFF);
-			}
+			fps_last_frames += framecount;
 		}
-		SDL_Rect health_rect = {200, SCREEN_HEIGHT - 55, 2 * health, 30};
-		SDL_RenderFillRect(gRenderer, &health_rect);
+		recordHUD(frame, fps);
 
-		// Draw the bars for forward heat and backwards heat
-		int fHeat = player->getFrontHeat();
-		int bHeat = player->getBackHeat();
-		outline = {749, SCREEN_HEIGHT - 56, 152, 32};
-		SDL_SetRenderDrawColor(gRenderer, 0x00, 0x00, 0x00, 0xFF);
-		SDL_RenderDrawRect(gRenderer, &outline);
-		outline = {1049, SCREEN_HEIGHT - 56, 152, 32};
-		SDL_RenderDrawRect(gRenderer, &outline);
-
-		if(player->bshot_maxed){
-			SDL_SetRenderDrawColor(gRenderer, 0xFF, 0x00, 0x00, 0xFF);
-		}
-		else{
-			SDL_SetRenderDrawColor(gRenderer, 0x00, 0x00, 0xFF, 0xFF);
-		}
-		SDL_Rect heat_rect = {750, SCREEN_HEIGHT - 55, bHeat * 150 / Player::MAX_SHOOT_HEAT, 30};
-		SDL_RenderFillRect(gRenderer, &heat_rect);
-		if(player->fshot_maxed){
-			SDL_SetRenderDrawColor(gRenderer, 0xFF, 0x00, 0x00, 0xFF);
-		}
-		else{
-			SDL_SetRenderDrawColor(gRenderer, 0x00, 0x00, 0xFF, 0xFF);
-		}
-		heat_rect = {1050, SCREEN_HEIGHT - 55, fHeat * 150 / Player::MAX_SHOOT_HEAT, 30};
-		SDL_RenderFillRect(gRenderer, &heat_rect);
-
-		if(health < 1 && !playerDestroyed){
-			playerDestroyed = true;
-			time_destroyed = SDL_GetTicks();
-			blocks->addExplosion(player->getPosX() + camX, player->getPosY() + camY, player->getWidth(), player->getHeight(),0);
-			Mix_HaltMusic();
-		}
-		if (playerDestroyed && SDL_GetTicks() > time_destroyed + 1000) {
-			game_over->isGameOver = true;
-		}
 		if(game_over->isGameOver)
 		{
 			if (current_track != 1) {
@@ -781,10 +1095,11 @@ int main() {
 				current_track = 1;
 			}
 			game_over->stopGame(player, blocks);
-			game_over->render(gRenderer);
+			game_over->render(frame);
 		}
 
-		SDL_RenderPresent(gRenderer);
+		render_thread->publish();
+		sim_pacer.wait();
 	}
 
 	// Out of game loop, clean up
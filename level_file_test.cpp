@@ -0,0 +1,113 @@
+#define SDL_MAIN_HANDLED
+#include <iostream>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include <SDL.h>
+#include "LevelFile.h"
+#include "Screen.h"
+
+// Checks LevelFile refuses headers the game can't play. Run with make test_level.
+
+const char* TEST_PATH = "level_file_test.lvl";
+int failures = 0;
+
+LevelHeader goodHeader()
+{
+	LevelHeader header = {};
+	memcpy(header.magic, LevelFile::MAGIC, 4);
+	header.version = LevelFile::VERSION;
+	header.params.generatorVersion = LevelFile::GENERATOR_VERSION;
+	header.params.width = 100000;
+	header.params.height = 2000;
+	header.params.caveFreq = CaveSystem::CAVE_SYSTEM_FREQ;
+	header.params.caveWidth = CaveBlock::CAVE_SYSTEM_PIXEL_WIDTH;
+	header.params.difficulty = 1;
+	header.params.caveStyle = CAVE_TUNNEL;
+	return header;
+}
+
+// A full level with one empty chunk and no caves, so nothing about it is short or out of bounds
+LevelHeader fullHeader(std::vector<Uint32> &body)
+{
+	LevelHeader header = goodHeader();
+	header.chunkWidth = header.params.caveFreq;
+	header.chunkCount = 1;
+	header.chunkOffset = sizeof(LevelHeader);
+	body.assign(header.chunkCount + 1, 0);
+	header.recordOffset = header.chunkOffset + body.size() * sizeof(Uint32);
+	header.caveOffset = header.recordOffset;
+	return header;
+}
+
+// Writes the header and whatever body follows it; with no body it is a level in the short form
+void expectOpen(const char* name, const LevelHeader &header, bool expected, const std::vector<Uint32> &body = std::vector<Uint32>())
+{
+	FILE* f = fopen(TEST_PATH, "wb");
+	if (f == nullptr || fwrite(&header, sizeof(header), 1, f) != 1 || (!body.empty() && fwrite(body.data(), sizeof(Uint32), body.size(), f) != body.size())) {
+		std::cout << "Unable to write " << TEST_PATH << "!" << std::endl;
+		failures++;
+		if (f != nullptr) {
+			fclose(f);
+		}
+		return;
+	}
+	fclose(f);
+
+	LevelFile level;
+	bool opened = level.open(TEST_PATH);
+	if (opened != expected) {
+		std::cout << "FAIL: " << name << (expected ? " was refused" : " was accepted") << std::endl;
+		failures++;
+	}
+}
+
+int main()
+{
+	expectOpen("good header", goodHeader(), true);
+
+	LevelHeader header = goodHeader();
+	header.params.caveFreq = 0;
+	expectOpen("cave period of 0", header, false);
+
+	header = goodHeader();
+	header.params.caveFreq = -CaveSystem::CAVE_SYSTEM_FREQ;
+	expectOpen("negative cave period", header, false);
+
+	// The game only triggers caves every CAVE_SYSTEM_FREQ, and every cave is the same width
+	header = goodHeader();
+	header.params.caveFreq = CaveSystem::CAVE_SYSTEM_FREQ / 2;
+	expectOpen("other cave period", header, false);
+
+	header = goodHeader();
+	header.params.caveWidth = CaveBlock::CAVE_SYSTEM_PIXEL_WIDTH / 2;
+	expectOpen("other cave width", header, false);
+
+	header = goodHeader();
+	header.params.width = SCREEN_WIDTH - 1;
+	expectOpen("level narrower than the screen", header, false);
+
+	header = goodHeader();
+	header.params.difficulty = 4;
+	expectOpen("difficulty 4", header, false);
+
+	header = goodHeader();
+	header.params.caveStyle = CAVE_NOISE + 1;
+	expectOpen("unknown cave style", header, false);
+
+	// A full level whose chunks don't line up with its cave periods, next to the same level with ones
+	// that do, so the chunk width is the only thing wrong with it
+	std::vector<Uint32> body;
+	header = fullHeader(body);
+	expectOpen("good full level", header, true, body);
+	header.chunkWidth = header.params.caveFreq / 2;
+	expectOpen("chunks narrower than a cave period", header, false, body);
+
+	remove(TEST_PATH);
+	if (failures > 0) {
+		std::cout << failures << " level file checks failed" << std::endl;
+		return 1;
+	}
+	std::cout << "Level file checks passed" << std::endl;
+	return 0;
+}
@@ -3,6 +3,7 @@
 #include <iostream>
 #include <cmath>
 #include <SDL_image.h>
+#include "GameClock.h"
 
 Missile::Missile(int damage, int blast_radius, double x, double y, double xvel, double yvel, SDL_Texture* s, SDL_Renderer* gRenderer) :
 	damage{ damage }, blast_radius{ blast_radius }, xPos{ x }, yPos{ y },
@@ -19,43 +20,66 @@ Missile::Missile(int damage, int blast_radius, double x, double y, double xvel,
 	}
 	std::cout << xVel << " " << yVel << " " << pitch << std::endl;
 	air_time = 0;
-	last_move = SDL_GetTicks();
+	entityId = RenderSnapshot::newEntityId();
+	turnRate = 0;
+	fuel = 0;
+	last_move = GameClock::getTicks();
 }
 
-SDL_Texture* Missile::loadImage(std::string fname, SDL_Renderer *gRenderer) {
-	SDL_Texture* newText = nullptr;
-
-	SDL_Surface* startSurf = IMG_Load(fname.c_str());
-	if (startSurf == nullptr) {
-		std::cout << "Unable to load image " << fname << "! SDL Error: " << SDL_GetError() << std::endl;
-		return nullptr;
-	}
-
-	newText = SDL_CreateTextureFromSurface(gRenderer, startSurf);
-	if (newText == nullptr) {
-		std::cout << "Unable to create texture from " << fname << "! SDL Error: " << SDL_GetError() << std::endl;
-	}
-
-	SDL_FreeSurface(startSurf);
-
-	return newText;
-}
-
-void Missile::renderMissile(SDL_Renderer* gRenderer)
+void Missile::renderMissile(RenderSnapshot* frame)
 {
 	SDL_Rect missile_location = {(int) xPos, (int) yPos, MISSILE_SIZE, MISSILE_SIZE / 4};
-	SDL_RenderCopyEx(gRenderer, sprite, nullptr, &missile_location, pitch * 180.0 / M_PI, nullptr, SDL_FLIP_NONE);
+	frame->copy(sprite, &missile_location, pitch * 180.0 / M_PI);
 }
 
 void Missile::move(double x_scroll)
 {
-	time_since_move = SDL_GetTicks() - last_move;
+	time_since_move = GameClock::getTicks() - last_move;
 
 	xPos += (double) time_since_move * xVel / 1000 - x_scroll;
 	yPos += (double) time_since_move * yVel / 1000;
 	air_time += time_since_move;
 
-	last_move = SDL_GetTicks();
+	last_move = GameClock::getTicks();
+}
+
+void Missile::moveAll(const std::vector<Missile*> &missiles, GuidanceBatch &batch, const MissileGuidance::Target &target)
+{
+	int now = GameClock::getTicks();
+	int count = missiles.size();
+	batch.resize(count);
+	for (int i = 0; i < count; i++) {
+		Missile* m = missiles[i];
+		batch.x[i] = m->xPos;
+		batch.y[i] = m->yPos;
+		batch.xVel[i] = m->xVel;
+		batch.yVel[i] = m->yVel;
+		batch.fuel[i] = m->fuel;
+		batch.turnRate[i] = m->turnRate;
+		batch.seconds[i] = (now - m->last_move) / 1000.0f;
+	}
+	MissileGuidance::step(batch.x.data(), batch.y.data(), batch.xVel.data(), batch.yVel.data(), batch.fuel.data(), batch.turnRate.data(), batch.seconds.data(), count, target);
+	for (int i = 0; i < count; i++) {
+		Missile* m = missiles[i];
+		m->time_since_move = now - m->last_move;
+		m->air_time += m->time_since_move;
+		m->xPos = batch.x[i];
+		m->yPos = batch.y[i];
+		m->fuel = batch.fuel[i];
+		// Only heat seekers turn, so only they need their sprite turned to match
+		if (m->turnRate > 0) {
+			m->xVel = batch.xVel[i];
+			m->yVel = batch.yVel[i];
+			m->pitch = atan2(m->yVel, m->xVel);
+		}
+		m->last_move = now;
+	}
+}
+
+void Missile::makeHoming(float turnRate, float fuel)
+{
+	this->turnRate = turnRate;
+	this->fuel = fuel;
 }
 
 bool Missile::checkCollision(Missile *m){
@@ -106,6 +130,11 @@ bool Missile::ricochet()
 
 // Accessor methods
 
+Uint32 Missile::getEntityId()
+{
+	return entityId;
+}
+
 int Missile::getX()
 {
 	return xPos;
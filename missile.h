@@ -6,6 +6,9 @@
 #include <cmath>
 #include <SDL_image.h>
 #include "bullet.h"
+#include "RenderSnapshot.h"
+#include "MissileGuidance.h"
+#include <vector>
 
 class Missile
 {
@@ -14,9 +17,14 @@ class Missile
 
         Missile(int damage, int blast_radius, double x, double y, double xvel, double yvel, SDL_Texture* s, SDL_Renderer* gRenderer);
 
-        void renderMissile(SDL_Renderer* gRenderer);
+        void renderMissile(RenderSnapshot* frame);
 
         void move(double x_scroll);
+        // Moves every missile at once, steering the homing ones towards target, using batch for the arrays
+        static void moveAll(const std::vector<Missile*> &missiles, GuidanceBatch &batch, const MissileGuidance::Target &target);
+
+        // Makes this a heat seeker, able to turn turnRate radians a second for fuel seconds
+        void makeHoming(float turnRate, float fuel);
 
         // Calculates how far the entity is to this missile
 		double calculate_distance(double entity_x, double entity_y);
@@ -42,9 +50,10 @@ class Missile
 
         int get_blast_radius();
 
-        SDL_Texture* sprite;
+        // Which anchor the render thread interpolates this missile from
+        Uint32 getEntityId();
 
-        SDL_Texture* loadImage(std::string fname, SDL_Renderer *gRenderer);
+        SDL_Texture* sprite;
 
     private:
         // The following variables are the same as from bullet
@@ -53,6 +62,7 @@ class Missile
         // Size of missile
         const int width, height;
         int missType;
+        Uint32 entityId;
 
         // Position coordinates
         double xPos, yPos;
@@ -70,6 +80,10 @@ class Missile
         // Time the projectile has been in the air
         double air_time;
 
+        // How fast a heat seeker can turn and how long it can keep steering. Both 0 for a plain missile.
+        float turnRate;
+        float fuel;
+
         // Missile specific variables:
 
         // Amount of damage the warhead deals at the center of the blast radius